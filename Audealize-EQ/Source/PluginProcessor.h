@@ -73,7 +73,7 @@ public:
     void parameterChanged (const juce::String& parameterID, float newValue) override
     {
     }
-    void settingsFromMap (vector<float> settings) override
+    void settingsFromMap (vector<float> settings, bool crossfade) override
     {
     }
     inline String getParamID (int index) override
@@ -85,6 +85,17 @@ public:
         return true;
     }
 
+    void addMemoryUsage (MemoryUsage& usage) override
+    {
+        AudealizeAudioProcessor::addMemoryUsage (usage);
+        mAudealizeAudioProcessor->addMemoryUsage (usage);
+    }
+
+    float getParameterUpdatesPerSecond () override
+    {
+        return mAudealizeAudioProcessor->getParameterUpdatesPerSecond ();
+    }
+
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EQPluginProcessor)
@@ -0,0 +1,36 @@
+/*
+
+    IMPORTANT! This file is auto-generated each time you save your
+    project - if you alter its contents, your changes may be overwritten!
+
+    This is the header file that your files should include in order to get all the
+    JUCE library headers. You should avoid including the JUCE headers directly in
+    your own source files, because that wouldn't pick up the correct configuration
+    options for your app.
+
+*/
+
+#ifndef __APPHEADERFILE_AD5PCR__
+#define __APPHEADERFILE_AD5PCR__
+
+#include "AppConfig.h"
+
+#include <juce_core/juce_core.h>
+
+
+#if ! DONT_SET_USING_JUCE_NAMESPACE
+ // If your code uses a lot of JUCE classes, then this will obviously save you
+ // a lot of typing, but can be disabled by setting DONT_SET_USING_JUCE_NAMESPACE.
+ using namespace juce;
+#endif
+
+#if ! JUCE_DONT_DECLARE_PROJECTINFO
+namespace ProjectInfo
+{
+    const char* const  projectName    = "AudealizeDSP";
+    const char* const  versionString  = "0.2.3b";
+    const int          versionNumber  = 0x203;
+}
+#endif
+
+#endif   // __APPHEADERFILE_AD5PCR__
@@ -0,0 +1,47 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+    Public header of the AudealizeDSP static library. Headless hosts (command line tools, servers, other plugin
+    frameworks) include this and link against libAudealizeDSP to get the Audealize effects without the GUI,
+    audio device or plugin client modules.
+
+    Audealize::EffectChain runs the Equalizer and Reverb, and Audealize::DescriptorSet loads the descriptor data the
+    plugins use, e.g.
+
+        DescriptorSet eqDescriptors;
+        eqDescriptors.loadFromFile (File ("eqdescriptors.json"));
+
+        EffectChain chain;
+        chain.prepare (44100.0);
+        chain.setEqualizerSettings (eqDescriptors.getSettings (eqDescriptors.indexOf ("warm")), 1.0f);
+        chain.process (channels, numChannels, numSamples);
+*/
+
+#ifndef AudealizeDSP_h
+#define AudealizeDSP_h
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <audealize_module/audealize_dsp.h>
+
+#endif /* AudealizeDSP_h */
@@ -0,0 +1,178 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "StreamDaemon.h"
+
+#include <signal.h>
+
+using namespace Audealize;
+
+static StreamDaemon* runningDaemon = nullptr;
+
+static void handleSignal (int)
+{
+    if (runningDaemon != nullptr)
+    {
+        runningDaemon->stop ();
+    }
+}
+
+static void printUsage ()
+{
+    fputs ("Usage: AudealizeDaemon [options]\n"
+           "\n"
+           "Applies Audealize descriptors to a stream of interleaved PCM.\n"
+           "\n"
+           "  --input <source>       - for stdin (default), a file or FIFO path, or unix:<path> to listen on a socket\n"
+           "  --output <sink>        - for stdout or a file or FIFO path. Defaults to the input connection for\n"
+           "                         sockets, stdout otherwise\n"
+           "  --control <path>       Unix socket to accept control messages on, one per line:\n"
+           "                         eq|reverb <word> [amount], amount eq|reverb <amount>,\n"
+           "                         enable eq|reverb, bypass eq|reverb, report\n"
+           "  --descriptors <dir>    Directory holding eqdescriptors.json and reverbdescriptors.json\n"
+           "  --format s16|f32       Sample format, native byte order (default s16)\n"
+           "  --channels 1|2         Number of interleaved channels (default 2)\n"
+           "  --rate <Hz>            Sample rate (default 44100)\n"
+           "  --block <frames>       Block size, and so the latency (default 128)\n"
+           "  --buffer <blocks>      Size of the input and output buffers in blocks (default 8)\n"
+           "  --report <seconds>     Print a latency and throughput report at this interval\n"
+           "  --eq <word>            Initial eq descriptor\n"
+           "  --eq-amount <amount>   Initial eq amount, 0 to 1 (default 1)\n"
+           "  --reverb <word>        Initial reverb descriptor\n"
+           "  --reverb-amount <mix>  Initial reverb wet/dry mix, 0 to 1 (default 0.75)\n",
+           stderr);
+}
+
+int main (int argc, char* argv[])
+{
+    StreamDaemon::Options options;
+    options.descriptorDir = File::getSpecialLocation (File::currentExecutableFile).getParentDirectory ();
+
+    String eqWord, eqAmount, reverbWord, reverbAmount;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const String arg (argv[i]);
+        const String value (i + 1 < argc ? argv[i + 1] : "");
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage ();
+            return 0;
+        }
+        if (!arg.startsWith ("--") || i + 1 >= argc)
+        {
+            printUsage ();
+            return 1;
+        }
+        i++;
+
+        if (arg == "--input")
+            options.input = value;
+        else if (arg == "--output")
+            options.output = value;
+        else if (arg == "--control")
+            options.control = value;
+        else if (arg == "--descriptors")
+            options.descriptorDir = File::getCurrentWorkingDirectory ().getChildFile (value);
+        else if (arg == "--format")
+            options.format = value == "f32" ? StreamDaemon::kFormatF32 : StreamDaemon::kFormatS16;
+        else if (arg == "--channels")
+            options.numChannels = value.getIntValue ();
+        else if (arg == "--rate")
+            options.sampleRate = value.getDoubleValue ();
+        else if (arg == "--block")
+            options.blockSize = value.getIntValue ();
+        else if (arg == "--buffer")
+            options.bufferBlocks = value.getIntValue ();
+        else if (arg == "--report")
+            options.reportInterval = value.getDoubleValue ();
+        else if (arg == "--eq")
+            eqWord = value;
+        else if (arg == "--eq-amount")
+            eqAmount = value;
+        else if (arg == "--reverb")
+            reverbWord = value;
+        else if (arg == "--reverb-amount")
+            reverbAmount = value;
+        else
+        {
+            printUsage ();
+            return 1;
+        }
+    }
+
+    if ((options.numChannels != 1 && options.numChannels != 2) || options.sampleRate <= 0.0 ||
+        options.blockSize < 1 || options.bufferBlocks < 2)
+    {
+        printUsage ();
+        return 1;
+    }
+
+    StreamDaemon daemon (options);
+
+    if (!daemon.loadDescriptors ())
+    {
+        fputs ("Warning: no descriptors found, only bypass is possible\n", stderr);
+    }
+
+    if (eqWord.isNotEmpty ())
+    {
+        const String reply = daemon.handleCommand ("eq " + eqWord + " " + eqAmount);
+        if (!reply.startsWith ("ok"))
+        {
+            fputs ((reply + "\n").toRawUTF8 (), stderr);
+            return 1;
+        }
+    }
+
+    if (reverbWord.isNotEmpty ())
+    {
+        const String reply = daemon.handleCommand ("reverb " + reverbWord + " " + reverbAmount);
+        if (!reply.startsWith ("ok"))
+        {
+            fputs ((reply + "\n").toRawUTF8 (), stderr);
+            return 1;
+        }
+    }
+
+    // without SA_RESTART, a signal also interrupts a wait for a FIFO to be opened
+    struct sigaction action;
+    zerostruct (action);
+    action.sa_handler = handleSignal;
+    sigaction (SIGINT, &action, nullptr);
+    sigaction (SIGTERM, &action, nullptr);
+    signal (SIGPIPE, SIG_IGN);
+
+    runningDaemon = &daemon;
+    const int result = daemon.run ();
+    runningDaemon = nullptr;
+
+    if (result != 0)
+    {
+        fputs ("Couldn't open the input, output or control socket\n", stderr);
+    }
+
+    return result;
+}
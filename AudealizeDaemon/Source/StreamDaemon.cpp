@@ -0,0 +1,759 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "StreamDaemon.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Audealize
+{
+// the Reverb plugin's default wet/dry mix
+static const float defaultReverbAmount = 0.75f;
+
+static const int pollTimeoutMs = 100;  // how often blocked threads check whether they should stop
+
+/**
+ *  Creates a Unix socket listening on a path, replacing any socket file already there
+ *
+ *  @return the socket's file descriptor, or -1 on failure
+ */
+static int createListeningSocket (const String& path)
+{
+    sockaddr_un address;
+    zerostruct (address);
+    address.sun_family = AF_UNIX;
+
+    if (path.getNumBytesAsUTF8 () >= sizeof (address.sun_path))
+    {
+        return -1;
+    }
+    path.copyToUTF8 (address.sun_path, sizeof (address.sun_path));
+
+    const int fd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    ::unlink (address.sun_path);
+    if (::bind (fd, (const sockaddr*) &address, sizeof (address)) < 0 || ::listen (fd, 4) < 0)
+    {
+        ::close (fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ *  Waits for a connection on a listening socket, giving up when shouldStop is set
+ *
+ *  @return the connection's file descriptor, or -1
+ */
+static int acceptConnection (int listenFd, Atomic<int>& shouldStop)
+{
+    while (shouldStop.get () == 0)
+    {
+        pollfd fd = {listenFd, POLLIN, 0};
+        if (::poll (&fd, 1, pollTimeoutMs) > 0)
+        {
+            const int connection = ::accept (listenFd, nullptr, nullptr);
+            if (connection >= 0 || (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED))
+            {
+                return connection;
+            }
+        }
+    }
+
+    return -1;
+}
+
+static void setNonBlocking (int fd)
+{
+    ::fcntl (fd, F_SETFL, ::fcntl (fd, F_GETFL) | O_NONBLOCK);
+}
+
+static String formatMs (int64 ticks)
+{
+    return String (Time::highResolutionTicksToSeconds (ticks) * 1000.0, 3);
+}
+
+//==============================================================================
+/// Accepts control connections, one at a time, and answers each line with the reply of StreamDaemon::handleCommand.
+/// Prints the report on stderr at the report interval. Owns the listening socket, if there is one.
+class StreamDaemon::ControlThread : public Thread
+{
+public:
+    ControlThread (StreamDaemon& owner, int listenFd)
+        : Thread ("Audealize control"), mOwner (owner), mListenFd (listenFd), mClientFd (-1)
+    {
+    }
+
+    ~ControlThread ()
+    {
+        stopThread (4 * pollTimeoutMs);
+        closeClient ();
+
+        if (mListenFd >= 0)
+        {
+            ::close (mListenFd);
+            ::unlink (mOwner.mOptions.control.toRawUTF8 ());
+        }
+    }
+
+    void run () override
+    {
+        const double interval = mOwner.mOptions.reportInterval;
+        double nextReport = Time::getMillisecondCounterHiRes () + interval * 1000.0;
+
+        while (!threadShouldExit ())
+        {
+            pollfd fd = {mClientFd >= 0 ? mClientFd : mListenFd, POLLIN, 0};
+            const int numReady = ::poll (&fd, fd.fd >= 0 ? 1 : 0, pollTimeoutMs);
+
+            if (interval > 0.0 && Time::getMillisecondCounterHiRes () >= nextReport)
+            {
+                const String report = mOwner.getReport () + "\n";
+                fputs (report.toRawUTF8 (), stderr);
+                nextReport += interval * 1000.0;
+            }
+
+            if (numReady <= 0)
+            {
+                continue;
+            }
+
+            if (mClientFd >= 0)
+            {
+                readClient ();
+            }
+            else
+            {
+                mClientFd = ::accept (mListenFd, nullptr, nullptr);
+            }
+        }
+    }
+
+private:
+    StreamDaemon& mOwner;
+    int mListenFd, mClientFd;
+    std::string mPendingLine;  // text received after the last complete line
+
+    void readClient ()
+    {
+        char data[1024];
+        const ssize_t numRead = ::read (mClientFd, data, sizeof (data));
+
+        if (numRead <= 0)
+        {
+            if (numRead == 0 || errno != EINTR)
+            {
+                closeClient ();
+            }
+            return;
+        }
+
+        mPendingLine.append (data, (size_t) numRead);
+
+        size_t end;
+        while ((end = mPendingLine.find ('\n')) != std::string::npos)
+        {
+            const String reply = mOwner.handleCommand (String (mPendingLine.substr (0, end))) + "\n";
+            mPendingLine.erase (0, end + 1);
+
+            ::send (mClientFd, reply.toRawUTF8 (), reply.getNumBytesAsUTF8 (), MSG_NOSIGNAL);
+        }
+    }
+
+    void closeClient ()
+    {
+        if (mClientFd >= 0)
+        {
+            ::close (mClientFd);
+            mClientFd = -1;
+        }
+        mPendingLine.clear ();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ControlThread)
+};
+
+//==============================================================================
+StreamDaemon::StreamDaemon (const Options& options)
+    : mOptions (options),
+      mFrameBytes (options.numChannels * (options.format == kFormatS16 ? 2 : 4)),
+      mBlockBytes (mFrameBytes * options.blockSize),
+      mEQAmount (1.0f),
+      mReverbAmount (defaultReverbAmount),
+      mInputBuffer (mBlockBytes * options.bufferBlocks),
+      mOutputBuffer (mBlockBytes * options.bufferBlocks),
+      mChannelData ((size_t) options.blockSize * 2),
+      mInputFd (-1),
+      mOutputFd (-1),
+      mListenFd (-1),
+      mStdinFlags (::fcntl (STDIN_FILENO, F_GETFL)),
+      mStdoutFlags (::fcntl (STDOUT_FILENO, F_GETFL)),
+      mInputEnded (false),
+      mPendingEnd ((size_t) options.bufferBlocks),
+      mPendingTicks ((size_t) options.bufferBlocks),
+      mPendingStart (0),
+      mNumPending (0),
+      mBytesQueued (0),
+      mBytesWritten (0),
+      mReportTicks (Time::getHighResolutionTicks ()),
+      mReportFrames (0),
+      mReportProcessTicks (0),
+      mReportLatencyTicks (0),
+      mReportNumLatencies (0)
+{
+    jassert (options.numChannels == 1 || options.numChannels == 2);
+    jassert (options.bufferBlocks >= 2);
+
+    mChannels[0] = mChannelData;
+    mChannels[1] = mChannelData + options.blockSize;
+
+    // the stream passes through unchanged until a descriptor is chosen
+    mChain.prepare (options.sampleRate);
+    mChain.setEnabled (EffectChain::kEqualizer, false);
+    mChain.setEnabled (EffectChain::kReverb, false);
+}
+
+StreamDaemon::~StreamDaemon ()
+{
+    mControlThread = nullptr;
+
+    closeConnection ();
+    if (mOutputFd >= 0 && mOutputFd != STDOUT_FILENO)
+    {
+        ::close (mOutputFd);
+    }
+    if (mListenFd >= 0)
+    {
+        ::close (mListenFd);
+        ::unlink (mOptions.input.substring (5).toRawUTF8 ());
+    }
+
+    ::fcntl (STDIN_FILENO, F_SETFL, mStdinFlags);
+    ::fcntl (STDOUT_FILENO, F_SETFL, mStdoutFlags);
+}
+
+bool StreamDaemon::loadDescriptors ()
+{
+    const bool eqLoaded = mEQDescriptors.loadFromFile (mOptions.descriptorDir.getChildFile ("eqdescriptors.json"));
+    const bool reverbLoaded =
+        mReverbDescriptors.loadFromFile (mOptions.descriptorDir.getChildFile ("reverbdescriptors.json"));
+
+    return eqLoaded || reverbLoaded;
+}
+
+//==============================================================================
+String StreamDaemon::handleCommand (const String& command)
+{
+    StringArray tokens = StringArray::fromTokens (command.trim (), true);
+    tokens.removeEmptyStrings ();
+
+    const String name = tokens[0].toLowerCase ();
+
+    if (name == "report")
+    {
+        return "ok " + getReport ();
+    }
+
+    if ((name == "eq" || name == "reverb") && tokens.size () > 1)
+    {
+        const bool isEQ = name == "eq";
+        const DescriptorSet& descriptors = isEQ ? mEQDescriptors : mReverbDescriptors;
+        const int index = descriptors.indexOf (tokens[1]);
+
+        if (index < 0)
+        {
+            return "error: unknown descriptor \"" + tokens[1] + "\"";
+        }
+
+        float& amount = isEQ ? mEQAmount : mReverbAmount;
+        if (tokens.size () > 2)
+        {
+            amount = jlimit (0.0f, 1.0f, tokens[2].getFloatValue ());
+        }
+
+        (isEQ ? mEQSettings : mReverbSettings) = descriptors.getSettings (index);
+
+        const String reply = isEQ ? sendEQ () : sendReverb ();
+        return reply == "ok" ? sendEnabled (isEQ ? EffectChain::kEqualizer : EffectChain::kReverb, true) : reply;
+    }
+
+    const String effectName = tokens[1].toLowerCase ();
+    if (effectName == "eq" || effectName == "reverb")
+    {
+        const bool isEQ = effectName == "eq";
+
+        if (name == "amount" && tokens.size () > 2)
+        {
+            (isEQ ? mEQAmount : mReverbAmount) = jlimit (0.0f, 1.0f, tokens[2].getFloatValue ());
+            return isEQ ? sendEQ () : sendReverb ();
+        }
+
+        if (name == "enable" || name == "bypass")
+        {
+            return sendEnabled (isEQ ? EffectChain::kEqualizer : EffectChain::kReverb, name == "enable");
+        }
+    }
+
+    return "error: unknown command \"" + command.trim () + "\"";
+}
+
+String StreamDaemon::sendEQ ()
+{
+    if (mEQSettings.empty ())
+    {
+        return "error: no eq descriptor chosen";
+    }
+
+    ControlMessage message;
+    message.type = ControlMessage::kSetBandGains;
+    message.numValues = EffectChain::getBandGains (mEQSettings, mEQAmount, message.values, ControlMessage::maxValues);
+
+    return mControlQueue.push (message) ? "ok" : "error: control queue full";
+}
+
+String StreamDaemon::sendReverb ()
+{
+    if (mReverbSettings.size () < 5)
+    {
+        return "error: no reverb descriptor chosen";
+    }
+
+    ControlMessage message;
+    message.type = ControlMessage::kSetReverb;
+    message.amount = mReverbAmount;
+    message.numValues = 5;
+    std::copy (mReverbSettings.begin (), mReverbSettings.begin () + 5, message.values);
+
+    return mControlQueue.push (message) ? "ok" : "error: control queue full";
+}
+
+String StreamDaemon::sendEnabled (EffectChain::Effect effect, bool enabled)
+{
+    ControlMessage message;
+    message.type = ControlMessage::kSetEnabled;
+    message.effect = effect;
+    message.enabled = enabled;
+
+    return mControlQueue.push (message) ? "ok" : "error: control queue full";
+}
+
+//==============================================================================
+int StreamDaemon::run ()
+{
+    if (mOptions.control.isNotEmpty () || mOptions.reportInterval > 0.0)
+    {
+        int controlFd = -1;
+        if (mOptions.control.isNotEmpty () && (controlFd = createListeningSocket (mOptions.control)) < 0)
+        {
+            return 1;
+        }
+
+        mControlThread = new ControlThread (*this, controlFd);
+        mControlThread->startThread ();
+    }
+
+    // a socket connection is answered on the same connection unless an output is given
+    if ((mOptions.output.isNotEmpty () || !mOptions.input.startsWith ("unix:")) && !openOutput ())
+    {
+        return 1;
+    }
+
+    int result = 0;
+
+    while (mShouldStop.get () == 0)
+    {
+        if (mInputFd < 0 && !openInput ())
+        {
+            result = mShouldStop.get () != 0 ? 0 : 1;
+            break;
+        }
+
+        pollfd fds[2];
+        int numFds = 0, inputIdx = -1;
+
+        if (!mInputEnded && mInputBuffer.getFreeSpace () > 0)
+        {
+            fds[numFds] = {mInputFd, POLLIN, 0};
+            inputIdx = numFds++;
+        }
+        if (mOutputBuffer.getNumReady () > 0)
+        {
+            fds[numFds++] = {mOutputFd, POLLOUT, 0};
+        }
+
+        ::poll (fds, numFds, pollTimeoutMs);
+
+        if (inputIdx >= 0 && fds[inputIdx].revents != 0)
+        {
+            readInput ();
+        }
+
+        // blocks are written out as soon as they are processed, without waiting for the next poll
+        processBlocks ();
+
+        if (!writeOutput ())
+        {
+            if (mOutputFd != mInputFd)
+            {
+                break;
+            }
+            closeConnection ();
+            continue;
+        }
+
+        if (mInputEnded && mInputBuffer.getNumReady () < mFrameBytes && mOutputBuffer.getNumReady () == 0)
+        {
+            const bool isStdin = mInputFd == STDIN_FILENO;
+            struct stat info;
+            const bool isFile = !isStdin && ::fstat (mInputFd, &info) == 0 && S_ISREG (info.st_mode);
+
+            closeConnection ();
+
+            if (isStdin || isFile)
+            {
+                break;
+            }
+        }
+    }
+
+    mControlThread = nullptr;
+
+    if (mOptions.reportInterval > 0.0)
+    {
+        const String report = getReport () + "\n";
+        fputs (report.toRawUTF8 (), stderr);
+    }
+
+    return result;
+}
+
+bool StreamDaemon::openInput ()
+{
+    const String& input = mOptions.input;
+
+    if (input.startsWith ("unix:"))
+    {
+        if (mListenFd < 0 && (mListenFd = createListeningSocket (input.substring (5))) < 0)
+        {
+            return false;
+        }
+
+        mInputFd = acceptConnection (mListenFd, mShouldStop);
+        if (mInputFd >= 0 && mOptions.output.isEmpty ())
+        {
+            mOutputFd = mInputFd;
+        }
+    }
+    else if (input == "-")
+    {
+        mInputFd = STDIN_FILENO;
+    }
+    else
+    {
+        // opening a FIFO waits for a writer
+        mInputFd = ::open (input.toRawUTF8 (), O_RDONLY);
+    }
+
+    if (mInputFd < 0)
+    {
+        return false;
+    }
+
+    setNonBlocking (mInputFd);
+    return true;
+}
+
+bool StreamDaemon::openOutput ()
+{
+    const String& output = mOptions.output;
+
+    if (output.isEmpty () || output == "-")
+    {
+        mOutputFd = STDOUT_FILENO;
+    }
+    else
+    {
+        // opening a FIFO waits for a reader
+        mOutputFd = ::open (output.toRawUTF8 (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+
+    if (mOutputFd < 0)
+    {
+        return false;
+    }
+
+    setNonBlocking (mOutputFd);
+    return true;
+}
+
+void StreamDaemon::closeConnection ()
+{
+    if (mInputFd >= 0 && mInputFd != STDIN_FILENO)
+    {
+        ::close (mInputFd);
+    }
+    if (mOutputFd == mInputFd)
+    {
+        mOutputFd = -1;
+    }
+    mInputFd = -1;
+    mInputEnded = false;
+
+    // blocks only stay aligned with the end of the buffers if every connection starts at the beginning
+    mInputBuffer.reset ();
+    mOutputBuffer.reset ();
+    mPendingStart = mNumPending = 0;
+    mBytesQueued = mBytesWritten = 0;
+}
+
+//==============================================================================
+void StreamDaemon::readInput ()
+{
+    char* dest;
+    const int size = mInputBuffer.getWriteRegion (dest);
+
+    for (;;)
+    {
+        const ssize_t numRead = ::read (mInputFd, dest, (size_t) size);
+
+        if (numRead > 0)
+        {
+            mInputBuffer.commitWrite ((int) numRead);
+        }
+        else if (numRead == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            mInputEnded = true;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        break;
+    }
+}
+
+void StreamDaemon::processBlocks ()
+{
+    for (;;)
+    {
+        int numBytes = mInputBuffer.getNumReady ();
+
+        if (numBytes >= mBlockBytes)
+        {
+            numBytes = mBlockBytes;
+        }
+        else if (mInputEnded && numBytes >= mFrameBytes)
+        {
+            numBytes -= numBytes % mFrameBytes;
+        }
+        else
+        {
+            break;
+        }
+
+        if (mOutputBuffer.getFreeSpace () < numBytes)
+        {
+            break;
+        }
+
+        // blocks start at a multiple of the block size, and the buffers are a whole number of blocks long, so
+        // neither region is split
+        const char* src;
+        char* dest;
+        if (mInputBuffer.getReadRegion (src) < numBytes || mOutputBuffer.getWriteRegion (dest) < numBytes)
+        {
+            jassertfalse;
+            break;
+        }
+
+        const int64 startTicks = Time::getHighResolutionTicks ();
+        const int numFrames = numBytes / mFrameBytes;
+
+        mNumMessagesApplied += mControlQueue.applyAll (mChain);
+
+        readSamples (src, numFrames);
+        mChain.process (mChannels, mOptions.numChannels, numFrames);
+        writeSamples (dest, numFrames);
+
+        mInputBuffer.commitRead (numBytes);
+        mOutputBuffer.commitWrite (numBytes);
+
+        const int64 processTicks = Time::getHighResolutionTicks () - startTicks;
+        mFramesProcessed += numFrames;
+        mProcessTicks += processTicks;
+        if (processTicks > mMaxProcessTicks.get ())
+        {
+            mMaxProcessTicks = processTicks;
+        }
+
+        jassert (mNumPending < mOptions.bufferBlocks);
+        const int idx = (mPendingStart + mNumPending++) % mOptions.bufferBlocks;
+        mBytesQueued += numBytes;
+        mPendingEnd[idx] = mBytesQueued;
+        mPendingTicks[idx] = startTicks;
+    }
+}
+
+bool StreamDaemon::writeOutput ()
+{
+    while (mOutputBuffer.getNumReady () > 0)
+    {
+        const char* src;
+        const int size = mOutputBuffer.getReadRegion (src);
+        const ssize_t numWritten = ::write (mOutputFd, src, (size_t) size);
+
+        if (numWritten < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        mOutputBuffer.commitRead ((int) numWritten);
+        mBytesWritten += numWritten;
+
+        // latency of every block that has now left completely
+        const int64 now = Time::getHighResolutionTicks ();
+        while (mNumPending > 0 && mPendingEnd[mPendingStart] <= mBytesWritten)
+        {
+            const int64 latency = now - mPendingTicks[mPendingStart];
+            mLatencyTicks += latency;
+            ++mNumLatencies;
+            if (latency > mMaxLatencyTicks.get ())
+            {
+                mMaxLatencyTicks = latency;
+            }
+
+            mPendingStart = (mPendingStart + 1) % mOptions.bufferBlocks;
+            mNumPending--;
+        }
+    }
+
+    return true;
+}
+
+void StreamDaemon::readSamples (const char* src, int numFrames)
+{
+    const int numChannels = mOptions.numChannels;
+
+    if (mOptions.format == kFormatS16)
+    {
+        const int16* in = (const int16*) src;
+        for (int n = 0; n < numFrames; n++)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                mChannels[c][n] = in[n * numChannels + c] * (1.0f / 32768.0f);
+            }
+        }
+    }
+    else
+    {
+        const float* in = (const float*) src;
+        for (int n = 0; n < numFrames; n++)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                mChannels[c][n] = in[n * numChannels + c];
+            }
+        }
+    }
+}
+
+void StreamDaemon::writeSamples (char* dest, int numFrames) const
+{
+    const int numChannels = mOptions.numChannels;
+
+    if (mOptions.format == kFormatS16)
+    {
+        int16* out = (int16*) dest;
+        for (int n = 0; n < numFrames; n++)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                out[n * numChannels + c] = (int16) roundToInt (jlimit (-1.0f, 1.0f, mChannels[c][n]) * 32767.0f);
+            }
+        }
+    }
+    else
+    {
+        float* out = (float*) dest;
+        for (int n = 0; n < numFrames; n++)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                out[n * numChannels + c] = mChannels[c][n];
+            }
+        }
+    }
+}
+
+//==============================================================================
+String StreamDaemon::getReport ()
+{
+    const int64 now = Time::getHighResolutionTicks ();
+    const int64 frames = mFramesProcessed.get ();
+    const int64 processTicks = mProcessTicks.get ();
+    const int64 latencyTicks = mLatencyTicks.get ();
+    const int64 numLatencies = mNumLatencies.get ();
+
+    const int64 numFrames = frames - mReportFrames;
+    const int64 numBlockLatencies = numLatencies - mReportNumLatencies;
+    const double seconds = Time::highResolutionTicksToSeconds (now - mReportTicks);
+    const double audioSeconds = numFrames / mOptions.sampleRate;
+    const double throughput = seconds > 0.0 ? numFrames / seconds : 0.0;
+    const double load =
+        audioSeconds > 0.0 ? Time::highResolutionTicksToSeconds (processTicks - mReportProcessTicks) / audioSeconds : 0.0;
+
+    String report;
+    report << "frames " << numFrames << " in " << String (seconds, 1) << " s, " << String (roundToInt (throughput))
+           << " frames/s (" << String (throughput / mOptions.sampleRate, 2) << "x realtime), DSP load "
+           << String (load * 100.0, 1) << "% (max block " << formatMs (mMaxProcessTicks.exchange (0))
+           << " ms), latency " << String (mOptions.blockSize * 1000.0 / mOptions.sampleRate, 3) << " ms block + "
+           << formatMs (numBlockLatencies > 0 ? (latencyTicks - mReportLatencyTicks) / numBlockLatencies : 0)
+           << " ms mean / " << formatMs (mMaxLatencyTicks.exchange (0)) << " ms max to output, "
+           << mNumMessagesApplied.get () << " control messages applied";
+
+    mReportTicks = now;
+    mReportFrames = frames;
+    mReportProcessTicks = processTicks;
+    mReportLatencyTicks = latencyTicks;
+    mReportNumLatencies = numLatencies;
+
+    return report;
+}
+
+}  // namespace Audealize
@@ -0,0 +1,182 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef StreamDaemon_h
+#define StreamDaemon_h
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <audealize_module/audealize_dsp.h>
+
+namespace Audealize
+{
+/// Runs a stream of interleaved PCM through an EffectChain, as a stage in a pipeline of processes.
+///
+/// Audio is read from stdin, a FIFO or a Unix socket connection and written to stdout, a FIFO or back over the
+/// connection. A single thread polls both ends and reads and writes directly into and out of two ring buffers.
+/// Whenever a full block has arrived it is processed at once, so the output trails the input by exactly one block
+/// plus the processing time.
+///
+/// Descriptor and amount changes arrive as text lines on a Unix control socket. A control thread looks up the
+/// descriptors and computes the effect parameters, then hands them to the audio thread through a ControlQueue, so
+/// the audio thread never allocates or blocks on a lock. The same thread prints a latency and throughput report.
+class StreamDaemon
+{
+public:
+    enum SampleFormat
+    {
+        kFormatS16 = 0,  // signed 16 bit integers, native byte order
+        kFormatF32       // 32 bit floats, native byte order
+    };
+
+    struct Options
+    {
+        String input = "-";      // "-" for stdin, a file or FIFO path, or "unix:<path>" to listen on a Unix socket
+        String output;           // "-" for stdout or a file or FIFO path. Empty for the input connection or stdout
+        String control;          // path of the control socket, or empty for none
+        File descriptorDir;      // directory holding eqdescriptors.json and reverbdescriptors.json
+        SampleFormat format = kFormatS16;
+        int numChannels = 2;
+        double sampleRate = 44100.0;
+        int blockSize = 128;     // frames per block, which is the latency of the stage
+        int bufferBlocks = 8;    // size of each ring buffer, in blocks
+        double reportInterval = 0.0;  // seconds between reports on stderr, or 0 for none
+    };
+
+    StreamDaemon (const Options& options);
+    ~StreamDaemon ();
+
+    /**
+     *  Loads the descriptor sets from the descriptor directory
+     *
+     *  @return false if neither set could be loaded
+     */
+    bool loadDescriptors ();
+
+    /**
+     *  Handles one control message. Called on the control thread, or before run ()
+     *
+     *  Messages are "eq <word> [amount]", "reverb <word> [amount]", "amount eq|reverb <amount>",
+     *  "enable eq|reverb", "bypass eq|reverb" and "report".
+     *
+     *  @return the reply, which starts with "ok" or "error"
+     */
+    String handleCommand (const String& command);
+
+    /**
+     *  Processes the stream until stop () is called or, for stdin and regular files, the input ends. FIFOs are
+     *  reopened and the next socket connection accepted when their input ends
+     *
+     *  @return 0 on success, 1 if the input, output or control socket couldn't be opened
+     */
+    int run ();
+
+    /**
+     *  Makes run () return. Safe to call from a signal handler
+     */
+    void stop ()
+    {
+        mShouldStop.set (1);
+    }
+
+    /**
+     *  Returns a one line summary of the latency and throughput since the last report
+     */
+    String getReport ();
+
+private:
+    class ControlThread;
+
+    Options mOptions;
+    int mFrameBytes, mBlockBytes;
+
+    EffectChain mChain;
+    ControlQueue mControlQueue;
+    ScopedPointer<ControlThread> mControlThread;
+
+    DescriptorSet mEQDescriptors, mReverbDescriptors;
+
+    // the settings the control thread last sent, used to apply amount changes
+    vector<float> mEQSettings, mReverbSettings;
+    float mEQAmount, mReverbAmount;
+
+    StreamRingBuffer mInputBuffer, mOutputBuffer;
+    HeapBlock<float> mChannelData;
+    float* mChannels[2];
+
+    int mInputFd, mOutputFd, mListenFd;
+    int mStdinFlags, mStdoutFlags;  // original flags of stdin and stdout, restored on exit
+    bool mInputEnded;
+
+    // blocks in the output buffer, as the output byte count at their end and the time they were processed
+    HeapBlock<int64> mPendingEnd, mPendingTicks;
+    int mPendingStart, mNumPending;
+    int64 mBytesQueued, mBytesWritten;
+
+    Atomic<int> mShouldStop;
+
+    // statistics, written by the audio thread and read by getReport ()
+    Atomic<int64> mFramesProcessed, mProcessTicks, mMaxProcessTicks;
+    Atomic<int64> mLatencyTicks, mMaxLatencyTicks, mNumLatencies;
+    Atomic<int> mNumMessagesApplied;
+
+    // the statistics at the last report, control thread only
+    int64 mReportTicks, mReportFrames, mReportProcessTicks, mReportLatencyTicks, mReportNumLatencies;
+
+    bool openInput ();
+    bool openOutput ();
+    void closeConnection ();
+
+    /**
+     *  Reads as much of the input as fits into the input buffer's write region
+     */
+    void readInput ();
+
+    /**
+     *  Processes every complete block in the input buffer that fits into the output buffer. Once the input has ended,
+     *  a final partial block is processed too
+     */
+    void processBlocks ();
+
+    /**
+     *  Writes as much of the output buffer as the output takes without blocking
+     *
+     *  @return false if the output has been closed
+     */
+    bool writeOutput ();
+
+    void readSamples (const char* src, int numFrames);
+    void writeSamples (char* dest, int numFrames) const;
+
+    /**
+     *  Sends the current settings of one effect to the audio thread
+     */
+    String sendEQ ();
+    String sendReverb ();
+    String sendEnabled (EffectChain::Effect effect, bool enabled);
+
+    JUCE_DECLARE_NON_COPYABLE (StreamDaemon)
+};
+
+}  // namespace Audealize
+
+#endif /* StreamDaemon_h */
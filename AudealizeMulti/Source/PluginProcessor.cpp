@@ -25,8 +25,15 @@
 
 using std::vector;
 
+// offline renders pipeline the EQ and reverb stages over sub-blocks of at least this many samples, and at most this
+// many per host block. Shorter host blocks, and all blocks on single core machines, are processed serially, as the
+// hand-over would cost more than it saves
+static const int offlineMinSubBlockSamples = 256;
+static const int offlineMaxSubBlocks = 8;
+
 //==============================================================================
 AudealizeMultiAudioProcessor::AudealizeMultiAudioProcessor ()
+    : mStageBuffer (nullptr), mStageSubBlockSize (0), mStageNumSubBlocks (0)
 {
     mEQAudioProcessor = new AudealizeeqAudioProcessor (this);
     mReverbAudioProcessor = new AudealizereverbAudioProcessor (this);
@@ -35,6 +42,10 @@ AudealizeMultiAudioProcessor::AudealizeMultiAudioProcessor ()
 
 AudealizeMultiAudioProcessor::~AudealizeMultiAudioProcessor ()
 {
+    // reverb stage jobs that are still queued belong to blocks that have already been finished, but refer to this
+    mStageToken.cancel ();
+    mWorkerPool->waitFor (mStageToken);
+
     mEQAudioProcessor = nullptr;
     mReverbAudioProcessor = nullptr;
 }
@@ -146,8 +157,92 @@ void AudealizeMultiAudioProcessor::processBlock (AudioSampleBuffer& buffer, Midi
     // this code if your algorithm always overwrites all the output channels.
     for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i) buffer.clear (i, 0, buffer.getNumSamples ());
 
-    mEQAudioProcessor->processBlock (buffer, midiMessages);
-    mReverbAudioProcessor->processBlock (buffer, midiMessages);
+    if (isNonRealtime () && SystemStats::getNumCpus () > 1 && buffer.getNumSamples () >= 2 * offlineMinSubBlockSamples)
+    {
+        processStagesPipelined (buffer, midiMessages);
+    }
+    else
+    {
+        mEQAudioProcessor->processBlock (buffer, midiMessages);
+        mReverbAudioProcessor->processBlock (buffer, midiMessages);
+    }
+}
+
+void AudealizeMultiAudioProcessor::processStagesPipelined (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
+{
+    const int numSamples = buffer.getNumSamples ();
+
+    mStageBuffer = &buffer;
+    mStageNumSubBlocks = jmin (offlineMaxSubBlocks, numSamples / offlineMinSubBlockSamples);
+    mStageSubBlockSize = (numSamples + mStageNumSubBlocks - 1) / mStageNumSubBlocks;
+    mEQSubBlocksDone = 0;
+    mReverbSubBlocksDone = 0;
+
+    // every block's reverb stage is claimed by exactly one thread, so a job left over from an earlier block that was
+    // finished without it finds its generation taken and does nothing
+    const int generation = ++mStageGeneration;
+    mWorkerPool->submit ("Offline reverb stage", WorkerPool::kPriorityInteractive, mStageToken,
+                         [this, generation] () {
+                             if (mStageClaimed.compareAndSetBool (generation, generation - 1))
+                             {
+                                 runReverbStage ();
+                             }
+                         });
+
+    // parameter smoothing advances once per host block, on the first sub-block, as it does when not pipelining
+    for (int i = 0; i < mStageNumSubBlocks; i++)
+    {
+        AudioSampleBuffer subBlock = getStageSubBlock (i);
+        mEQAudioProcessor->setLaterSubBlock (i > 0);
+        mEQAudioProcessor->processBlock (subBlock, midiMessages);
+
+        ++mEQSubBlocksDone;
+        mEQProgress.signal ();
+    }
+    mEQAudioProcessor->setLaterSubBlock (false);
+
+    if (mStageClaimed.compareAndSetBool (generation, generation - 1))
+    {
+        runReverbStage ();
+    }
+
+    while (mReverbSubBlocksDone.get () < mStageNumSubBlocks)
+    {
+        mReverbProgress.wait ();
+    }
+
+    mStageBuffer = nullptr;
+}
+
+void AudealizeMultiAudioProcessor::runReverbStage ()
+{
+    for (int i = 0; i < mStageNumSubBlocks; i++)
+    {
+        while (mEQSubBlocksDone.get () <= i)
+        {
+            mEQProgress.wait ();
+        }
+
+        AudioSampleBuffer subBlock = getStageSubBlock (i);
+        mReverbAudioProcessor->setLaterSubBlock (i > 0);
+        mReverbAudioProcessor->processBlock (subBlock, mStageMidi);
+
+        // reset before the last sub-block is signalled, after which the calling thread may run the next block
+        if (i == mStageNumSubBlocks - 1)
+        {
+            mReverbAudioProcessor->setLaterSubBlock (false);
+        }
+
+        ++mReverbSubBlocksDone;
+        mReverbProgress.signal ();
+    }
+}
+
+AudioSampleBuffer AudealizeMultiAudioProcessor::getStageSubBlock (int index)
+{
+    const int start = index * mStageSubBlockSize;
+    return AudioSampleBuffer (mStageBuffer->getArrayOfWritePointers (), mStageBuffer->getNumChannels (), start,
+                              jmin (mStageSubBlockSize, mStageBuffer->getNumSamples () - start));
 }
 
 //==============================================================================
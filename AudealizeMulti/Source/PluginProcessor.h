@@ -75,7 +75,7 @@ public:
     {
     }
 
-    void settingsFromMap (vector<float> settings) override
+    void settingsFromMap (vector<float> settings, bool crossfade) override
     {
     }
 
@@ -89,12 +89,56 @@ public:
         return true;
     }
 
+    void addMemoryUsage (MemoryUsage& usage) override
+    {
+        AudealizeAudioProcessor::addMemoryUsage (usage);
+        mEQAudioProcessor->addMemoryUsage (usage);
+        mReverbAudioProcessor->addMemoryUsage (usage);
+    }
+
+    float getParameterUpdatesPerSecond () override
+    {
+        return mEQAudioProcessor->getParameterUpdatesPerSecond () +
+               mReverbAudioProcessor->getParameterUpdatesPerSecond ();
+    }
+
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudealizeMultiAudioProcessor)
 
     ScopedPointer<AudealizeeqAudioProcessor> mEQAudioProcessor;
     ScopedPointer<AudealizereverbAudioProcessor> mReverbAudioProcessor;
+
+    /**
+     *  processBlock for offline renders. The block is split into sub-blocks; the EQ stage runs through them on the
+     *  calling thread while a worker runs the reverb stage one sub-block behind it. If no worker has picked the reverb
+     *  stage up by the time the EQ stage is done, the calling thread runs it too
+     */
+    void processStagesPipelined (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
+
+    /**
+     *  Runs the reverb stage over the sub-blocks of the block being pipelined, waiting for the EQ stage to finish each
+     */
+    void runReverbStage ();
+
+    /**
+     *  Returns a buffer referring to one sub-block of the block being pipelined
+     */
+    AudioSampleBuffer getStageSubBlock (int index);
+
+    SharedResourcePointer<WorkerPool> mWorkerPool;
+    WorkerPool::CancellationToken mStageToken;  // reverb stage jobs
+
+    // the block being pipelined. only valid during processStagesPipelined
+    AudioSampleBuffer* mStageBuffer;
+    int mStageSubBlockSize;
+    int mStageNumSubBlocks;
+    MidiBuffer mStageMidi;  // passed to the reverb stage, so the host's buffer is only touched by the calling thread
+
+    Atomic<int> mStageGeneration;  // counts pipelined blocks
+    Atomic<int> mStageClaimed;     // generation of the last block whose reverb stage a thread has taken on
+    Atomic<int> mEQSubBlocksDone, mReverbSubBlocksDone;
+    WaitableEvent mEQProgress, mReverbProgress;  // signalled each time a stage finishes a sub-block
 };
 
 #endif  // PLUGINPROCESSOR_H_INCLUDED
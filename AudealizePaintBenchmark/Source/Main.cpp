@@ -0,0 +1,92 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "PaintBenchmark.h"
+
+using namespace Audealize;
+
+static void printUsage ()
+{
+    fputs ("Usage: AudealizePaintBenchmark [options]\n"
+           "\n"
+           "Paints the word maps, the traditional UIs, single knobs and both editors offscreen and prints the frame\n"
+           "times and allocations per frame of each.\n"
+           "\n"
+           "  --descriptors <dir>  Directory holding eqdescriptors.json and reverbdescriptors.json\n"
+           "                       (default: the executable's directory)\n"
+           "  --frames <n>         Frames painted by each benchmark (default 30)\n",
+           stderr);
+}
+
+int main (int argc, char* argv[])
+{
+    File descriptorDir = File::getSpecialLocation (File::currentExecutableFile).getParentDirectory ();
+    int numFrames = 30;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const String arg (argv[i]);
+        const String value (i + 1 < argc ? argv[i + 1] : "");
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage ();
+            return 0;
+        }
+        if (!arg.startsWith ("--") || i + 1 >= argc)
+        {
+            printUsage ();
+            return 1;
+        }
+        i++;
+
+        if (arg == "--descriptors")
+            descriptorDir = File::getCurrentWorkingDirectory ().getChildFile (value);
+        else if (arg == "--frames")
+            numFrames = value.getIntValue ();
+        else
+        {
+            printUsage ();
+            return 1;
+        }
+    }
+
+    const File eqDescriptors = descriptorDir.getChildFile ("eqdescriptors.json");
+    const File reverbDescriptors = descriptorDir.getChildFile ("reverbdescriptors.json");
+
+    if (numFrames < 1 || !eqDescriptors.existsAsFile () || !reverbDescriptors.existsAsFile ())
+    {
+        printUsage ();
+        return 1;
+    }
+
+    // the components must be created and painted on the message thread
+    ScopedJuceInitialiser_GUI juceInitialiser;
+
+    PaintBenchmark benchmark (numFrames);
+    benchmark.runAll (eqDescriptors, reverbDescriptors);
+
+    fputs (benchmark.getReport ().toRawUTF8 (), stdout);
+    return 0;
+}
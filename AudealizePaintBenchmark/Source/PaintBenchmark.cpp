@@ -0,0 +1,493 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "PaintBenchmark.h"
+
+#ifndef AUDEALIZE_COUNT_ALLOCATIONS
+#define AUDEALIZE_COUNT_ALLOCATIONS 0
+#endif
+
+#if AUDEALIZE_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+
+namespace
+{
+std::atomic<long long> numAllocations (0);
+}
+
+void* operator new (size_t size)
+{
+    numAllocations++;
+    if (void* p = std::malloc (size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc ();
+}
+
+void* operator new[] (size_t size)
+{
+    return operator new (size);
+}
+
+void operator delete (void* p) noexcept
+{
+    std::free (p);
+}
+
+void operator delete[] (void* p) noexcept
+{
+    std::free (p);
+}
+#endif
+
+namespace Audealize
+{
+namespace
+{
+// sizes of the WordMap, the traditional UIs and the editors, from small to large
+const int mapSizes[][2] = {{480, 300}, {720, 420}, {1080, 640}};
+const int traditionalUISizes[][2] = {{400, 150}, {700, 250}, {1000, 350}};
+const int editorSizes[][2] = {{MIN_WIDTH, MIN_HEIGHT}, {840, 560}, {MAX_WIDTH, MAX_HEIGHT}};
+
+// a small style knob, and the two sizes of the full style
+const int knobSizes[] = {24, 48, 80};
+
+const float datasetFractions[] = {0.25f, 0.5f, 1.0f};
+
+int64 getNumAllocations ()
+{
+#if AUDEALIZE_COUNT_ALLOCATIONS
+    return numAllocations.load ();
+#else
+    return 0;
+#endif
+}
+
+enum MouseAction
+{
+    kMouseMove = 0,
+    kMouseDown,
+    kMouseDrag,
+    kMouseUp
+};
+
+/**
+ *  Calls one of a component's mouse callbacks with a synthesised event, as if the mouse was over it
+ */
+void sendMouseEvent (Component& c, MouseAction action, Point<float> position, Point<float> mouseDownPosition)
+{
+    const Time now = Time::getCurrentTime ();
+    const bool buttonDown = action == kMouseDown || action == kMouseDrag;
+
+    const MouseEvent e (Desktop::getInstance ().getMainMouseSource (), position,
+                        buttonDown ? ModifierKeys (ModifierKeys::leftButtonModifier) : ModifierKeys (), 0.0f, &c, &c,
+                        now, mouseDownPosition, now, 1, action == kMouseDrag);
+
+    switch (action)
+    {
+        case kMouseMove:
+            c.mouseMove (e);
+            break;
+        case kMouseDown:
+            c.mouseDown (e);
+            break;
+        case kMouseDrag:
+            c.mouseDrag (e);
+            break;
+        case kMouseUp:
+            c.mouseUp (e);
+            break;
+    }
+}
+
+/**
+ *  Returns a point on a closed loop around the middle of a component, for hover sequences
+ */
+Point<float> getHoverPosition (const Component& c, int frame, int numFrames)
+{
+    const float t = 2.0f * float_Pi * frame / jmax (1, numFrames);
+    return Point<float> (c.getWidth () * (0.5f + 0.4f * std::cos (t)), c.getHeight () * (0.5f + 0.4f * std::sin (2 * t)));
+}
+
+/// AudealizeLookAndFeel with drawRotarySlider as it was before the knob geometry was cached: every path is built, and
+/// the outlines stroked, on each paint. Only used to measure what the cache saves, so don't change it
+class UncachedKnobLookAndFeel : public AudealizeLookAndFeel
+{
+public:
+    void drawRotarySlider (Graphics& g, int x, int y, int width, int height, float sliderPos,
+                           const float rotaryStartAngle, const float rotaryEndAngle, Slider& slider) override
+    {
+        const float radius = jmin (width / 2, height / 2) - 2.0f;
+        const float centreX = x + width * 0.5f;
+        const float centreY = y + height * 0.5f;
+        const float rx = centreX - radius;
+        const float ry = centreY - radius;
+        const float rw = radius * 2.0f;
+        const float angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
+        const bool isMouseOver = slider.isMouseOverOrDragging () && slider.isEnabled ();
+
+        if (radius > 12.0f)
+        {
+            const float thickness = 0.78;
+
+            int knobRadius = radius * .68;
+
+            Path e;
+            e.addEllipse (centreX - knobRadius, centreY - knobRadius, knobRadius * 2, knobRadius * 2);
+
+            g.setColour (findColour (Slider::ColourIds::thumbColourId));
+            g.fillPath (e);
+
+            if (shouldDrawOutlines)
+            {
+                g.setColour (this->outline);
+                g.drawEllipse (centreX - knobRadius, centreY - knobRadius, knobRadius * 2, knobRadius * 2, 1);
+            }
+
+            Path backgroundArc;
+            backgroundArc.addPieSegment (rx, ry, rw, rw, rotaryStartAngle, rotaryEndAngle, thickness);
+            backgroundArc.closeSubPath ();
+
+            g.setColour (findColour (Slider::trackColourId));
+            g.fillPath (backgroundArc);
+
+            if (shouldDrawOutlines)
+            {
+                g.setColour (this->outline);
+                g.strokePath (backgroundArc, PathStrokeType (1));
+            }
+
+            if (slider.isEnabled ())
+                g.setColour (slider.findColour (Slider::rotarySliderFillColourId).withAlpha (isMouseOver ? 1.0f : 0.7f));
+            else
+                g.setColour (Colour (0x80808080));
+
+            Path filledArc;
+            filledArc.addPieSegment (rx, ry, rw, rw, rotaryStartAngle, angle, thickness);
+            g.fillPath (filledArc);
+
+            if (shouldDrawOutlines)
+            {
+                g.setColour (this->outline);
+                g.strokePath (filledArc, PathStrokeType (1));
+            }
+
+            Path p;
+            float rectHeight = radius * .3f;
+            float rectWidth = radius * .15f;
+            p.addRoundedRectangle (-rectWidth * .5, -rectHeight * 1.8, rectWidth, rectHeight, rectWidth * .5);
+
+            g.setColour (findColour (Slider::trackColourId).darker (.3));
+            g.fillPath (p, AffineTransform::rotation (angle).translated (centreX, centreY));
+        }
+        else
+        {
+            Path p;
+            p.addEllipse (-0.4f * rw, -0.4f * rw, rw * 0.8f, rw * 0.8f);
+            PathStrokeType (rw * 0.1f).createStrokedPath (p, p);
+
+            p.addLineSegment (Line<float> (0.0f, 0.0f, 0.0f, -radius), rw * 0.2f);
+
+            if (slider.isEnabled ())
+                g.setColour (slider.findColour (Slider::rotarySliderFillColourId).withAlpha (isMouseOver ? 1.0f : 0.7f));
+            else
+                g.setColour (Colour (0x80808080));
+
+            g.fillPath (p, AffineTransform::rotation (angle).translated (centreX, centreY));
+        }
+    }
+};
+}
+
+PaintBenchmark::PaintBenchmark (int numFrames) : mNumFrames (jmax (1, numFrames))
+{
+}
+
+void PaintBenchmark::runAll (const File& eqDescriptors, const File& reverbDescriptors)
+{
+    AudealizeeqAudioProcessor eq;
+    AudealizereverbAudioProcessor reverb;
+    eq.getValueTreeState ().state = ValueTree (Identifier ("AudealizeEQ"));
+    reverb.getValueTreeState ().state = ValueTree (Identifier ("AudealizeReverb"));
+
+    const json eqSet = json::parse (eqDescriptors.loadFileAsString ().toStdString ());
+    const json reverbSet = json::parse (reverbDescriptors.loadFileAsString ().toStdString ());
+
+    for (const float fraction : datasetFractions)
+    {
+        benchmarkWordMap (eq, selectDescriptors (eqSet, fraction), "EQ map");
+        benchmarkWordMap (reverb, selectDescriptors (reverbSet, fraction), "Reverb map");
+    }
+
+    Array<Rectangle<int>> sizes;
+    for (const auto& size : traditionalUISizes)
+    {
+        sizes.add (Rectangle<int> (size[0], size[1]));
+    }
+
+    {
+        const String gainId = eq.getParamID (0);
+        GraphicEQComponent graphicEQ (eq, NUMBANDS, eq.getValueTreeState ().getParameterRange (gainId));
+        graphicEQ.setLookAndFeel (&mResources->getLookAndFeel (false));
+        benchmarkComponent (graphicEQ, sizes, "Graphic EQ");
+
+        // drag across every band, up and down
+        measure (graphicEQ, "Graphic EQ drag", 0, [&graphicEQ, this](int frame) {
+            const Point<float> start (2.0f, graphicEQ.getHeight () * 0.5f);
+            if (frame == 0)
+            {
+                sendMouseEvent (graphicEQ, kMouseDown, start, start);
+            }
+
+            const float x = graphicEQ.getWidth () * (frame + 0.5f) / mNumFrames;
+            const float y = graphicEQ.getHeight () * (0.5f + 0.4f * std::sin (frame * 0.7f));
+            sendMouseEvent (graphicEQ, frame == mNumFrames - 1 ? kMouseUp : kMouseDrag, Point<float> (x, y), start);
+        });
+    }
+
+    {
+        ReverbComponent reverbUI (reverb);
+        reverbUI.setLookAndFeel (&mResources->getLookAndFeel (false));
+        benchmarkComponent (reverbUI, sizes, "Reverb knobs");
+    }
+
+    benchmarkKnobs ();
+
+    // the editors save their size when they are deleted. put back the user's
+    const var windowWidth = Properties::getProperty (Properties::propertyIds::windowWidth);
+    const var windowHeight = Properties::getProperty (Properties::propertyIds::windowHeight);
+
+    {
+        ScopedPointer<TraditionalUI> graphicEQ =
+            new GraphicEQComponent (eq, NUMBANDS, eq.getValueTreeState ().getParameterRange (eq.getParamID (0)));
+        AudealizeUI editor (eq, graphicEQ, eqDescriptors.getFullPathName (), "EQ", false);
+        benchmarkEditor (editor, "EQ editor");
+    }
+
+    {
+        ScopedPointer<TraditionalUI> reverbUI = new ReverbComponent (reverb);
+        AudealizeUI editor (reverb, reverbUI, reverbDescriptors.getFullPathName (), "Reverb", false);
+        benchmarkEditor (editor, "Reverb editor");
+    }
+
+    Properties::setProperty (Properties::propertyIds::windowWidth, windowWidth);
+    Properties::setProperty (Properties::propertyIds::windowHeight, windowHeight);
+}
+
+void PaintBenchmark::benchmarkWordMap (AudealizeAudioProcessor& p, const json& descriptors, const String& name)
+{
+    WordMap map (p, descriptors);
+    map.setLookAndFeel (&mResources->getLookAndFeel (false));
+
+    const int numDescriptors = getNumDescriptors (descriptors);
+
+    for (const auto& size : mapSizes)
+    {
+        map.setSize (size[0], size[1]);
+        measure (map, name, numDescriptors, nullptr);
+    }
+
+    map.setSize (mapSizes[1][0], mapSizes[1][1]);
+
+    measure (map, name + " hover", numDescriptors, [&map, this](int frame) {
+        sendMouseEvent (map, kMouseMove, getHoverPosition (map, frame, mNumFrames), Point<float> ());
+        map.handleUpdateNowIfNeeded ();
+    });
+
+    // press, drag around the loop and release: selects descriptors and sets the processor's parameters
+    measure (map, name + " drag", numDescriptors, [&map, this](int frame) {
+        const Point<float> start = getHoverPosition (map, 0, mNumFrames);
+        const Point<float> position = getHoverPosition (map, frame, mNumFrames);
+        const MouseAction action = frame == 0 ? kMouseDown : frame == mNumFrames - 1 ? kMouseUp : kMouseDrag;
+
+        sendMouseEvent (map, action, position, start);
+        map.handleUpdateNowIfNeeded ();
+    });
+}
+
+void PaintBenchmark::benchmarkComponent (Component& component, const Array<Rectangle<int>>& sizes,
+                                         const String& name)
+{
+    for (const Rectangle<int>& size : sizes)
+    {
+        component.setSize (size.getWidth (), size.getHeight ());
+        measure (component, name, 0, nullptr);
+    }
+}
+
+void PaintBenchmark::benchmarkEditor (AudealizeUI& editor, const String& name)
+{
+    WordMap* map = editor.getWordMap ();
+    const int numDescriptors = (int) map->getWords ().size ();
+
+    for (const auto& size : editorSizes)
+    {
+        editor.setSize (size[0], size[1]);
+        measure (editor, name, numDescriptors, nullptr);
+    }
+
+    editor.setSize (editorSizes[1][0], editorSizes[1][1]);
+
+    measure (editor, name + " hover", numDescriptors, [map, this](int frame) {
+        sendMouseEvent (*map, kMouseMove, getHoverPosition (*map, frame, mNumFrames), Point<float> ());
+        map->handleUpdateNowIfNeeded ();
+    });
+}
+
+void PaintBenchmark::benchmarkKnobs ()
+{
+    AudealizeLookAndFeel cached;
+    UncachedKnobLookAndFeel uncached;
+    cached.setOutlines (true);
+    uncached.setOutlines (true);
+
+    Slider knob (Slider::RotaryHorizontalVerticalDrag, Slider::NoTextBox);
+    knob.setRange (0.0, 1.0);
+
+    // sweep the value, as when the knob follows automation, so the filled arc changes every frame
+    const std::function<void (int)> sweep = [&knob, this](int frame) {
+        knob.setValue ((double) frame / jmax (1, mNumFrames - 1), dontSendNotification);
+    };
+
+    for (const int size : knobSizes)
+    {
+        knob.setSize (size, size);
+
+        knob.setLookAndFeel (&uncached);
+        measure (knob, "Knob, uncached", 0, sweep);
+
+        knob.setLookAndFeel (&cached);
+        measure (knob, "Knob", 0, sweep);
+    }
+
+    knob.setLookAndFeel (nullptr);
+}
+
+void PaintBenchmark::measure (Component& component, const String& name, int numDescriptors,
+                              std::function<void (int)> step)
+{
+    Image image (Image::ARGB, jmax (1, component.getWidth ()), jmax (1, component.getHeight ()), true);
+
+    // the first paint creates glyph and path caches, which later frames reuse
+    {
+        Graphics g (image);
+        component.paintEntireComponent (g, false);
+    }
+
+    vector<double> times ((size_t) mNumFrames);
+    double total = 0.0;
+    const int64 allocationsBefore = getNumAllocations ();
+
+    for (int frame = 0; frame < mNumFrames; frame++)
+    {
+        const int64 start = Time::getHighResolutionTicks ();
+
+        if (step)
+        {
+            step (frame);
+        }
+
+        Graphics g (image);
+        component.paintEntireComponent (g, false);
+
+        times[frame] = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks () - start) * 1000.0;
+        total += times[frame];
+    }
+
+    const int64 numAllocations = getNumAllocations () - allocationsBefore;
+
+    Result result;
+    result.name = name;
+    result.width = component.getWidth ();
+    result.height = component.getHeight ();
+    result.numDescriptors = numDescriptors;
+    result.numFrames = mNumFrames;
+    result.meanMs = total / mNumFrames;
+    result.maxMs = *std::max_element (times.begin (), times.end ());
+    std::sort (times.begin (), times.end ());
+    result.medianMs = times[times.size () / 2];
+    result.allocationsPerFrame = isCountingAllocations () ? (double) numAllocations / mNumFrames : -1.0;
+
+    mResults.add (result);
+}
+
+String PaintBenchmark::getReport () const
+{
+    String report;
+    report << String ("benchmark").paddedRight (' ', 24) << String ("size").paddedLeft (' ', 10)
+           << String ("words").paddedLeft (' ', 7) << String ("mean ms").paddedLeft (' ', 10)
+           << String ("median ms").paddedLeft (' ', 11) << String ("max ms").paddedLeft (' ', 10)
+           << String ("allocs").paddedLeft (' ', 10) << newLine;
+
+    for (const Result& r : mResults)
+    {
+        report << r.name.paddedRight (' ', 24) << (String (r.width) + "x" + String (r.height)).paddedLeft (' ', 10)
+               << String (r.numDescriptors).paddedLeft (' ', 7) << String (r.meanMs, 3).paddedLeft (' ', 10)
+               << String (r.medianMs, 3).paddedLeft (' ', 11) << String (r.maxMs, 3).paddedLeft (' ', 10)
+               << (r.allocationsPerFrame < 0 ? String ("-") : String (r.allocationsPerFrame, 1)).paddedLeft (' ', 10)
+               << newLine;
+    }
+
+    return report;
+}
+
+bool PaintBenchmark::isCountingAllocations ()
+{
+    return AUDEALIZE_COUNT_ALLOCATIONS != 0;
+}
+
+json PaintBenchmark::selectDescriptors (const json& descriptors, float fraction)
+{
+    const bool compact = descriptors.is_object () && descriptors.find ("descriptors") != descriptors.end ();
+    const json& all = compact ? descriptors["descriptors"] : descriptors;
+
+    const int numAll = (int) all.size ();
+    const int numSelected = jlimit (1, jmax (1, numAll), roundToInt (numAll * fraction));
+
+    json selected = json::array ();
+    for (int i = 0; i < numSelected && numAll > 0; i++)
+    {
+        selected.push_back (all[(size_t) ((int64) i * numAll / numSelected)]);
+    }
+
+    if (compact)
+    {
+        json result = descriptors;
+        result["descriptors"] = selected;
+        return result;
+    }
+
+    return selected;
+}
+
+int PaintBenchmark::getNumDescriptors (const json& descriptors)
+{
+    if (descriptors.is_object () && descriptors.find ("descriptors") != descriptors.end ())
+    {
+        return (int) descriptors["descriptors"].size ();
+    }
+    return (int) descriptors.size ();
+}
+}
@@ -0,0 +1,155 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PaintBenchmark_h
+#define PaintBenchmark_h
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+namespace Audealize
+{
+/// Paints the WordMap, the traditional UIs and complete AudealizeUI editors into offscreen Images, at several sizes
+/// and descriptor dataset sizes, and measures how long each frame takes. Some benchmarks also send the WordMap or the
+/// graphic EQ a sequence of hover or drag events before each frame, so the time spent handling the events (and the
+/// parameter changes they make) is included.
+///
+/// Everything runs on the calling thread, which must be the message thread. Nothing is put on screen, so it also runs
+/// without a display.
+///
+/// Allocations are only counted if this file is built with AUDEALIZE_COUNT_ALLOCATIONS=1, which replaces the global
+/// operator new and delete with counting versions. The AudealizePaintBenchmark project is built that way.
+class PaintBenchmark
+{
+public:
+    /// The measurements of one benchmark
+    struct Result
+    {
+        String name;
+        int width, height;
+        int numDescriptors;          // descriptors on the map, or 0 for components without one
+        int numFrames;
+        double meanMs, medianMs, maxMs;
+        double allocationsPerFrame;  // -1 if allocations aren't being counted
+    };
+
+    /**
+     *  Constructor
+     *
+     *  @param numFrames Number of frames painted by each benchmark
+     */
+    PaintBenchmark (int numFrames = 30);
+
+    /**
+     *  Runs every benchmark with a private EQ and reverb processor: WordMaps with a quarter, half and all of each
+     *  descriptor set, painted still and during hover and drag sequences; the graphic EQ (also while dragging across
+     *  the bands), the reverb knobs and single knobs (see benchmarkKnobs ()); and both editors. Results are added to
+     *  getResults ()
+     *
+     *  @param eqDescriptors     Descriptor data file of the EQ
+     *  @param reverbDescriptors Descriptor data file of the reverb
+     */
+    void runAll (const File& eqDescriptors, const File& reverbDescriptors);
+
+    /**
+     *  Benchmarks a WordMap showing a set of descriptors: still frames at each map size, then hover and drag sequences
+     *
+     *  @param p           Processor the map controls
+     *  @param descriptors Descriptor set, as passed to the WordMap constructor
+     *  @param name        Name the results are reported under
+     */
+    void benchmarkWordMap (AudealizeAudioProcessor& p, const json& descriptors, const String& name);
+
+    /**
+     *  Benchmarks still frames of a component at a set of sizes
+     *
+     *  @param component Component to paint. Resized by the benchmark
+     *  @param sizes     Sizes to paint it at
+     *  @param name      Name the results are reported under
+     */
+    void benchmarkComponent (Component& component, const Array<Rectangle<int>>& sizes, const String& name);
+
+    /**
+     *  Benchmarks an AudealizeUI: still frames at each editor size, and frames with a hover sequence over its map
+     *
+     *  @param editor The editor. Resized by the benchmark
+     *  @param name   Name the results are reported under
+     */
+    void benchmarkEditor (AudealizeUI& editor, const String& name);
+
+    /**
+     *  Benchmarks a single rotary slider at several sizes, with outlines, while its value sweeps its range. It is
+     *  painted by the AudealizeLookAndFeel, reported as "Knob", and by a copy of its drawRotarySlider from before the
+     *  knob geometry was cached, reported as "Knob, uncached"
+     */
+    void benchmarkKnobs ();
+
+    /**
+     *  Returns the results of every benchmark run so far
+     */
+    const Array<Result>& getResults () const
+    {
+        return mResults;
+    }
+
+    /**
+     *  Returns the results as a table, one benchmark per line
+     */
+    String getReport () const;
+
+    /**
+     *  Returns true if the benchmark was built with AUDEALIZE_COUNT_ALLOCATIONS=1
+     */
+    static bool isCountingAllocations ();
+
+private:
+    int mNumFrames;
+    Array<Result> mResults;
+
+    SharedResourcePointer<UIResources> mResources;  // the look and feel the editors use
+
+    /**
+     *  Paints a component mNumFrames times at its current size and adds the measurements to mResults
+     *
+     *  @param step           Called before each frame with the frame number, e.g. to send mouse events. May be empty
+     *  @param numDescriptors Reported with the result
+     */
+    void measure (Component& component, const String& name, int numDescriptors, std::function<void (int)> step);
+
+    /**
+     *  Returns evenly spaced descriptors from a descriptor set
+     *
+     *  @param descriptors Descriptor set, in either of the forms the WordMap reads
+     *  @param fraction    Fraction of the descriptors to keep
+     */
+    static json selectDescriptors (const json& descriptors, float fraction);
+
+    /**
+     *  Returns the number of descriptors in a descriptor set
+     */
+    static int getNumDescriptors (const json& descriptors);
+
+    JUCE_DECLARE_NON_COPYABLE (PaintBenchmark)
+};
+}
+
+#endif /* PaintBenchmark_h */
@@ -0,0 +1,601 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "EquivalenceChecker.h"
+
+namespace Audealize
+{
+EquivalenceChecker::EquivalenceChecker (int64 seed) : mRandom (seed)
+{
+    // the bands of AudealizeeqAudioProcessor
+    mFreqs = {20,   50,   83,   120,  161,   208,   259,   318,   383,   455,   537,   628,   729,   843,
+              971,  1114, 1273, 1452, 1652,  1875,  2126,  2406,  2719,  3070,  3462,  3901,  4392,  4941,
+              5556, 6244, 7014, 7875, 8839, 9917, 11124, 12474, 13984, 15675, 17566, 19682};
+}
+
+void EquivalenceChecker::runAll (int numTrials)
+{
+    for (int trial = 0; trial < numTrials; trial++)
+    {
+        for (int k = 0; k < kNumKernels; k++)
+        {
+            check ((Kernel) k);
+        }
+    }
+}
+
+EquivalenceChecker::Result EquivalenceChecker::check (Kernel kernel)
+{
+    const Scenario scenario = makeScenario (kernel);
+
+    AudioSampleBuffer reference (scenario.numChannels, numSamples);
+    makeSignal (reference);
+    AudioSampleBuffer output (reference);
+
+    if (isReverbKernel (kernel))
+    {
+        runReverbReference (kernel, scenario, reference);
+        runReverbKernel (kernel, scenario, output);
+    }
+    else
+    {
+        runEqualizerReference (scenario, reference);
+        runEqualizerKernel (kernel, scenario, output);
+    }
+
+    const Tolerance tolerance = getTolerance (kernel);
+
+    Result result;
+    result.kernel = kernel;
+    result.scenario = scenario.description;
+    result.sampleRate = scenario.sampleRate;
+    result.numChannels = scenario.numChannels;
+    result.maxAbsError = 0.0f;
+    result.spectralErrorDb = 0.0f;
+    result.numSubnormals = 0;
+    result.finite = true;
+
+    double signalPower = 0.0, errorPower = 0.0;
+
+    for (int c = 0; c < scenario.numChannels; c++)
+    {
+        const float* ref = reference.getReadPointer (c);
+        const float* out = output.getReadPointer (c);
+
+        for (int n = 0; n < numSamples; n++)
+        {
+            if (!std::isfinite (out[n]))
+            {
+                result.finite = false;
+                continue;
+            }
+
+            const float error = out[n] - ref[n];
+            result.maxAbsError = jmax (result.maxAbsError, std::abs (error));
+            signalPower += (double) ref[n] * ref[n];
+            errorPower += (double) error * error;
+            if (std::fpclassify (out[n]) == FP_SUBNORMAL)
+            {
+                result.numSubnormals++;
+            }
+        }
+
+        if (result.finite)
+        {
+            result.spectralErrorDb = jmax (result.spectralErrorDb,
+                                           getSpectralErrorDb (ref, out, numSamples, tolerance.spectralBandwidth));
+        }
+    }
+
+    result.snrDb = errorPower > 0.0 ? (float) (10.0 * std::log10 (signalPower / errorPower))
+                                    : std::numeric_limits<float>::infinity ();
+
+    result.passed = result.finite && result.maxAbsError <= tolerance.maxAbsError &&
+                    result.spectralErrorDb <= tolerance.maxSpectralErrorDb && result.snrDb >= tolerance.minSnrDb;
+
+    mResults.add (result);
+    return result;
+}
+
+bool EquivalenceChecker::allPassed () const
+{
+    for (const Result& r : mResults)
+    {
+        if (!r.passed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+String EquivalenceChecker::getReport () const
+{
+    String report;
+    report << String ("kernel").paddedRight (' ', 28) << String ("scenario").paddedRight (' ', 10)
+           << String ("rate").paddedLeft (' ', 7) << String ("ch").paddedLeft (' ', 4)
+           << String ("max abs").paddedLeft (' ', 12) << String ("limit").paddedLeft (' ', 10)
+           << String ("spec dB").paddedLeft (' ', 9) << String ("limit").paddedLeft (' ', 7)
+           << String ("SNR dB").paddedLeft (' ', 9) << String ("limit").paddedLeft (' ', 7)
+           << String ("subnorm").paddedLeft (' ', 9) << "  result" << newLine;
+
+    int numFailed = 0;
+    for (const Result& r : mResults)
+    {
+        const Tolerance tolerance = getTolerance (r.kernel);
+
+        report << getKernelName (r.kernel).paddedRight (' ', 28) << r.scenario.paddedRight (' ', 10)
+               << String (roundToInt (r.sampleRate)).paddedLeft (' ', 7) << String (r.numChannels).paddedLeft (' ', 4)
+               << String::formatted ("%12.3g", r.maxAbsError) << String::formatted ("%10.3g", tolerance.maxAbsError)
+               << String (r.spectralErrorDb, 3).paddedLeft (' ', 9)
+               << String (tolerance.maxSpectralErrorDb, 2).paddedLeft (' ', 7)
+               << String::formatted ("%9.1f", r.snrDb) << String::formatted ("%7.1f", tolerance.minSnrDb)
+               << String (r.numSubnormals).paddedLeft (' ', 9)
+               << (r.passed ? "  ok" : (r.finite ? "  FAILED" : "  FAILED (not finite)")) << newLine;
+
+        if (!r.passed)
+        {
+            numFailed++;
+        }
+    }
+
+    report << newLine << mResults.size () - numFailed << " of " << mResults.size () << " checks passed" << newLine;
+    return report;
+}
+
+String EquivalenceChecker::getKernelName (Kernel kernel)
+{
+    switch (kernel)
+    {
+        case kEqualizerFull:
+            return "Equalizer full";
+        case kEqualizerSkipFlatBands:
+            return "Equalizer skip flat bands";
+        case kEqualizerReducedSections:
+            return "Equalizer reduced sections";
+        case kEqualizerBlockStateSpace:
+            return "Equalizer block state space";
+        case kBiquadCascade:
+            return "BiquadCascade";
+        case kChunkParallelRender:
+            return "Chunk-parallel render";
+        case kLaneEqualizer:
+            return "LaneEqualizer";
+        case kReverbFullRate:
+            return "Reverb full rate";
+        case kReverbHalfRate:
+            return "Reverb half rate";
+        case kReverbHalfRateThreeCombs:
+            return "Reverb half rate, 3 combs";
+        case kLaneReverb:
+            return "LaneReverb";
+        case kReverbFloat16Lines:
+            return "Reverb float16 lines";
+        case kReverbBFloat16Lines:
+            return "Reverb bfloat16 lines";
+        case kReverbInt16Lines:
+            return "Reverb int16 lines";
+        default:
+            return "unknown";
+    }
+}
+
+EquivalenceChecker::Tolerance EquivalenceChecker::getTolerance (Kernel kernel)
+{
+    // about twice the largest errors (6 dB below the lowest SNR) seen over a few hundred random scenarios
+    static const Tolerance tolerances[kNumKernels] = {
+        {0.02f, 0.1f, 1.0f, 0.0f},       // kEqualizerFull: bands fade in and out as they leave and return to 0 dB
+        {0.03f, 0.15f, 1.0f, 0.0f},      // kEqualizerSkipFlatBands: also drops bands within 0.05 dB
+        {3.0f, 9.0f, 1.0f, 0.0f},        // kEqualizerReducedSections: a fitted approximation of the curve
+        {0.02f, 0.1f, 1.0f, 0.0f},       // kEqualizerBlockStateSpace: as kEqualizerFull
+        {0.02f, 0.1f, 1.0f, 0.0f},       // kBiquadCascade: runs the Equalizer's sections, so flat bands are dropped
+        {0.02f, 0.1f, 1.0f, 0.0f},       // kChunkParallelRender: as kBiquadCascade
+        {5.0e-4f, 0.02f, 1.0f, 0.0f},    // kLaneEqualizer: most sections in single precision
+        {1.0e-6f, 0.01f, 1.0f, 0.0f},    // kReverbFullRate: same arithmetic as the original
+        {1.0f, 5.0f, 0.5f, 0.0f},        // kReverbHalfRate: delays rounded at half rate, no output above a quarter of the rate
+        {1.0f, 9.0f, 0.5f, 0.0f},        // kReverbHalfRateThreeCombs: fewer, louder combs
+        {1.0e-3f, 0.2f, 1.0f, 0.0f},     // kLaneReverb: lowpass in single precision
+        {7.0e-4f, 0.015f, 1.0f, 58.0f},  // kReverbFloat16Lines: 11 bit mantissa in the delay lines
+        {3.0e-3f, 0.025f, 1.0f, 47.0f},  // kReverbBFloat16Lines: 8 bit mantissa
+        {7.0e-4f, 0.015f, 1.0f, 56.0f}   // kReverbInt16Lines: fixed steps of 16 / 32767
+    };
+
+    return tolerances[jlimit (0, kNumKernels - 1, (int) kernel)];
+}
+
+bool EquivalenceChecker::isReverbKernel (Kernel kernel) const
+{
+    return kernel >= kReverbFullRate;
+}
+
+EquivalenceChecker::Scenario EquivalenceChecker::makeScenario (Kernel kernel)
+{
+    static const double sampleRates[] = {44100.0, 48000.0, 88200.0, 96000.0};
+
+    Scenario s;
+    s.sampleRate = sampleRates[mRandom.nextInt (4)];
+
+    // the kernels that copy a fixed setting can't follow automation
+    s.ramp = kernel != kBiquadCascade && kernel != kChunkParallelRender && kernel != kLaneEqualizer &&
+             kernel != kLaneReverb;
+
+    if (isReverbKernel (kernel))
+    {
+        s.numChannels = 1 + mRandom.nextInt (2);
+
+        // the ranges of the reverb processor's parameters
+        s.d = 0.01f + 0.09f * mRandom.nextFloat ();
+        s.m = -0.012f + 0.024f * mRandom.nextFloat ();
+        for (float* params : {s.startParams, s.endParams})
+        {
+            params[0] = 0.01f + 0.95f * mRandom.nextFloat ();
+            params[1] = 20.0f * std::pow (1000.0f, mRandom.nextFloat ());
+            params[2] = mRandom.nextFloat ();
+            params[3] = mRandom.nextFloat ();
+        }
+        if (!s.ramp)
+        {
+            std::copy (s.startParams, s.startParams + 4, s.endParams);
+        }
+    }
+    else
+    {
+        const int layout = mRandom.nextInt (3);
+        s.numChannels = layout == 0 ? 1 : (layout == 1 ? 2 : 3 + mRandom.nextInt (6));
+
+        // about a third of the bands are left flat, so there are sections to skip
+        for (vector<float>* gains : {&s.startGains, &s.endGains})
+        {
+            gains->resize (mFreqs.size ());
+            for (float& gain : *gains)
+            {
+                gain = mRandom.nextInt (3) == 0 ? 0.0f : -8.0f + 16.0f * mRandom.nextFloat ();
+            }
+        }
+        if (!s.ramp)
+        {
+            s.endGains = s.startGains;
+        }
+    }
+
+    s.description = s.ramp ? "ramp" : "static";
+    return s;
+}
+
+void EquivalenceChecker::makeSignal (AudioSampleBuffer& buffer)
+{
+    // noise burst, silence, subnormal noise, silence
+    const int burstEnd = numSamples / 2;
+    const int subnormalStart = burstEnd + numSamples / 8;
+    const int subnormalEnd = subnormalStart + numSamples / 4;
+
+    buffer.clear ();
+    for (int c = 0; c < buffer.getNumChannels (); c++)
+    {
+        float* data = buffer.getWritePointer (c);
+        for (int n = 0; n < burstEnd; n++)
+        {
+            data[n] = 0.5f * (mRandom.nextFloat () * 2.0f - 1.0f);
+        }
+        for (int n = subnormalStart; n < subnormalEnd; n++)
+        {
+            data[n] = 1.0e-39f * (mRandom.nextFloat () * 2.0f - 1.0f);
+        }
+    }
+}
+
+float EquivalenceChecker::getRampPosition (const Scenario& scenario, int blockIdx)
+{
+    const int rampBlocks = numSamples / blockSize / 2;
+    return scenario.ramp ? jmin (1.0f, (float) blockIdx / rampBlocks) : 0.0f;
+}
+
+void EquivalenceChecker::runEqualizerReference (const Scenario& scenario, AudioSampleBuffer& buffer)
+{
+    ReferenceEqualizer eq (mFreqs, scenario.sampleRate, scenario.numChannels);
+    vector<float> gains (mFreqs.size ());
+
+    for (int b = 0; b * blockSize < numSamples; b++)
+    {
+        const float pos = getRampPosition (scenario, b);
+        for (int i = 0; i < gains.size (); i++)
+        {
+            gains[i] = scenario.startGains[i] + (scenario.endGains[i] - scenario.startGains[i]) * pos;
+        }
+        eq.setGains (gains);
+
+        for (int c = 0; c < scenario.numChannels; c++)
+        {
+            eq.process (buffer.getWritePointer (c, b * blockSize), blockSize, c);
+        }
+    }
+}
+
+void EquivalenceChecker::runEqualizerKernel (Kernel kernel, const Scenario& scenario, AudioSampleBuffer& buffer)
+{
+    Equalizer eq (mFreqs, scenario.sampleRate);
+    eq.setNumChannels (scenario.numChannels);
+    eq.setGains (scenario.startGains);
+
+    if (kernel == kEqualizerFull || kernel == kEqualizerSkipFlatBands || kernel == kEqualizerReducedSections ||
+        kernel == kEqualizerBlockStateSpace)
+    {
+        eq.setKernel (kernel == kEqualizerBlockStateSpace ? Equalizer::kKernelBlockStateSpace
+                                                          : Equalizer::kKernelPerSample);
+        eq.setQuality (kernel == kEqualizerSkipFlatBands ? Equalizer::kQualitySkipFlatBands
+                                                         : (kernel == kEqualizerReducedSections
+                                                                ? Equalizer::kQualityReducedSections
+                                                                : Equalizer::kQualityFull));
+
+        vector<float> gains (mFreqs.size ());
+        for (int b = 0; b * blockSize < numSamples; b++)
+        {
+            const float pos = getRampPosition (scenario, b);
+            for (int i = 0; i < gains.size (); i++)
+            {
+                gains[i] = scenario.startGains[i] + (scenario.endGains[i] - scenario.startGains[i]) * pos;
+            }
+            eq.setGains (gains);
+
+            for (int c = 0; c < scenario.numChannels; c++)
+            {
+                eq.processBlock (buffer.getWritePointer (c, b * blockSize), blockSize, c);
+            }
+        }
+    }
+    else if (kernel == kBiquadCascade)
+    {
+        for (int c = 0; c < scenario.numChannels; c++)
+        {
+            BiquadCascade cascade;
+            cascade.loadFrom (eq, c);
+            cascade.reset ();
+            cascade.process (buffer.getWritePointer (c), numSamples);
+        }
+    }
+    else if (kernel == kChunkParallelRender)
+    {
+        OfflineRenderer renderer (4);
+        renderer.setMinimumChunkSize (numSamples / 8);
+        renderer.renderEqualizer (eq, buffer, OfflineRenderer::kRenderChunkParallel);
+    }
+    else if (kernel == kLaneEqualizer)
+    {
+        const int numLanes = LaneEqualizer::numLanes;
+        LaneEqualizer lanes;
+        HeapBlock<float> block (numSamples * numLanes);
+
+        // the channels are run in groups of numLanes, one channel per lane
+        for (int first = 0; first < scenario.numChannels; first += numLanes)
+        {
+            lanes.setCoefficients (eq);
+            block.clear (numSamples * numLanes);
+
+            const int numInGroup = jmin (numLanes, scenario.numChannels - first);
+            for (int l = 0; l < numInGroup; l++)
+            {
+                const float* data = buffer.getReadPointer (first + l);
+                for (int n = 0; n < numSamples; n++)
+                {
+                    block[n * numLanes + l] = data[n];
+                }
+            }
+
+            lanes.process (block, numSamples);
+
+            for (int l = 0; l < numInGroup; l++)
+            {
+                float* data = buffer.getWritePointer (first + l);
+                for (int n = 0; n < numSamples; n++)
+                {
+                    data[n] = block[n * numLanes + l];
+                }
+            }
+        }
+    }
+}
+
+void EquivalenceChecker::runReverbReference (Kernel kernel, const Scenario& scenario, AudioSampleBuffer& buffer)
+{
+    // LaneReverb only has the mono path: each channel is compared with a separate mono reverb
+    const bool mono = scenario.numChannels == 1 || kernel == kLaneReverb;
+    OwnedArray<ReferenceReverb> reverbs;
+    for (int c = 0; c < (mono ? scenario.numChannels : 1); c++)
+    {
+        ReferenceReverb* reverb = reverbs.add (new ReferenceReverb ());
+        reverb->init (scenario.d, scenario.startParams[0], scenario.m, scenario.startParams[1], scenario.startParams[2],
+                      scenario.startParams[3], scenario.sampleRate);
+    }
+
+    for (int b = 0; b * blockSize < numSamples; b++)
+    {
+        const float pos = getRampPosition (scenario, b);
+        for (ReferenceReverb* reverb : reverbs)
+        {
+            reverb->set_g (scenario.startParams[0] + (scenario.endParams[0] - scenario.startParams[0]) * pos);
+            reverb->set_f (scenario.startParams[1] + (scenario.endParams[1] - scenario.startParams[1]) * pos);
+            reverb->set_E (scenario.startParams[2] + (scenario.endParams[2] - scenario.startParams[2]) * pos);
+            reverb->set_wetdry (scenario.startParams[3] + (scenario.endParams[3] - scenario.startParams[3]) * pos);
+        }
+
+        if (mono)
+        {
+            for (int c = 0; c < scenario.numChannels; c++)
+            {
+                reverbs[c]->processMonoBlock (buffer.getWritePointer (c, b * blockSize), blockSize);
+            }
+        }
+        else
+        {
+            reverbs[0]->processStereoBlock (buffer.getWritePointer (0, b * blockSize),
+                                            buffer.getWritePointer (1, b * blockSize), blockSize);
+        }
+    }
+}
+
+void EquivalenceChecker::runReverbKernel (Kernel kernel, const Scenario& scenario, AudioSampleBuffer& buffer)
+{
+    Reverb reverb;
+    reverb.init (scenario.d, scenario.startParams[0], scenario.m, scenario.startParams[1], scenario.startParams[2],
+                 scenario.startParams[3], scenario.sampleRate);
+
+    if (kernel == kLaneReverb)
+    {
+        const int numLanes = LaneReverb::numLanes;
+        ScopedPointer<LaneReverb> lanes (new LaneReverb ());
+        HeapBlock<float> block (numSamples * numLanes, true);
+
+        lanes->setCoefficients (reverb);
+        for (int c = 0; c < scenario.numChannels; c++)
+        {
+            const float* data = buffer.getReadPointer (c);
+            for (int n = 0; n < numSamples; n++)
+            {
+                block[n * numLanes + c] = data[n];
+            }
+        }
+
+        lanes->process (block, numSamples);
+
+        for (int c = 0; c < scenario.numChannels; c++)
+        {
+            float* data = buffer.getWritePointer (c);
+            for (int n = 0; n < numSamples; n++)
+            {
+                data[n] = block[n * numLanes + c];
+            }
+        }
+        return;
+    }
+
+    reverb.setQuality (kernel == kReverbHalfRate || kernel == kReverbHalfRateThreeCombs,
+                       kernel == kReverbHalfRateThreeCombs ? 3 : 6);
+
+    if (kernel == kReverbFloat16Lines || kernel == kReverbBFloat16Lines || kernel == kReverbInt16Lines)
+    {
+        reverb.setLineFormat (kernel == kReverbFloat16Lines
+                                  ? DelayLine::kFormatFloat16
+                                  : (kernel == kReverbBFloat16Lines ? DelayLine::kFormatBFloat16
+                                                                    : DelayLine::kFormatInt16));
+    }
+
+    for (int b = 0; b * blockSize < numSamples; b++)
+    {
+        const float pos = getRampPosition (scenario, b);
+        reverb.set_g (scenario.startParams[0] + (scenario.endParams[0] - scenario.startParams[0]) * pos);
+        reverb.set_f (scenario.startParams[1] + (scenario.endParams[1] - scenario.startParams[1]) * pos);
+        reverb.set_E (scenario.startParams[2] + (scenario.endParams[2] - scenario.startParams[2]) * pos);
+        reverb.set_wetdry (scenario.startParams[3] + (scenario.endParams[3] - scenario.startParams[3]) * pos);
+
+        if (scenario.numChannels == 1)
+        {
+            reverb.processMonoBlock (buffer.getWritePointer (0, b * blockSize), blockSize);
+        }
+        else
+        {
+            reverb.processStereoBlock (buffer.getWritePointer (0, b * blockSize),
+                                       buffer.getWritePointer (1, b * blockSize), blockSize);
+        }
+    }
+}
+
+float EquivalenceChecker::getSpectralErrorDb (const float* reference, const float* output, int length,
+                                              float bandwidth)
+{
+    const int fftOrder = 11;
+    const int fftSize = 1 << fftOrder;
+    const int numBins = fftSize / 2 + 1;
+
+    FFT fft (fftOrder, false);
+    HeapBlock<float> window (fftSize), frame (fftSize * 2);
+    vector<double> refPower (numBins, 0.0), outPower (numBins, 0.0);
+
+    for (int i = 0; i < fftSize; i++)
+    {
+        window[i] = 0.5f - 0.5f * std::cos (2.0f * float_Pi * i / fftSize);
+    }
+
+    // averaged, Hann windowed power spectra with 50% overlap
+    for (int start = 0; start + fftSize <= length; start += fftSize / 2)
+    {
+        for (int pass = 0; pass < 2; pass++)
+        {
+            const float* signal = (pass == 0 ? reference : output) + start;
+            vector<double>& power = pass == 0 ? refPower : outPower;
+
+            frame.clear (fftSize * 2);
+            for (int i = 0; i < fftSize; i++)
+            {
+                frame[i] = signal[i] * window[i];
+            }
+            fft.performFrequencyOnlyForwardTransform (frame);
+
+            for (int k = 0; k < numBins; k++)
+            {
+                power[k] += (double) frame[k] * frame[k];
+            }
+        }
+    }
+
+    // sum the bins into sixth octave bands (at least one bin each) from bin 1 up, so the comparison isn't thrown by
+    // the fine comb structure of the reverb, whose teeth move when the delays are rounded at a different rate
+    const int lastBin = jlimit (2, numBins, roundToInt (numBins * bandwidth));
+    vector<double> refBands, outBands;
+    for (int lo = 1; lo < lastBin;)
+    {
+        const int hi = jmin (lastBin, jmax (lo + 1, roundToInt (lo * std::pow (2.0, 1.0 / 6.0))));
+        double refSum = 0.0, outSum = 0.0;
+        for (; lo < hi; lo++)
+        {
+            refSum += refPower[lo];
+            outSum += outPower[lo];
+        }
+        refBands.push_back (refSum);
+        outBands.push_back (outSum);
+    }
+
+    const double peak = *std::max_element (refBands.begin (), refBands.end ());
+    if (peak <= 0.0)
+    {
+        return 0.0f;
+    }
+
+    // bands more than 60 dB below the peak are dominated by rounding noise
+    const double floor = peak * 1.0e-6, offset = peak * 1.0e-9;
+
+    float maxError = 0.0f;
+    for (int i = 0; i < refBands.size (); i++)
+    {
+        if (refBands[i] < floor)
+        {
+            continue;
+        }
+
+        const float error = std::abs (10.0 * std::log10 ((outBands[i] + offset) / (refBands[i] + offset)));
+        maxError = jmax (maxError, error);
+    }
+
+    return maxError;
+}
+
+}  // namespace Audealize
@@ -0,0 +1,195 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef EquivalenceChecker_h
+#define EquivalenceChecker_h
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <audealize_module/audealize_dsp.h>
+#include <audealize_module/offline/OfflineRenderer.h>
+#include "ReferenceEffects.h"
+
+using std::vector;
+
+namespace Audealize
+{
+/// Runs every optimised DSP kernel side by side with the frozen scalar effects in ReferenceEffects.h and checks that
+/// their outputs agree. Each trial draws a random scenario: sample rate, channel layout, band gains or reverb
+/// parameters ramped block by block, and a test signal made of a noise burst, silence, a burst of subnormal noise and
+/// more silence, so the filters' tails decay into the denormal range.
+///
+/// Outputs are compared by their largest sample difference, by their signal to error ratio and by the largest
+/// difference of their long-term spectra, in dB, over the sixth octave bands within 60 dB of the reference's peak.
+/// Each kernel has its own tolerances: the exact rewrites must match to within float rounding, the compact delay line
+/// formats must keep the rounding noise they add below a given SNR, while the reduced quality settings only have to
+/// keep the spectrum close. Non-finite output always fails. Subnormal output samples are counted but don't fail a check: the lane
+/// kernels don't undenormalise their output the way the scalar effects do.
+///
+/// Everything runs on the calling thread, except the chunk-parallel render which uses its own thread pool. The
+/// AudealizeTests project runs the checker from the command line and fails if any check does.
+class EquivalenceChecker
+{
+public:
+    enum Kernel
+    {
+        kEqualizerFull = 0,          // Equalizer::processBlock, kQualityFull
+        kEqualizerSkipFlatBands,     // Equalizer::processBlock, kQualitySkipFlatBands
+        kEqualizerReducedSections,   // Equalizer::processBlock, kQualityReducedSections
+        kEqualizerBlockStateSpace,   // Equalizer::processBlock, kQualityFull with kKernelBlockStateSpace
+        kBiquadCascade,              // BiquadCascade::process
+        kChunkParallelRender,        // OfflineRenderer::renderEqualizer, kRenderChunkParallel
+        kLaneEqualizer,              // LaneEqualizer::process
+        kReverbFullRate,             // Reverb, full rate with six combs
+        kReverbHalfRate,             // Reverb, half rate with six combs
+        kReverbHalfRateThreeCombs,   // Reverb, half rate with three combs
+        kLaneReverb,                 // LaneReverb::process
+        kReverbFloat16Lines,         // Reverb, full rate with six combs, kFormatFloat16 delay lines
+        kReverbBFloat16Lines,        // Reverb, full rate with six combs, kFormatBFloat16 delay lines
+        kReverbInt16Lines,           // Reverb, full rate with six combs, kFormatInt16 delay lines
+        kNumKernels
+    };
+
+    /// How far a kernel's output may be from the reference's
+    struct Tolerance
+    {
+        float maxAbsError;         // largest sample difference
+        float maxSpectralErrorDb;  // largest difference of the long-term spectra in dB
+        float spectralBandwidth;   // fraction of the band up to Nyquist over which the spectra are compared
+        float minSnrDb;            // smallest signal to error ratio in dB, 0 for none
+    };
+
+    /// The outcome of one kernel in one scenario
+    struct Result
+    {
+        Kernel kernel;
+        String scenario;
+        double sampleRate;
+        int numChannels;
+        float maxAbsError;
+        float spectralErrorDb;
+        float snrDb;        // power of the reference over power of the difference, across all channels
+        int numSubnormals;  // subnormal samples in the kernel's output
+        bool finite;        // false if the output contained a NaN or infinity
+        bool passed;
+    };
+
+    /**
+     *  Constructor
+     *
+     *  @param seed Seed of the random scenarios, so failures can be reproduced
+     */
+    EquivalenceChecker (int64 seed = 1);
+
+    /**
+     *  Checks every kernel in a number of random scenarios. Results are added to getResults ()
+     *
+     *  @param numTrials Number of scenarios per kernel
+     */
+    void runAll (int numTrials = 8);
+
+    /**
+     *  Checks one kernel in a new random scenario, adds the result to getResults () and returns it
+     */
+    Result check (Kernel kernel);
+
+    /**
+     *  Returns the results of every check run so far
+     */
+    const Array<Result>& getResults () const
+    {
+        return mResults;
+    }
+
+    /**
+     *  Returns true if every check run so far passed
+     */
+    bool allPassed () const;
+
+    /**
+     *  Returns the results as a table, one check per line, followed by the number of failures
+     */
+    String getReport () const;
+
+    /**
+     *  Returns the name a kernel is reported under
+     */
+    static String getKernelName (Kernel kernel);
+
+    /**
+     *  Returns the tolerances a kernel is checked against
+     */
+    static Tolerance getTolerance (Kernel kernel);
+
+private:
+    static const int blockSize = 256;   // parameters are changed between blocks of this size
+    static const int numSamples = 32768;
+
+    /// The settings of one trial. Gains and reverb parameters ramp from their start to their end values over the first
+    /// half of the signal, one step per block, and stay at the end values after that
+    struct Scenario
+    {
+        double sampleRate;
+        int numChannels;
+        bool ramp;
+        vector<float> startGains, endGains;  // equalizer band gains in dB
+        float d, m;                          // reverb parameters that are not ramped
+        float startParams[4], endParams[4];  // reverb g, f, E and wetdry
+        String description;
+    };
+
+    Random mRandom;
+    Array<Result> mResults;
+    vector<float> mFreqs;  // band frequencies of the equalizer
+
+    bool isReverbKernel (Kernel kernel) const;
+
+    Scenario makeScenario (Kernel kernel);
+
+    /**
+     *  Fills a buffer with the test signal, independent noise in every channel
+     */
+    void makeSignal (AudioSampleBuffer& buffer);
+
+    /**
+     *  Returns how far through the ramp a block is [0, 1]
+     */
+    static float getRampPosition (const Scenario& scenario, int blockIdx);
+
+    void runEqualizerReference (const Scenario& scenario, AudioSampleBuffer& buffer);
+    void runEqualizerKernel (Kernel kernel, const Scenario& scenario, AudioSampleBuffer& buffer);
+    void runReverbReference (Kernel kernel, const Scenario& scenario, AudioSampleBuffer& buffer);
+    void runReverbKernel (Kernel kernel, const Scenario& scenario, AudioSampleBuffer& buffer);
+
+    /**
+     *  Returns the largest difference in dB between the long-term power spectra of two signals
+     *
+     *  @param bandwidth Fraction of the band up to Nyquist over which the spectra are compared
+     */
+    static float getSpectralErrorDb (const float* reference, const float* output, int length, float bandwidth);
+
+    JUCE_DECLARE_NON_COPYABLE (EquivalenceChecker)
+};
+
+}  // namespace Audealize
+
+#endif /* EquivalenceChecker_h */
@@ -0,0 +1,85 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "EquivalenceChecker.h"
+
+using namespace Audealize;
+
+static void printUsage ()
+{
+    fputs ("Usage: AudealizeTests [options]\n"
+           "\n"
+           "Runs every optimised DSP kernel next to the frozen reference effects and prints how far their outputs\n"
+           "differ. Exits with 1 if any kernel is outside its tolerances.\n"
+           "\n"
+           "  --seed <n>    Seed of the random scenarios (default 1)\n"
+           "  --trials <n>  Scenarios run per kernel (default 8)\n",
+           stderr);
+}
+
+int main (int argc, char* argv[])
+{
+    int64 seed = 1;
+    int numTrials = 8;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const String arg (argv[i]);
+        const String value (i + 1 < argc ? argv[i + 1] : "");
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage ();
+            return 0;
+        }
+        if (!arg.startsWith ("--") || i + 1 >= argc)
+        {
+            printUsage ();
+            return 1;
+        }
+        i++;
+
+        if (arg == "--seed")
+            seed = value.getLargeIntValue ();
+        else if (arg == "--trials")
+            numTrials = value.getIntValue ();
+        else
+        {
+            printUsage ();
+            return 1;
+        }
+    }
+
+    if (numTrials < 1)
+    {
+        printUsage ();
+        return 1;
+    }
+
+    EquivalenceChecker checker (seed);
+    checker.runAll (numTrials);
+
+    fputs (checker.getReport ().toRawUTF8 (), stdout);
+    return checker.allPassed () ? 0 : 1;
+}
@@ -0,0 +1,393 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+    Frozen copies of the scalar Biquad, NChannelFilter, Equalizer and Reverb as they were before any of the
+    optimised processing paths were added. The EquivalenceChecker measures every optimised kernel against these.
+
+    Don't change the processing in this file: it is the definition of correct output. The only differences from the
+    original code are that the channel loops are folded into the classes, the reverb's buffers are actually cleared by
+    resetBuffs (the original iterated over copies), and every parameter is initialised.
+*/
+
+#ifndef ReferenceEffects_h
+#define ReferenceEffects_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// The original double precision biquad. Only the peaking and lowpass types are used by the effects
+class ReferenceBiquad
+{
+public:
+    enum type
+    {
+        kLowpass = 0,
+        kPeak
+    };
+
+    ReferenceBiquad () : mType (kPeak), a0 (1.0), a1 (0.0), a2 (0.0), b1 (0.0), b2 (0.0), z1 (0.0), z2 (0.0)
+    {
+    }
+
+    /**
+     *  Sets the type, center frequency, Q and gain of the filter
+     *
+     *  @param type       @see ReferenceBiquad::type
+     *  @param Fc         Center frequency, normalised to the sample rate
+     *  @param Q          Q value
+     *  @param peakGainDB Peak gain in dB. Ignored by the lowpass
+     */
+    void setBiquad (int type, double Fc, double Q, double peakGainDB)
+    {
+        mType = type;
+
+        double norm;
+        double V = pow (10, fabs (peakGainDB) / 20.0);
+        double K = tan (M_PI * Fc);
+
+        if (type == kLowpass)
+        {
+            norm = 1 / (1 + K / Q + K * K);
+            a0 = K * K * norm;
+            a1 = 2 * a0;
+            a2 = a0;
+            b1 = 2 * (K * K - 1) * norm;
+            b2 = (1 - K / Q + K * K) * norm;
+        }
+        else if (peakGainDB >= 0)  // boost
+        {
+            norm = 1 / (1 + 1 / Q * K + K * K);
+            a0 = (1 + V / Q * K + K * K) * norm;
+            a1 = 2 * (K * K - 1) * norm;
+            a2 = (1 - V / Q * K + K * K) * norm;
+            b1 = a1;
+            b2 = (1 - 1 / Q * K + K * K) * norm;
+        }
+        else  // cut
+        {
+            norm = 1 / (1 + V / Q * K + K * K);
+            a0 = (1 + 1 / Q * K + K * K) * norm;
+            a1 = 2 * (K * K - 1) * norm;
+            a2 = (1 - 1 / Q * K + K * K) * norm;
+            b1 = a1;
+            b2 = (1 - V / Q * K + K * K) * norm;
+        }
+    }
+
+    /**
+     *  Filters one sample, undenormalising the output as NChannelFilter did
+     */
+    inline float process (float in)
+    {
+        double out = in * a0 + z1;
+        z1 = in * a1 + z2 - b1 * out;
+        z2 = in * a2 - b2 * out;
+
+        float result = out;
+        JUCE_UNDENORMALISE (result);
+        return result;
+    }
+
+    void reset ()
+    {
+        z1 = z2 = 0.0;
+    }
+
+private:
+    int mType;
+    double a0, a1, a2, b1, b2;
+    double z1, z2;
+};
+
+/// The original N-band graphic equalizer: every band is run, whatever its gain
+class ReferenceEqualizer
+{
+public:
+    /**
+     *  Constructor
+     *
+     *  @param freqs       Band center frequencies in Hz
+     *  @param sampleRate  Sample rate
+     *  @param numChannels Number of channels
+     *  @param Q           Q value of every band
+     */
+    ReferenceEqualizer (const vector<float>& freqs, float sampleRate, int numChannels, float Q = 4.31f)
+        : mFreqs (freqs), mGains (freqs.size (), 0.0f), mSampleRate (sampleRate), mQ (Q), mChannels (numChannels),
+          mFilters (freqs.size () * numChannels)
+    {
+        setGains (mGains);
+    }
+
+    /**
+     *  Sets the gains of the bands in dB
+     */
+    void setGains (const vector<float>& gains)
+    {
+        for (int i = 0; i < mFreqs.size (); i++)
+        {
+            setBandGain (i, gains[i]);
+        }
+    }
+
+    /**
+     *  Sets the gain of one band in dB
+     */
+    void setBandGain (int bandIdx, float gainDB)
+    {
+        mGains[bandIdx] = gainDB;
+        for (int c = 0; c < mChannels; c++)
+        {
+            // the normalised frequency was computed in single precision
+            mFilters[bandIdx * mChannels + c].setBiquad (ReferenceBiquad::kPeak, mFreqs[bandIdx] / mSampleRate, mQ,
+                                                         gainDB);
+        }
+    }
+
+    /**
+     *  Filters a block of one channel in place
+     */
+    void process (float* samples, int numSamples, int channelIdx)
+    {
+        for (int n = 0; n < numSamples; n++)
+        {
+            float in = samples[n];
+            for (int i = 0; i < mFreqs.size (); i++)
+            {
+                in = mFilters[i * mChannels + channelIdx].process (in);
+            }
+            samples[n] = in;
+        }
+    }
+
+private:
+    vector<float> mFreqs, mGains;
+    float mSampleRate, mQ;
+    int mChannels;
+    vector<ReferenceBiquad> mFilters;  // [band][channel]
+};
+
+/// The original parametric reverberator, always run at the full sample rate with all six combs
+class ReferenceReverb
+{
+public:
+    ReferenceReverb () : mComb (6), mAllpass (2), mDelay (2)
+    {
+        d = 0.05f;
+        g = 0.5f;
+        m = 0.0f;
+        f = 5000.0f;
+        E = 0.5f;
+        wetdry = 0.5f;
+        da = 0.006f + MINDELAY;
+        mSampleRate = 44100.0f;
+    }
+
+    /**
+     *  Set all parameters at once and clears the buffers
+     */
+    void init (float d_val, float g_val, float m_val, float f_val, float E_val, float wetdry_val, float sampleRate)
+    {
+        mSampleRate = sampleRate;
+        set_d (d_val);
+        set_g (g_val);
+        set_m (m_val);
+        set_f (f_val);
+        set_E (E_val);
+        set_wetdry (wetdry_val);
+        resetBuffs ();
+    }
+
+    void processMonoBlock (float* channelData, int blockSize)
+    {
+        float samp, sampRev, sampDry, sampOut;
+
+        for (int i = 0; i < blockSize; i++)
+        {
+            sampDry = channelData[i];
+
+            sampRev = processCombs (sampDry * wet);
+            sampRev = mAllpass[0].process_allpass_comb (sampRev, mDelayVal[0] * mSampleRate, ALLPASSGAIN);
+            sampRev = mLowpass[0].process (sampRev);
+            sampRev *= gain;
+
+            samp = wet * mDelay[0].process (sampDry, MINDELAY * mSampleRate);
+            samp *= gainclean;
+            samp = (samp + sampRev) * .5f;
+            samp *= gainscale;
+
+            sampDry *= dry;
+
+            sampOut = samp + sampDry;
+            JUCE_UNDENORMALISE (sampOut);
+            channelData[i] = sampOut;
+        }
+    }
+
+    void processStereoBlock (float* channelData1, float* channelData2, int blockSize)
+    {
+        float sampL, sampR, sampRevL, sampRevR, sampDryL, sampDryR, sampSum, sampOutL, sampOutR;
+
+        for (int i = 0; i < blockSize; i++)
+        {
+            sampDryL = channelData1[i];
+            sampDryR = channelData2[i];
+
+            sampSum = sampDryL + sampDryR;
+            sampSum *= 0.5f;
+            sampSum *= wet;
+            sampRevL = sampRevR = processCombs (sampSum);
+
+            sampRevL = mAllpass[0].process_allpass_comb (sampRevL, mDelayVal[0] * mSampleRate, ALLPASSGAIN);
+            sampRevR = mAllpass[1].process_allpass_comb (sampRevR, mDelayVal[1] * mSampleRate, ALLPASSGAIN);
+
+            sampRevL = mLowpass[0].process (sampRevL);
+            sampRevR = mLowpass[1].process (sampRevR);
+
+            sampRevL *= gain;
+            sampRevR *= gain;
+
+            sampL = wet * mDelay[0].process (sampDryL, MINDELAY * mSampleRate);
+            sampR = wet * mDelay[1].process (sampDryR, MINDELAY * mSampleRate);
+
+            sampL *= gainclean;
+            sampR *= gainclean;
+
+            sampL = (sampL + sampRevL) * .5f;
+            sampR = (sampR + sampRevR) * .5f;
+
+            sampL *= gainscale;
+            sampR *= gainscale;
+
+            sampDryL *= dry;
+            sampDryR *= dry;
+
+            sampOutL = sampDryL + sampL;
+            sampOutR = sampDryR + sampR;
+
+            JUCE_UNDENORMALISE (sampOutL);
+            JUCE_UNDENORMALISE (sampOutR);
+            channelData1[i] = sampOutL;
+            channelData2[i] = sampOutR;
+        }
+    }
+
+    void resetBuffs ()
+    {
+        for (auto& line : mAllpass)
+        {
+            line.reset ();
+        }
+        for (auto& line : mComb)
+        {
+            line.reset ();
+        }
+        for (auto& line : mDelay)
+        {
+            line.reset ();
+        }
+        mLowpass[0].reset ();
+        mLowpass[1].reset ();
+    }
+
+    void set_d (float d_val)
+    {
+        d = d_val;
+        calc_rt ();
+        for (int i = 0; i < 6; i++)
+        {
+            mCombDelay[i] = prevPrime (d * (15 - i) / 15.0f * mSampleRate) / mSampleRate;
+            mCombGain[i] = powf (.001, mCombDelay[i] / rt);
+        }
+    }
+
+    void set_g (float g_val)
+    {
+        g = g_val;
+        set_d (d);
+    }
+
+    void set_m (float m_val)
+    {
+        m = m_val;
+        mDelayVal[0] = prevPrime ((da + m / 2) * mSampleRate) / mSampleRate;
+        mDelayVal[1] = prevPrime ((da - m / 2) * mSampleRate) / mSampleRate;
+    }
+
+    void set_f (float f_val)
+    {
+        f = f_val;
+        for (int c = 0; c < 2; c++)
+        {
+            mLowpass[c].setBiquad (ReferenceBiquad::kLowpass, f / mSampleRate, 1.0f, 0.0f);
+        }
+    }
+
+    void set_E (float E_val)
+    {
+        float totalGain, g1;
+        E = E_val;
+
+        totalGain = E + 1;
+        g1 = 1 / totalGain;
+        gainclean = cos ((1 - g1) * .125f * PI);
+        gain = cos (g1 * .375 * PI);
+        gainscale = .5 * .8 / (gainclean + gain);
+    }
+
+    void set_wetdry (float wetdry_val)
+    {
+        wetdry = wetdry_val;
+        wet = cos ((1 - wetdry) * .5 * PI);
+        dry = cos (wetdry * .5 * PI);
+    }
+
+private:
+    float d, g, m, f, E, wetdry;
+    float rt, gainclean, gainscale, gain, wet, dry, da;
+    float mSampleRate;
+    float mCombDelay[6], mCombGain[6], mDelayVal[2];
+
+    vector<simple_delay<9600, float>> mComb, mAllpass, mDelay;
+    ReferenceBiquad mLowpass[2];
+
+    float processCombs (float sample)
+    {
+        float outSample = 0;
+        for (int i = 0; i < mComb.size (); i++)
+        {
+            outSample += mComb[i].process_comb (sample, mCombDelay[i] * mSampleRate, mCombGain[i]);
+        }
+        return outSample;
+    }
+
+    inline void calc_rt ()
+    {
+        rt = d * log (.001) / log (g);
+    }
+};
+
+}  // namespace Audealize
+
+#endif /* ReferenceEffects_h */
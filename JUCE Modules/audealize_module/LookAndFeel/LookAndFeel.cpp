@@ -351,17 +351,24 @@ void AudealizeLookAndFeel::drawTickBox (Graphics& g, Component& component, float
 
     if (ticked)
     {
-        Path tick;
-        tick.startNewSubPath (1.5f, 3.0f);
-        tick.lineTo (3.0f, 6.0f);
-        tick.lineTo (6.0f, 0.0f);
+        // the stroked tick only depends on the box size, so it's rebuilt when that changes
+        if (w != mTickWidth || h != mTickHeight)
+        {
+            Path tick;
+            tick.startNewSubPath (1.5f, 3.0f);
+            tick.lineTo (3.0f, 6.0f);
+            tick.lineTo (6.0f, 0.0f);
+
+            mTick.clear ();
+            PathStrokeType (2.5f).createStrokedPath (mTick, tick, AffineTransform::scale (w / 9.0f, h / 9.0f));
+            mTickWidth = w;
+            mTickHeight = h;
+        }
 
         g.setColour (
             component.findColour (isEnabled ? ToggleButton::tickColourId : ToggleButton::tickDisabledColourId));
 
-        const AffineTransform trans (AffineTransform::scale (w / 9.0f, h / 9.0f).translated (x, y));
-
-        g.strokePath (tick, PathStrokeType (2.5f), trans);
+        g.fillPath (mTick, AffineTransform::translation (x, y));
     }
 }
 
@@ -533,54 +540,63 @@ void AudealizeLookAndFeel::drawLinearSlider (Graphics& g, int x, int y, int widt
 
 void AudealizeLookAndFeel::drawRotarySlider (Graphics& g, int x, int y, int width, int height, float sliderPos,
                                              const float rotaryStartAngle, const float rotaryEndAngle, Slider& slider)
+{
+    drawRotaryKnob (g, x, y, width, height, sliderPos, rotaryStartAngle, rotaryEndAngle, rotaryStartAngle, slider);
+}
+
+void AudealizeLookAndFeel::drawRotarySliderCentered (Graphics& g, int x, int y, int width, int height, float sliderPos,
+                                                     const float rotaryStartAngle, const float rotaryEndAngle,
+                                                     Slider& slider)
+{
+    drawRotaryKnob (g, x, y, width, height, sliderPos, rotaryStartAngle, rotaryEndAngle,
+                    (rotaryStartAngle + rotaryEndAngle) * .5f, slider);
+}
+
+void AudealizeLookAndFeel::drawRotaryKnob (Graphics& g, int x, int y, int width, int height, float sliderPos,
+                                           const float rotaryStartAngle, const float rotaryEndAngle,
+                                           const float fillStartAngle, Slider& slider)
 {
     const float radius = jmin (width / 2, height / 2) - 2.0f;
     const float centreX = x + width * 0.5f;
     const float centreY = y + height * 0.5f;
-    const float rx = centreX - radius;
-    const float ry = centreY - radius;
-    const float rw = radius * 2.0f;
     const float angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
     const bool isMouseOver = slider.isMouseOverOrDragging () && slider.isEnabled ();
 
-    if (radius > 12.0f)
-    {
-        const float thickness = 0.78;
+    const RotaryGeometry& geometry = getRotaryGeometry (radius, rotaryStartAngle, rotaryEndAngle);
+    const AffineTransform centre (AffineTransform::translation (centreX, centreY));
+    const AffineTransform rotation (AffineTransform::rotation (angle).translated (centreX, centreY));
 
-        int knobRadius = radius * .68;
-
-        Path e;
-        e.addEllipse (centreX - knobRadius, centreY - knobRadius, knobRadius * 2, knobRadius * 2);
+    const Colour fillColour (slider.isEnabled () ? slider.findColour (Slider::rotarySliderFillColourId)
+                                                       .withAlpha (isMouseOver ? 1.0f : 0.7f)
+                                                 : Colour (0x80808080));
 
+    if (radius > 12.0f)
+    {
         g.setColour (findColour (Slider::ColourIds::thumbColourId));
-        g.fillPath (e);
+        g.fillPath (geometry.knob, centre);
 
         if (shouldDrawOutlines)
         {
             g.setColour (this->outline);
-            g.drawEllipse (centreX - knobRadius, centreY - knobRadius, knobRadius * 2, knobRadius * 2, 1);
+            g.fillPath (geometry.knobOutline, centre);
         }
 
-        Path backgroundArc;
-        backgroundArc.addPieSegment (rx, ry, rw, rw, rotaryStartAngle, rotaryEndAngle, thickness);
-        backgroundArc.closeSubPath ();
-
         g.setColour (findColour (Slider::trackColourId));
-        g.fillPath (backgroundArc);
+        g.fillPath (geometry.backgroundArc, centre);
 
         if (shouldDrawOutlines)
         {
             g.setColour (this->outline);
-            g.strokePath (backgroundArc, PathStrokeType (1));
+            g.fillPath (geometry.backgroundArcOutline, centre);
         }
 
-        if (slider.isEnabled ())
-            g.setColour (slider.findColour (Slider::rotarySliderFillColourId).withAlpha (isMouseOver ? 1.0f : 0.7f));
-        else
-            g.setColour (Colour (0x80808080));
+        // the filled arc is the only part whose shape depends on the value
+        const float rw = radius * 2.0f;
 
         Path filledArc;
-        filledArc.addPieSegment (rx, ry, rw, rw, rotaryStartAngle, angle, thickness);
+        filledArc.addPieSegment (centreX - radius, centreY - radius, rw, rw, fillStartAngle, angle, 0.78f);
+
+        g.setColour (fillColour);
         g.fillPath (filledArc);
 
         if (shouldDrawOutlines)
@@ -589,117 +605,68 @@ void AudealizeLookAndFeel::drawRotarySlider (Graphics& g, int x, int y, int widt
             g.strokePath (filledArc, PathStrokeType (1));
         }
 
-        Path p;
-        float rectHeight = radius * .3f;
-        float rectWidth = radius * .15f;
-        p.addRoundedRectangle (-rectWidth * .5, -rectHeight * 1.8, rectWidth, rectHeight, rectWidth * .5);
-
         g.setColour (findColour (Slider::trackColourId).darker (.3));
-        g.fillPath (p, AffineTransform::rotation (angle).translated (centreX, centreY));
+        g.fillPath (geometry.pointer, rotation);
     }
     else
     {
-        Path p;
-        p.addEllipse (-0.4f * rw, -0.4f * rw, rw * 0.8f, rw * 0.8f);
-        PathStrokeType (rw * 0.1f).createStrokedPath (p, p);
-
-        p.addLineSegment (Line<float> (0.0f, 0.0f, 0.0f, -radius), rw * 0.2f);
-
-        if (slider.isEnabled ())
-            g.setColour (slider.findColour (Slider::rotarySliderFillColourId).withAlpha (isMouseOver ? 1.0f : 0.7f));
-        else
-            g.setColour (Colour (0x80808080));
-
-        g.fillPath (p, AffineTransform::rotation (angle).translated (centreX, centreY));
+        g.setColour (fillColour);
+        g.fillPath (geometry.pointer, rotation);
     }
 }
 
-void AudealizeLookAndFeel::drawRotarySliderCentered (Graphics& g, int x, int y, int width, int height, float sliderPos,
-                                                     const float rotaryStartAngle, const float rotaryEndAngle,
-                                                     Slider& slider)
+const AudealizeLookAndFeel::RotaryGeometry& AudealizeLookAndFeel::getRotaryGeometry (float radius, float startAngle,
+                                                                                     float endAngle)
 {
-    const float radius = jmin (width / 2, height / 2) - 2.0f;
-    const float centreX = x + width * 0.5f;
-    const float centreY = y + height * 0.5f;
-    const float rx = centreX - radius;
-    const float ry = centreY - radius;
-    const float rw = radius * 2.0f;
-    const float angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
-    const bool isMouseOver = slider.isMouseOverOrDragging () && slider.isEnabled ();
-
-    if (radius > 12.0f)
+    for (const RotaryGeometry& cached : mRotaryGeometry)
     {
-        const float thickness = 0.78;
-
-        int knobRadius = radius * .68;
-
-        g.setColour (findColour (Slider::ColourIds::thumbColourId));
-        g.fillEllipse (centreX - knobRadius, centreY - knobRadius, knobRadius * 2, knobRadius * 2);
-
-        if (shouldDrawOutlines)
+        if (cached.radius == radius && cached.startAngle == startAngle && cached.endAngle == endAngle)
         {
-            g.setColour (this->outline);
-            g.drawEllipse (centreX - knobRadius, centreY - knobRadius, knobRadius * 2, knobRadius * 2, 1);
+            return cached;
         }
+    }
 
-        Path backgroundArc;
-        backgroundArc.addPieSegment (rx, ry, rw, rw, rotaryStartAngle, rotaryEndAngle, thickness);
-        backgroundArc.closeSubPath ();
-        g.setColour (findColour (Slider::trackColourId));
-        g.fillPath (backgroundArc);
+    // there are only a few knob sizes on screen at once, so when the cache is full it was probably filled while a
+    // window was being resized, and none of the entries are worth keeping
+    if (mRotaryGeometry.size () >= maxCachedRotaryGeometry)
+    {
+        mRotaryGeometry.clear ();
+    }
 
-        if (shouldDrawOutlines)
-        {
-            g.setColour (this->outline);
-            g.strokePath (backgroundArc, PathStrokeType (1));
-        }
+    mRotaryGeometry.push_back (RotaryGeometry ());
+    RotaryGeometry& geometry = mRotaryGeometry.back ();
+    geometry.radius = radius;
+    geometry.startAngle = startAngle;
+    geometry.endAngle = endAngle;
 
-        if (slider.isEnabled ())
-            g.setColour (slider.findColour (Slider::rotarySliderFillColourId).withAlpha (isMouseOver ? 1.0f : 0.7f));
-        else
-            g.setColour (Colour (0x80808080));
+    const float rw = radius * 2.0f;
 
-        {
-            Path filledArc;
-            filledArc.addPieSegment (rx, ry, rw, rw, (rotaryStartAngle + rotaryEndAngle) * .5f, angle, thickness);
-            g.fillPath (filledArc);
-            if (shouldDrawOutlines)
-            {
-                g.setColour (this->outline);
-                g.strokePath (filledArc, PathStrokeType (1));
-            }
-        }
+    if (radius > 12.0f)
+    {
+        const int knobRadius = radius * .68;
 
-        {
-            Path p;
-            float rectHeight = radius * .3f;
-            float rectWidth = radius * .15f;
-            p.addRoundedRectangle (-rectWidth * .5, -rectHeight * 1.8, rectWidth, rectHeight, rectWidth * .5);
+        geometry.knob.addEllipse (-knobRadius, -knobRadius, knobRadius * 2, knobRadius * 2);
+        PathStrokeType (1).createStrokedPath (geometry.knobOutline, geometry.knob);
 
-            g.setColour (findColour (Slider::trackColourId).darker (.3));
-            g.fillPath (p, AffineTransform::rotation (angle).translated (centreX, centreY));
-        }
+        geometry.backgroundArc.addPieSegment (-radius, -radius, rw, rw, startAngle, endAngle, 0.78f);
+        geometry.backgroundArc.closeSubPath ();
+        PathStrokeType (1).createStrokedPath (geometry.backgroundArcOutline, geometry.backgroundArc);
 
-        if (slider.isEnabled ())
-            g.setColour (slider.findColour (Slider::rotarySliderOutlineColourId));
-        else
-            g.setColour (Colour (0x80808080));
+        const float rectHeight = radius * .3f;
+        const float rectWidth = radius * .15f;
+        geometry.pointer.addRoundedRectangle (-rectWidth * .5, -rectHeight * 1.8, rectWidth, rectHeight,
+                                              rectWidth * .5);
     }
     else
     {
-        if (slider.isEnabled ())
-            g.setColour (slider.findColour (Slider::rotarySliderFillColourId).withAlpha (isMouseOver ? 1.0f : 0.7f));
-        else
-            g.setColour (Colour (0x80808080));
-
-        Path p;
+        Path& p = geometry.pointer;
         p.addEllipse (-0.4f * rw, -0.4f * rw, rw * 0.8f, rw * 0.8f);
         PathStrokeType (rw * 0.1f).createStrokedPath (p, p);
 
         p.addLineSegment (Line<float> (0.0f, 0.0f, 0.0f, -radius), rw * 0.2f);
-
-        g.fillPath (p, AffineTransform::rotation (angle).translated (centreX, centreY));
     }
+
+    return geometry;
 }
 
 void AudealizeLookAndFeel::drawCornerResizer (Graphics& g, int w, int h, bool /*isMouseOver*/, bool /*isMouseDragging*/)
@@ -104,6 +104,9 @@ public:
     void drawRotarySlider (Graphics& g, int x, int y, int width, int height, float sliderPos,
                            const float rotaryStartAngle, const float rotaryEndAngle, Slider& slider) override;
 
+    /**
+     *  Draws a rotary slider whose filled arc starts at the centre of its range instead of at the start
+     */
     void drawRotarySliderCentered (Graphics& g, int x, int y, int width, int height, float sliderPos,
                                    const float rotaryStartAngle, const float rotaryEndAngle, Slider& slider);
     void drawCornerResizer (Graphics& g, int w, int h, bool /*isMouseOver*/, bool /*isMouseDragging*/) override;
@@ -127,8 +130,20 @@ public:
 
     Typeface::Ptr getTypefaceForFont (const Font& font) override
     {
-        return Typeface::createSystemTypefaceFor (AudealizeFonts::RobotoRegular_ttf,
-                                                  AudealizeFonts::RobotoRegular_ttfSize);
+        if (mTypeface == nullptr)
+        {
+            mTypeface = Typeface::createSystemTypefaceFor (AudealizeFonts::RobotoRegular_ttf,
+                                                           AudealizeFonts::RobotoRegular_ttfSize);
+        }
+        return mTypeface;
+    }
+
+    /**
+     *  Sets the typeface returned for every font, e.g. to share one parsed copy of Roboto between look and feels
+     */
+    void setTypeface (Typeface::Ptr typeface)
+    {
+        mTypeface = typeface;
     }
 
 protected:
@@ -136,6 +151,41 @@ protected:
     bool shouldDrawOutlines;
     Colour outline, tickBoxFill;
 
+    Typeface::Ptr mTypeface;  // created on first use unless set with setTypeface
+
+private:
+    /// The parts of a rotary slider that only depend on its size and angle range, built around the origin. They are
+    /// translated (or, for the pointer, rotated) into place when painting.
+    struct RotaryGeometry
+    {
+        float radius, startAngle, endAngle;
+
+        Path knob, knobOutline;                    // outlines are already stroked, so they're filled
+        Path backgroundArc, backgroundArcOutline;  // the full range of the slider
+        Path pointer;                              // at angle 0; the whole knob for small sliders
+    };
+
+    static const size_t maxCachedRotaryGeometry = 8;
+
+    std::vector<RotaryGeometry> mRotaryGeometry;  // cached geometry, one entry per knob size on screen
+
+    Path mTick;  // stroked tick box tick, for a box of mTickWidth x mTickHeight
+    float mTickWidth = 0, mTickHeight = 0;
+
+    /**
+     *  Draws a rotary slider
+     *
+     *  @param fillStartAngle The angle the filled arc starts at. The arc ends at the angle of the current value
+     */
+    void drawRotaryKnob (Graphics& g, int x, int y, int width, int height, float sliderPos,
+                         const float rotaryStartAngle, const float rotaryEndAngle, const float fillStartAngle,
+                         Slider& slider);
+
+    /**
+     *  Returns the cached geometry for a rotary slider, building it if there is none
+     */
+    const RotaryGeometry& getRotaryGeometry (float radius, float startAngle, float endAngle);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudealizeLookAndFeel);
 };
 
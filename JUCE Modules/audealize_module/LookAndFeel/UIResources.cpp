@@ -0,0 +1,59 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include "UIResources.h"
+
+namespace Audealize
+{
+UIResources::UIResources ()
+    : mTypeface (
+          Typeface::createSystemTypefaceFor (AudealizeFonts::RobotoRegular_ttf, AudealizeFonts::RobotoRegular_ttfSize))
+{
+    mGraphics.add (
+        Drawable::createFromImageData (AudealizeImages::darkModeButton_svg, AudealizeImages::darkModeButton_svgSize));
+    mGraphics.add (
+        Drawable::createFromImageData (AudealizeImages::powerButton_svg, AudealizeImages::powerButton_svgSize));
+    mGraphics.add (Drawable::createFromImageData (AudealizeImages::iallogo_svg, AudealizeImages::iallogo_svgSize));
+
+    mLookAndFeel.setTypeface (mTypeface);
+    mLookAndFeelDark.setTypeface (mTypeface);
+}
+
+UIResources::~UIResources ()
+{
+}
+
+AudealizeLookAndFeel& UIResources::getLookAndFeel (bool dark)
+{
+    if (dark)
+    {
+        return mLookAndFeelDark;
+    }
+    return mLookAndFeel;
+}
+
+Drawable* UIResources::createGraphic (Graphic graphic) const
+{
+    const Drawable* original = mGraphics[graphic];
+    return original != nullptr ? original->createCopy () : nullptr;
+}
+}
@@ -0,0 +1,80 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef UIResources_h
+#define UIResources_h
+
+namespace Audealize
+{
+/// Resources that every Audealize editor needs: the light/dark look and feels, the Roboto typeface and the parsed
+/// SVG graphics. They are created once per process and shared by all open editors through a SharedResourcePointer,
+/// so opening another plugin window doesn't parse the embedded fonts and images again.
+///
+/// The shared objects are never modified after construction. Graphics are handed out as clones, which the caller
+/// owns and may recolour with Drawable::replaceColour.
+class UIResources
+{
+public:
+    enum Graphic
+    {
+        kDarkModeButton = 0,
+        kPowerButton,
+        kLabLogo,
+        kNumGraphics
+    };
+
+    UIResources ();
+    ~UIResources ();
+
+    /**
+     *  Returns the shared look and feel for a color scheme
+     *
+     *  @param dark true for the dark scheme, false for the light one
+     */
+    AudealizeLookAndFeel& getLookAndFeel (bool dark);
+
+    /**
+     *  Returns a new copy of one of the embedded graphics, or nullptr if it couldn't be parsed
+     */
+    Drawable* createGraphic (Graphic graphic) const;
+
+    /**
+     *  Returns the typeface used for all text in Audealize editors
+     */
+    Typeface::Ptr getTypeface () const
+    {
+        return mTypeface;
+    }
+
+private:
+    Typeface::Ptr mTypeface;
+
+    OwnedArray<Drawable> mGraphics;  // indexed by Graphic
+
+    AudealizeLookAndFeel mLookAndFeel;
+    AudealizeLookAndFeelDark mLookAndFeelDark;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UIResources)
+};
+}
+
+#endif /* UIResources_h */
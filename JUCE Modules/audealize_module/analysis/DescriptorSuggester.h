@@ -0,0 +1,247 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef DescriptorSuggester_h
+#define DescriptorSuggester_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// Ranks EQ descriptors by how well their curves would move an input spectrum towards a target spectrum.
+///
+/// Only the shapes of the curves are compared: descriptors are ranked by the cosine similarity between the correction
+/// the input needs (target minus input, in dB per band) and their zero-mean curves.
+///
+/// If the descriptors are stored as coefficients in a DescriptorBasis, the search runs on the coefficients: with
+/// the curve of descriptor i reconstructed as mean + C' c[i], its dot product with a zero-mean correction r is
+/// r.mean + (C r).c[i], so only C r has to be computed in full.
+class DescriptorSuggester
+{
+public:
+    DescriptorSuggester () : mNumBands (0), mRowSize (0)
+    {
+    }
+
+    /**
+     *  Sets the descriptors to choose from
+     *
+     *  @param words    The descriptors
+     *  @param settings The EQ settings of each descriptor, as passed to AudealizeAudioProcessor::settingsFromMap,
+     *                  or their coefficients in basis
+     *  @param basis    The basis settings are stored in, or an empty basis
+     */
+    void setDescriptors (const vector<String>& words, const vector<vector<float>>& settings,
+                         const DescriptorBasis& basis)
+    {
+        mWords = words;
+        mBasis = basis;
+        mNumBands = basis.isEmpty () ? (settings.size () > 0 ? (int) settings[0].size () : 0) : basis.getNumDimensions ();
+        mRowSize = basis.isEmpty () ? mNumBands : basis.getNumComponents () + 1;
+        mRows.assign (settings.size () * mRowSize, 0.0f);
+
+        for (int i = 0; i < settings.size (); i++)
+        {
+            float* row = &mRows[i * mRowSize];
+
+            // normalised the way settingsFromMap does it, so a higher setting is a boost
+            vector<float> curve = basis.isEmpty () ? settings[i] : basis.reconstruct (settings[i]);
+            DescriptorBasis::normalize (curve);
+
+            const float length = normaliseShape (curve, 1.0e-6f);
+
+            // flat curves end up at the origin, with no similarity to any correction
+            if (length == 0.0f)
+            {
+                continue;
+            }
+
+            if (basis.isEmpty ())
+            {
+                std::copy (curve.begin (), curve.end (), row);
+            }
+            else
+            {
+                // [c, 1] scaled by the length of the zero-mean curve
+                for (int k = 0; k < basis.getNumComponents (); k++)
+                {
+                    row[k] = settings[i][k] / length;
+                }
+                row[basis.getNumComponents ()] = 1.0f / length;
+            }
+        }
+    }
+
+    /**
+     *  Returns a target spectrum that falls by 3 dB per octave (pink noise), a neutral balance for most material
+     *
+     *  @param bandFreqs Centre frequencies of the bands
+     */
+    static vector<float> getDefaultTarget (const vector<float>& bandFreqs)
+    {
+        vector<float> target (bandFreqs.size ());
+        for (int b = 0; b < target.size (); b++)
+        {
+            target[b] = -10.0f * std::log10 (bandFreqs[b]);
+        }
+        return target;
+    }
+
+    /**
+     *  Finds the descriptors whose curves best match the correction an input needs to reach a target
+     *
+     *  @param input  Power spectral density of the input per band, in dB
+     *  @param target Power spectral density of the target per band, in dB
+     *  @param k      Maximum number of descriptors to return
+     *
+     *  @return the best descriptors, best first. Empty if the input already matches the target
+     */
+    StringArray suggest (const vector<float>& input, const vector<float>& target, int k) const
+    {
+        StringArray result;
+
+        if (input.size () != mNumBands || target.size () != input.size () || mRowSize == 0)
+        {
+            return result;
+        }
+
+        // a descriptor can only ever make a modest change, so very large differences (e.g. an empty band) are capped
+        vector<float> correction (input.size ());
+        for (int b = 0; b < correction.size (); b++)
+        {
+            correction[b] = jlimit (-24.0f, 24.0f, target[b] - input[b]);
+        }
+
+        // less than a tenth of a dB off on average: nothing to suggest
+        if (normaliseShape (correction, 0.1f) == 0.0f)
+        {
+            return result;
+        }
+
+        vector<float> query (mRowSize);
+        if (mBasis.isEmpty ())
+        {
+            query = correction;
+        }
+        else
+        {
+            mBasis.projectDirection (correction.data (), query.data ());
+
+            const vector<float>& mean = mBasis.getMean ();
+            query[mRowSize - 1] = 0.0f;
+            for (int b = 0; b < mNumBands; b++)
+            {
+                query[mRowSize - 1] += correction[b] * mean[b];
+            }
+        }
+
+        // highest similarity first
+        k = jmin (k, 16);
+        int indices[16];
+        float distances[16];
+        int found = 0;
+
+        for (int i = 0; i < mWords.size (); i++)
+        {
+            const float* row = &mRows[i * mRowSize];
+            float similarity = 0.0f;
+            for (int j = 0; j < mRowSize; j++)
+            {
+                similarity += row[j] * query[j];
+            }
+
+            insertNearest (i, -similarity, k, indices, distances, found);
+        }
+
+        for (int i = 0; i < found; i++)
+        {
+            result.add (mWords[indices[i]]);
+        }
+
+        return result;
+    }
+
+    /**
+     *  Returns the memory allocated for the descriptors and their curves, in bytes
+     */
+    size_t getSizeInBytes () const
+    {
+        size_t size = MemoryUsage::sizeOf (mWords) + mBasis.getSizeInBytes () + MemoryUsage::sizeOf (mRows);
+        for (const String& word : mWords)
+        {
+            size += MemoryUsage::sizeOf (word);
+        }
+        return size;
+    }
+
+private:
+    vector<String> mWords;
+    DescriptorBasis mBasis;
+    int mNumBands;
+    int mRowSize;
+    vector<float> mRows;  // [descriptor][mRowSize]: unit zero-mean curves, or scaled coefficients
+
+    /**
+     *  Removes the mean of a curve and scales it to unit length
+     *
+     *  @param curve  The curve
+     *  @param minRMS RMS deviation from the mean below which the curve is treated as flat
+     *
+     *  @return the length of the zero-mean curve, or 0 if the curve is flat (it's left at zero)
+     */
+    static float normaliseShape (vector<float>& curve, float minRMS)
+    {
+        float mean = 0.0f;
+        for (int i = 0; i < curve.size (); i++)
+        {
+            mean += curve[i];
+        }
+        mean /= jmax (1, (int) curve.size ());
+
+        float length = 0.0f;
+        for (int i = 0; i < curve.size (); i++)
+        {
+            curve[i] -= mean;
+            length += curve[i] * curve[i];
+        }
+        length = std::sqrt (length);
+
+        if (length <= minRMS * std::sqrt ((float) curve.size ()))
+        {
+            std::fill (curve.begin (), curve.end (), 0.0f);
+            return 0.0f;
+        }
+
+        for (int i = 0; i < curve.size (); i++)
+        {
+            curve[i] /= length;
+        }
+        return length;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (DescriptorSuggester)
+};
+
+}  // namespace Audealize
+
+#endif /* DescriptorSuggester_h */
@@ -0,0 +1,497 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "InputAnalyser.h"
+
+namespace Audealize
+{
+namespace
+{
+const float silenceLevel = -80.0f;  // frames quieter than this (dBFS) are ignored
+const int minFramesForSpectrum = 32;
+const double inputTimeConstant = 1000.0;  // in analysed frames, about 1.5 minutes of input at 44.1 kHz
+}
+
+void InputAnalyser::Accumulator::reset (int numBands)
+{
+    bandPower.assign (numBands, 0.0);
+    weight = 0.0;
+    numFrames = 0;
+    decayTime = 0.0f;
+    numDecays = 0;
+    inRun = false;
+    decayPeak = lastLevel = silenceLevel;
+    decayFrames = 0;
+}
+
+InputAnalyser::InputAnalyser (const vector<float>& bandFreqs)
+    : mBandFreqs (bandFreqs),
+      mFFT (fftOrder, false),
+      mSampleRate (0.0),
+      mFifo (burstSize * fifoBursts),
+      mPeriodPos (0),
+      mPeriod (0),
+      mBurstsWritten (0),
+      mForwarding (false),
+      mJobSampleRate (0.0),
+      mBurstsRead (0),
+      mLastPeriod (-1),
+      mHasReference (false),
+      mResetPending (false)
+{
+    mWindow.malloc (fftSize);
+    mFrame.calloc (fftSize * 2);
+    mFifoBuffer.calloc (mFifo.getTotalSize ());
+    mBurst.calloc (burstSize);
+
+    // Hann window, scaled so a full scale sine reads about 0 dB
+    for (int i = 0; i < fftSize; i++)
+    {
+        mWindow[i] = (float) (0.5 - 0.5 * std::cos (2.0 * double_Pi * i / fftSize)) * 4.0f / fftSize;
+    }
+
+    mInput.reset ((int) mBandFreqs.size ());
+    mReference.reset ((int) mBandFreqs.size ());
+    mWorking.reset ((int) mBandFreqs.size ());
+
+    mWorkerPool->submitRecurring ("Input analysis", WorkerPool::kPriorityNormal, mToken,
+                                  [this] () { return analyseNext (); });
+}
+
+InputAnalyser::~InputAnalyser ()
+{
+    mToken.cancel ();
+    mWorkerPool->waitFor (mToken);
+}
+
+void InputAnalyser::prepare (double sampleRate)
+{
+    const ScopedLock sl (mLock);
+
+    mSampleRate = sampleRate;
+    getBinBands (sampleRate, mBinBand);
+
+    mFifo.reset ();
+    mPeriodPos = 0;
+    mPeriod = 0;
+    mBurstsWritten = 0;
+    mForwarding = false;
+
+    // the job resets its own state before it reads the next burst
+    mInput.reset ((int) mBandFreqs.size ());
+    mResetPending = true;
+}
+
+void InputAnalyser::pushSamples (const AudioSampleBuffer& buffer, int numChannels)
+{
+    const int numSamples = buffer.getNumSamples ();
+    numChannels = jmin (numChannels, buffer.getNumChannels ());
+
+    if (numChannels <= 0 || mSampleRate <= 0.0)
+    {
+        return;
+    }
+
+    const float scale = 1.0f / numChannels;
+    int pos = 0;
+
+    while (pos < numSamples)
+    {
+        // decide at the start of each burst whether it will fit
+        if (mPeriodPos == 0)
+        {
+            mForwarding = mFifo.getFreeSpace () >= burstSize;
+
+            // published to the job by the FIFO write at the end of the burst. the slot isn't reused until the burst
+            // fifoBursts before has been read
+            if (mForwarding)
+            {
+                mBurstPeriods[mBurstsWritten++ % fifoBursts] = mPeriod;
+            }
+        }
+
+        const bool inBurst = mPeriodPos < burstSize;
+        const int periodLength = burstSize * decimationFactor;
+        const int todo = jmin (numSamples - pos, (inBurst ? burstSize : periodLength) - mPeriodPos);
+
+        if (inBurst && mForwarding)
+        {
+            int start1, size1, start2, size2;
+            mFifo.prepareToWrite (todo, start1, size1, start2, size2);
+
+            // mix down to mono
+            for (int ch = 0; ch < numChannels; ch++)
+            {
+                const float* src = buffer.getReadPointer (ch, pos);
+                if (ch == 0)
+                {
+                    FloatVectorOperations::copyWithMultiply (mFifoBuffer + start1, src, scale, size1);
+                    FloatVectorOperations::copyWithMultiply (mFifoBuffer + start2, src + size1, scale, size2);
+                }
+                else
+                {
+                    FloatVectorOperations::addWithMultiply (mFifoBuffer + start1, src, scale, size1);
+                    FloatVectorOperations::addWithMultiply (mFifoBuffer + start2, src + size1, scale, size2);
+                }
+            }
+
+            mFifo.finishedWrite (size1 + size2);
+        }
+
+        pos += todo;
+        mPeriodPos = (mPeriodPos + todo) % periodLength;
+
+        if (mPeriodPos == 0)
+        {
+            mPeriod++;
+        }
+    }
+}
+
+void InputAnalyser::loadReference (const File& file)
+{
+    const ScopedLock sl (mLock);
+    mPendingReference = file;
+}
+
+void InputAnalyser::clearReference ()
+{
+    const ScopedLock sl (mLock);
+    mPendingReference = File ();
+    mHasReference = false;
+}
+
+bool InputAnalyser::hasReference () const
+{
+    const ScopedLock sl (mLock);
+    return mHasReference;
+}
+
+bool InputAnalyser::getInputSpectrum (vector<float>& bandLevels) const
+{
+    const ScopedLock sl (mLock);
+
+    if (mInput.numFrames < minFramesForSpectrum)
+    {
+        return false;
+    }
+
+    toDecibels (mInput, bandLevels);
+    return true;
+}
+
+bool InputAnalyser::getReferenceSpectrum (vector<float>& bandLevels) const
+{
+    const ScopedLock sl (mLock);
+
+    if (!mHasReference)
+    {
+        return false;
+    }
+
+    toDecibels (mReference, bandLevels);
+    return true;
+}
+
+float InputAnalyser::getDecayTime () const
+{
+    const ScopedLock sl (mLock);
+    return mInput.decayTime;
+}
+
+size_t InputAnalyser::getSizeInBytes () const
+{
+    const ScopedLock sl (mLock);
+
+    // window, frame, FIFO buffer and burst, plus the FFT's twiddle table
+    size_t size = (fftSize + fftSize * 2 + (size_t) mFifo.getTotalSize () + burstSize) * sizeof (float) +
+                  (size_t) mFFT.getSize () * sizeof (FFT::Complex);
+
+    size += MemoryUsage::sizeOf (mBandFreqs) + MemoryUsage::sizeOf (mBinBand) + MemoryUsage::sizeOf (mJobBinBand) +
+            MemoryUsage::sizeOf (mInput.bandPower) + MemoryUsage::sizeOf (mReference.bandPower) +
+            MemoryUsage::sizeOf (mWorking.bandPower);
+    return size;
+}
+
+int InputAnalyser::analyseNext ()
+{
+    File reference;
+    {
+        const ScopedLock sl (mLock);
+        reference = mPendingReference;
+        mPendingReference = File ();
+    }
+
+    if (reference != File ())
+    {
+        analyseReference (reference);
+        return 0;
+    }
+
+    // the lock is only held to take the burst out and to publish the results: the FFTs run on the job's own state,
+    // so the getters never wait for them
+    int64 period;
+    bool moreReady;
+    {
+        const ScopedLock sl (mLock);
+
+        if (mResetPending)
+        {
+            mJobSampleRate = mSampleRate;
+            mJobBinBand = mBinBand;
+            mWorking.reset ((int) mBandFreqs.size ());
+            mBurstsRead = 0;
+            mLastPeriod = -1;
+            mResetPending = false;
+        }
+
+        // a whole burst is always written at once, so bursts stay aligned in the FIFO
+        if (mFifo.getNumReady () < burstSize)
+        {
+            return 100;
+        }
+
+        int start1, size1, start2, size2;
+        mFifo.prepareToRead (burstSize, start1, size1, start2, size2);
+        FloatVectorOperations::copy (mBurst, mFifoBuffer + start1, size1);
+        FloatVectorOperations::copy (mBurst + size1, mFifoBuffer + start2, size2);
+        period = mBurstPeriods[mBurstsRead++ % fifoBursts];
+        mFifo.finishedRead (size1 + size2);
+
+        moreReady = mFifo.getNumReady () >= burstSize;
+    }
+
+    // the burst of the next decimation period follows this one after a gap. after a skipped burst it's too far away
+    // to carry a decay across
+    const int periodLength = burstSize * decimationFactor;
+    const int hopsSinceLast =
+        mLastPeriod >= 0 && period == mLastPeriod + 1 ? (periodLength - (burstSize - fftSize)) / hopSize : 0;
+    mLastPeriod = period;
+
+    const double forgetting = 1.0 - 1.0 / inputTimeConstant;
+    analyse (mBurst, burstSize, mJobSampleRate, mJobBinBand, mWorking, forgetting, hopsSinceLast);
+
+    {
+        const ScopedLock sl (mLock);
+
+        // a prepare () during the analysis has cleared the results, and this burst was taken at the old sample rate
+        if (!mResetPending)
+        {
+            mInput = mWorking;
+        }
+    }
+
+    return moreReady ? 0 : 100;
+}
+
+void InputAnalyser::getBinBands (double sampleRate, vector<int>& binBand) const
+{
+    const int numBins = fftSize / 2 + 1;
+    const int numBands = (int) mBandFreqs.size ();
+    const double binWidth = sampleRate / fftSize;
+
+    binBand.assign (numBins, -1);
+    if (numBands == 0 || sampleRate <= 0.0)
+    {
+        return;
+    }
+
+    // band edges halfway between the centre frequencies on a log scale
+    for (int b = 0; b < numBands; b++)
+    {
+        const double fc = mBandFreqs[b];
+        const double lo = b > 0 ? std::sqrt (fc * mBandFreqs[b - 1]) : 0.0;
+        const double hi = b < numBands - 1 ? std::sqrt (fc * mBandFreqs[b + 1]) : sampleRate * 0.5;
+
+        const int first = jmax (1, (int) std::ceil (lo / binWidth));
+        const int last = jmin (numBins - 1, (int) std::floor (hi / binWidth));
+
+        for (int bin = first; bin <= last; bin++)
+        {
+            binBand[bin] = b;
+        }
+    }
+}
+
+void InputAnalyser::analyse (const float* samples, int numSamples, double sampleRate, const vector<int>& binBand,
+                             Accumulator& acc, double forgetting, int hopsSinceLast)
+{
+    const int numBands = (int) acc.bandPower.size ();
+    const int numBins = fftSize / 2 + 1;
+    const double frameSeconds = hopSize / sampleRate;
+
+    vector<double> power (numBands);
+    vector<int> count (numBands);
+
+    // bands too narrow to hold a bin at this sample rate take the level of the bin nearest their centre
+    vector<int> centreBin (numBands);
+    for (int b = 0; b < numBands; b++)
+    {
+        centreBin[b] = jlimit (1, numBins - 1, roundToInt (mBandFreqs[b] * fftSize / sampleRate));
+    }
+
+    if (hopsSinceLast <= 0)
+    {
+        finishDecay (acc, frameSeconds);
+        acc.inRun = false;
+    }
+
+    // frames skipped before the first one, which a decay carried across them counts too
+    int skippedFrames = jmax (0, hopsSinceLast - 1);
+
+    for (int n = 0; n + fftSize <= numSamples; n += hopSize, skippedFrames = 0)
+    {
+        FloatVectorOperations::multiply (mFrame, samples + n, mWindow, fftSize);
+        FloatVectorOperations::clear (mFrame + fftSize, fftSize);
+        mFFT.performFrequencyOnlyForwardTransform (mFrame);
+
+        std::fill (power.begin (), power.end (), 0.0);
+        std::fill (count.begin (), count.end (), 0);
+
+        double total = 0.0;
+        for (int bin = 1; bin < numBins; bin++)
+        {
+            const double p = (double) mFrame[bin] * mFrame[bin];
+            total += p;
+
+            if (binBand[bin] >= 0)
+            {
+                power[binBand[bin]] += p;
+                count[binBand[bin]]++;
+            }
+        }
+
+        const float level = (float) (10.0 * std::log10 (total + 1.0e-20));
+
+        // silence ends a decay, and doesn't count towards the spectrum
+        if (level < silenceLevel)
+        {
+            finishDecay (acc, frameSeconds);
+            acc.inRun = false;
+            continue;
+        }
+
+        // a decay is measured from the last frame within 1 dB of its peak, so sustained sounds don't count as decaying
+        if (!acc.inRun || level > acc.lastLevel + 0.5f)
+        {
+            finishDecay (acc, frameSeconds);
+            acc.inRun = true;
+            acc.decayPeak = level;
+        }
+        else if (level >= acc.decayPeak - 1.0f)
+        {
+            acc.decayPeak = jmax (acc.decayPeak, level);
+            acc.decayFrames = 0;
+        }
+        else
+        {
+            acc.decayFrames += 1 + skippedFrames;
+        }
+        acc.lastLevel = level;
+
+        // running average of the power spectral density of each band
+        acc.weight = acc.weight * forgetting + 1.0;
+        const double w = 1.0 / acc.weight;
+
+        for (int b = 0; b < numBands; b++)
+        {
+            const double density =
+                count[b] > 0 ? power[b] / count[b] : (double) mFrame[centreBin[b]] * mFrame[centreBin[b]];
+            acc.bandPower[b] += (density - acc.bandPower[b]) * w;
+        }
+
+        acc.numFrames++;
+    }
+}
+
+void InputAnalyser::finishDecay (Accumulator& acc, double frameSeconds)
+{
+    const float drop = acc.decayPeak - acc.lastLevel;
+
+    if (acc.decayFrames >= 3 && drop >= 10.0f)
+    {
+        const float decayTime = (float) (60.0 * acc.decayFrames * frameSeconds / drop);
+        acc.numDecays++;
+        acc.decayTime += (decayTime - acc.decayTime) / jmin (acc.numDecays, 50);
+    }
+
+    acc.decayFrames = 0;
+}
+
+void InputAnalyser::toDecibels (const Accumulator& acc, vector<float>& bandLevels)
+{
+    bandLevels.resize (acc.bandPower.size ());
+    for (int b = 0; b < bandLevels.size (); b++)
+    {
+        bandLevels[b] = (float) (10.0 * std::log10 (acc.bandPower[b] + 1.0e-20));
+    }
+}
+
+void InputAnalyser::analyseReference (const File& file)
+{
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats ();
+
+    ScopedPointer<AudioFormatReader> reader (formatManager.createReaderFor (file));
+    if (reader == nullptr || reader->sampleRate <= 0.0)
+    {
+        return;
+    }
+
+    vector<int> binBand;
+    getBinBands (reader->sampleRate, binBand);
+
+    Accumulator acc;
+    acc.reset ((int) mBandFreqs.size ());
+
+    // stream the file through in bursts, mixed down to mono. Bursts overlap by a frame so no audio is skipped
+    const int numChannels = jmin ((int) reader->numChannels, 2);
+    AudioSampleBuffer block (numChannels, burstSize);
+    HeapBlock<float> mono (burstSize);
+
+    for (int64 pos = 0; pos < reader->lengthInSamples && !mToken.isCancelled (); pos += burstSize - fftSize + hopSize)
+    {
+        const int numSamples = (int) jmin ((int64) burstSize, reader->lengthInSamples - pos);
+        reader->read (&block, 0, numSamples, pos, true, numChannels > 1);
+
+        FloatVectorOperations::copyWithMultiply (mono, block.getReadPointer (0), 1.0f / numChannels, numSamples);
+        if (numChannels > 1)
+        {
+            FloatVectorOperations::addWithMultiply (mono, block.getReadPointer (1), 0.5f, numSamples);
+        }
+
+        analyse (mono, numSamples, reader->sampleRate, binBand, acc, 1.0, pos > 0 ? 1 : 0);
+    }
+
+    // the end of the file ends its last decay
+    finishDecay (acc, hopSize / reader->sampleRate);
+
+    const ScopedLock sl (mLock);
+    if (acc.numFrames > 0)
+    {
+        mReference = acc;
+        mHasReference = true;
+    }
+}
+
+}  // namespace Audealize
@@ -0,0 +1,227 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef InputAnalyser_h
+#define InputAnalyser_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// Builds a long-term picture of a processor's input in a recurring WorkerPool job: the average power spectrum in the
+/// EQ's bands and an estimate of how quickly the signal decays after transients.
+///
+/// The audio thread only copies samples into a lock-free FIFO. To keep that cost (and the analysis job's) low, the
+/// stream is decimated in time rather than resampled, which would throw away the upper EQ bands: one burst of
+/// burstSize contiguous samples is forwarded in every decimationFactor bursts, and bursts that don't fit in the FIFO
+/// are skipped whole. All accumulators are fixed size, so memory use doesn't grow with running time.
+///
+/// The job analyses each burst on its own copy of the accumulators and only holds the lock to take the burst out of
+/// the FIFO and to publish the results. A decay still in progress at the end of a burst is followed into the burst
+/// of the next decimation period, across the samples skipped in between.
+class InputAnalyser
+{
+public:
+    static const int fftOrder = 11;
+    static const int fftSize = 1 << fftOrder;
+    static const int hopSize = fftSize / 2;
+    static const int burstSize = 16 * hopSize;
+    static const int decimationFactor = 4;
+    static const int fifoBursts = 4;
+
+    /**
+     *  Constructor
+     *
+     *  @param bandFreqs Centre frequencies of the bands to analyse, in ascending order
+     */
+    InputAnalyser (const vector<float>& bandFreqs);
+    ~InputAnalyser ();
+
+    /**
+     *  Returns the centre frequencies of the analysed bands
+     */
+    const vector<float>& getBandFreqs () const
+    {
+        return mBandFreqs;
+    }
+
+    /**
+     *  Sets the sample rate of the input and clears everything analysed so far. Must not be called concurrently with
+     *  pushSamples
+     */
+    void prepare (double sampleRate);
+
+    /**
+     *  Forwards input to the analysis job. Lock-free, to be called from the audio thread
+     *
+     *  @param buffer      Audio to analyse
+     *  @param numChannels Number of channels of buffer to mix down
+     */
+    void pushSamples (const AudioSampleBuffer& buffer, int numChannels);
+
+    /**
+     *  Queues an audio file to be analysed by the background job, to be used as the reference spectrum
+     */
+    void loadReference (const File& file);
+
+    /**
+     *  Forgets the reference spectrum
+     */
+    void clearReference ();
+
+    /**
+     *  Returns true if a reference file has been analysed
+     */
+    bool hasReference () const;
+
+    /**
+     *  Copies the long-term average spectrum of the input
+     *
+     *  @param bandLevels Receives the average power spectral density in each band, in dB
+     *
+     *  @return false if not enough input has been analysed yet
+     */
+    bool getInputSpectrum (vector<float>& bandLevels) const;
+
+    /**
+     *  Copies the average spectrum of the reference file
+     *
+     *  @param bandLevels Receives the average power spectral density in each band, in dB
+     *
+     *  @return false if there is no reference
+     */
+    bool getReferenceSpectrum (vector<float>& bandLevels) const;
+
+    /**
+     *  Returns the average time it takes the input to decay by 60 dB after a transient, extrapolated from the decays
+     *  seen so far, or 0 if none have been measured
+     */
+    float getDecayTime () const;
+
+    /**
+     *  Returns the memory allocated for the FFT, the FIFO to the analysis job and the accumulators, in bytes
+     */
+    size_t getSizeInBytes () const;
+
+private:
+    /// Per-band and decay accumulators for one signal
+    struct Accumulator
+    {
+        vector<double> bandPower;  // average power spectral density per band
+        double weight;             // sum of the frame weights the averages are made of
+        int numFrames;
+
+        float decayTime;  // running average, seconds to decay by 60 dB
+        int numDecays;
+
+        // the decay in progress, in frame levels (dB)
+        bool inRun;        // false if the next frame doesn't follow on from the last
+        float decayPeak;   // level the current decay started from
+        float lastLevel;
+        int decayFrames;   // frames since the decay started
+
+        void reset (int numBands);
+    };
+
+    vector<float> mBandFreqs;
+
+    FFT mFFT;
+    HeapBlock<float> mWindow, mFrame;
+
+    double mSampleRate;
+    vector<int> mBinBand;  // band of each FFT bin at mSampleRate, or -1
+
+    // audio thread -> analysis job
+    AbstractFifo mFifo;
+    HeapBlock<float> mFifoBuffer;
+    int64 mBurstPeriods[fifoBursts];  // decimation period each burst was taken from, by burst index modulo fifoBursts
+    int mPeriodPos;     // position within the current decimation period, audio thread only
+    int64 mPeriod;      // index of the current decimation period, audio thread only
+    int mBurstsWritten; // bursts forwarded since prepare, audio thread only
+    bool mForwarding;   // true if the current burst is being forwarded, audio thread only
+
+    // analysis job only
+    HeapBlock<float> mBurst;
+    Accumulator mWorking;  // the input analysis, copied to mInput after each burst
+    double mJobSampleRate;
+    vector<int> mJobBinBand;
+    int mBurstsRead;
+    int64 mLastPeriod;  // decimation period of the last burst analysed, or -1
+
+    File mPendingReference;
+    Accumulator mInput, mReference;  // the published results
+    bool mHasReference;
+    bool mResetPending;  // set by prepare until the job has reset mWorking and taken the new sample rate
+
+    CriticalSection mLock;  // guards the FIFO's read side, the settings, the pending reference and the results
+
+    SharedResourcePointer<WorkerPool> mWorkerPool;
+    WorkerPool::CancellationToken mToken;  // of the analysis job
+
+    /**
+     *  Body of the analysis job. Analyses a pending reference file or the next burst of input
+     *
+     *  @return the number of milliseconds until the job should run again
+     */
+    int analyseNext ();
+
+    /**
+     *  Maps FFT bins to bands for a sample rate
+     */
+    void getBinBands (double sampleRate, vector<int>& binBand) const;
+
+    /**
+     *  Analyses a run of contiguous samples frame by frame, adding to the band averages and the decay estimate. A
+     *  decay still in progress at the end is left open for the next call. Analysis job only
+     *
+     *  @param samples       The samples
+     *  @param numSamples    Number of samples
+     *  @param sampleRate    Their sample rate
+     *  @param binBand       FFT bin to band mapping at that sample rate
+     *  @param acc           The accumulator to add to
+     *  @param forgetting    Weight of the existing averages per frame, 1 for a plain average
+     *  @param hopsSinceLast Hops from the last frame of the previous call on acc to the first frame of this one, or 0
+     *                       if these samples don't follow on from those. The decay in progress is carried across the
+     *                       hops in between if the level is still falling after them
+     */
+    void analyse (const float* samples, int numSamples, double sampleRate, const vector<int>& binBand,
+                  Accumulator& acc, double forgetting, int hopsSinceLast);
+
+    /**
+     *  Ends the decay in progress and adds it to the decay estimate if it was long and deep enough to measure
+     */
+    static void finishDecay (Accumulator& acc, double frameSeconds);
+
+    /**
+     *  Converts an accumulator's band powers to dB
+     */
+    static void toDecibels (const Accumulator& acc, vector<float>& bandLevels);
+
+    void analyseReference (const File& file);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InputAnalyser)
+};
+
+}  // namespace Audealize
+
+#endif /* InputAnalyser_h */
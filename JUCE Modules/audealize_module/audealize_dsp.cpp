@@ -0,0 +1,43 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#if defined(AUDEALIZE_DSP) && !defined(AUDEALIZE_MODULE)
+/* Compile this file on its own, or let audealize_module.cpp include it - don't include it in a file that has
+   already included other headers.
+*/
+#error "Incorrect use of audealize_dsp.cpp"
+#endif
+
+// Your project must contain an AppConfig.h file with your project-specific settings in it,
+// and your header search path must make it accessible to the module's files.
+#include "AppConfig.h"
+#include "audealize_dsp.h"
+
+#include "effects/Equalizer.cpp"
+
+#include "headless/DescriptorSet.cpp"
+#include "headless/EffectChain.cpp"
+
+#include "utils/Biquad.cpp"
+#include "utils/DescriptorBasis.cpp"
+#include "utils/MemoryUsage.cpp"
@@ -0,0 +1,69 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+    The DSP core of the Audealize module: the effects, the filter and delay primitives they are built from, and
+    access to the descriptor data. It depends on juce_core only, so it can be built without the GUI, audio device
+    and plugin client modules, as the AudealizeDSP static library does for headless hosts.
+
+    audealize_module.h includes this header, and audealize_module.cpp compiles audealize_dsp.cpp, so plugin
+    projects need nothing extra. Projects that only want the DSP core compile audealize_dsp.cpp on its own, with an
+    AppConfig.h that enables juce_core.
+*/
+
+#ifndef AUDEALIZE_DSP
+#define AUDEALIZE_DSP
+
+#include <vector>
+#include <math.h>
+#include <functional>
+#include <map>
+#include <memory>
+
+#include "../juce_core/juce_core.h"
+
+using namespace juce;
+
+#include "utils/json.hpp"
+#include "utils/calf_dsp_library/delay.h"
+
+#include "utils/PrimeFactors.h"
+#include "utils/Biquad.h"
+#include "utils/MemoryUsage.h"
+#include "utils/DescriptorBasis.h"
+
+#include "effects/AudioEffect.h"
+#include "effects/NChannelFilter.h"
+#include "effects/BlockStateSpace.h"
+#include "effects/Equalizer.h"
+#include "effects/DelayLine.h"
+#include "effects/Reverb.h"
+#include "effects/BiquadCascade.h"
+#include "effects/LaneBatch.h"
+
+#include "headless/DescriptorSet.h"
+#include "headless/EffectChain.h"
+#include "headless/StreamRingBuffer.h"
+#include "headless/ControlQueue.h"
+
+#endif  // AUDEALIZE_DSP
@@ -36,6 +36,7 @@
 #include "audealize_module.h"
 
 #include "LookAndFeel/LookAndFeel.cpp"
+#include "LookAndFeel/UIResources.cpp"
 
 #include "resources/AudealizeImages.cpp"
 #include "resources/Fonts.cpp"
@@ -51,5 +52,14 @@
 #include "audio_processors/AudealizeEQAudioProcessor.cpp"
 #include "audio_processors/AudealizeReverbAudioProcessor.cpp"
 
-#include "utils/Biquad.cpp"
-#include "utils/properties.cpp"
\ No newline at end of file
+#include "analysis/InputAnalyser.cpp"
+
+#include "audealize_dsp.cpp"
+
+#include "offline/OfflineRenderer.cpp"
+#include "offline/PreviewEngine.cpp"
+
+#include "utils/properties.cpp"
+#include "utils/QualityGovernor.cpp"
+#include "utils/WorkerPool.cpp"
+#include "utils/SmoothingManager.cpp"
\ No newline at end of file
@@ -44,31 +44,41 @@
 #include <math.h>
 #include <fstream>
 #include <functional>
+#include <list>
+#include <map>
+#include <deque>
+#include <memory>
 
 #include "wn.h"
 
 #include "../juce_core/juce_core.h"
 #include "../juce_audio_basics/juce_audio_basics.h"
+#include "../juce_audio_formats/juce_audio_formats.h"
 #include "../juce_audio_processors/juce_audio_processors.h"
 #include "../juce_graphics/juce_graphics.h"
 #include "../juce_gui_basics/juce_gui_basics.h"
 #include "../juce_gui_extra/juce_gui_extra.h"
 
+#include "audealize_dsp.h"
+
 #include "LookAndFeel/LookAndFeel.h"
 
 #include "resources/AudealizeImages.h"
 #include "resources/Fonts.h"
 
-#include "utils/json.hpp"
-#include "utils/calf_dsp_library/delay.h"
-
-#include "utils/PrimeFactors.h"
-
-#include "utils/Biquad.h"
-#include "utils/json.hpp"
+#include "LookAndFeel/UIResources.h"
 
 #include "utils/FreqToText.h"
 #include "utils/properties.h"
+#include "utils/InputCapture.h"
+#include "utils/AuditionPlayer.h"
+#include "utils/QualityGovernor.h"
+#include "utils/DescriptorInterpolator.h"
+#include "utils/WorkerPool.h"
+#include "utils/SmoothingManager.h"
+
+#include "analysis/InputAnalyser.h"
+#include "analysis/DescriptorSuggester.h"
 
 #include "ui_components/AudealizeUI.h"
 #include "ui_components/WordMap.h"
@@ -83,10 +93,10 @@
 #include "ui_components/RotarySliderCentered.h"
 #include "ui_components/BypassButton.h"
 
-#include "effects/AudioEffect.h"
-#include "effects/NChannelFilter.h"
-#include "effects/Equalizer.h"
-#include "effects/Reverb.h"
+#include "effects/EngineSwitcher.h"
+
+#include "offline/OfflineRenderer.h"
+#include "offline/PreviewEngine.h"
 
 #include "audio_processors/AudealizeAudioProcessor.h"
 #include "audio_processors/AudealizeEQAudioProcessor.h"
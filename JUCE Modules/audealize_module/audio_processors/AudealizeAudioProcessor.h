@@ -35,7 +35,7 @@ class AudealizeAudioProcessor : public juce::AudioProcessor, public AudioProcess
 public:
     int lastUIWidth, lastUIHeight;
 
-    AudealizeAudioProcessor (AudealizeAudioProcessor* owner = nullptr) : mParamSettings (0)
+    AudealizeAudioProcessor (AudealizeAudioProcessor* owner = nullptr) : mParamSettings (0), mIsLaterSubBlock (false), mEditorReporter (nullptr)
     {
         if (owner == nullptr)
         {
@@ -105,9 +105,170 @@ public:
     /**
      *  Set the states of all parameters with a vector<float>. To be called by a WordMap
      *
-     *  @param settings a vector of floats
+     *  @param settings  a vector of floats
+     *  @param crossfade true to crossfade to the settings, for a jump such as selecting a descriptor. false to let the
+     *                   parameters smooth towards them, for the stream of small changes of a drag across the map
      */
-    virtual void settingsFromMap (vector<float> settings){};
+    virtual void settingsFromMap (vector<float> settings, bool crossfade){};
+
+    /**
+     *  Maps a descriptor's settings to the normalised parameter values settingsFromMap would set, ignoring the
+     *  amount. Descriptors can then be compared with getCurrentMapSettings ()
+     *
+     *  @param settings a vector of floats, as passed to settingsFromMap
+     */
+    virtual vector<float> normaliseMapSettings (const vector<float>& settings)
+    {
+        return vector<float> ();
+    }
+
+    /**
+     *  Returns the current parameter values in the same space as normaliseMapSettings, or an empty vector if
+     *  they can't be compared with any descriptor (e.g. a flat EQ curve)
+     */
+    virtual vector<float> getCurrentMapSettings ()
+    {
+        return vector<float> ();
+    }
+
+    /**
+     *  Sets a group of parameters as one update: change gestures are begun for all of them before any value is set,
+     *  and parameters whose value hasn't changed are skipped. Used by settingsFromMap, which may be called for every
+     *  mouse event of a drag across the WordMap
+     *
+     *  @param values normalised values for the parameters getParamID (0) ... getParamID (values.size () - 1)
+     */
+    void setParametersNotifyingHost (const vector<float>& values)
+    {
+        Array<AudioProcessorParameter*> changed;
+        Array<float> newValues;
+
+        for (int i = 0; i < values.size (); i++)
+        {
+            AudioProcessorParameter* param = mState->getParameter (getParamID (i));
+            if (param != nullptr && param->getValue () != values[i])
+            {
+                changed.add (param);
+                newValues.add (values[i]);
+            }
+        }
+
+        for (int i = 0; i < changed.size (); i++)
+        {
+            changed[i]->beginChangeGesture ();
+        }
+        for (int i = 0; i < changed.size (); i++)
+        {
+            changed[i]->setValueNotifyingHost (newValues[i]);
+        }
+        for (int i = 0; i < changed.size (); i++)
+        {
+            changed[i]->endChangeGesture ();
+        }
+    }
+
+    /**
+     *  Processes mono audio through a private instance of the effect configured with a descriptor's settings, the
+     *  way settingsFromMap would configure the processor. Doesn't touch the processor's parameters or processing
+     *  state, so it can be called from any thread. Used to render previews
+     *
+     *  @param settings   a vector of floats, as passed to settingsFromMap
+     *  @param buffer     audio to process (first channel only)
+     *  @param sampleRate sample rate of the audio
+     */
+    virtual void renderPreview (const vector<float>& settings, AudioSampleBuffer& buffer, double sampleRate){};
+
+    /**
+     *  Returns the buffer holding the last few seconds of the processor's input
+     */
+    InputCapture& getInputCapture ()
+    {
+        return mInputCapture;
+    }
+
+    /**
+     *  Returns the analyser following this processor's input, or nullptr if the effect doesn't suggest descriptors
+     */
+    virtual InputAnalyser* getInputAnalyser ()
+    {
+        return nullptr;
+    }
+
+    /**
+     *  Returns the player that replaces the processor's output while a preview is being auditioned
+     */
+    AuditionPlayer& getAuditionPlayer ()
+    {
+        return mAuditionPlayer;
+    }
+
+    /**
+     *  Returns an estimate of the memory used by this processor, its effect and its editor, by category. Call from the
+     *  message thread
+     */
+    MemoryUsage getMemoryUsage ()
+    {
+        MemoryUsage usage;
+        addMemoryUsage (usage);
+        return usage;
+    }
+
+    /**
+     *  Adds the memory used by this processor and its editor to a MemoryUsage. Parameter state shared with an owner
+     *  processor is only counted by the owner. Processors that own an effect or other processors override this to add
+     *  theirs, after calling the base class version
+     *
+     *  @param usage The MemoryUsage to add to
+     */
+    virtual void addMemoryUsage (MemoryUsage& usage)
+    {
+        if (mOwner == this)
+        {
+            // the undo manager measures its history in the size of its actions, which for ValueTree changes is bytes
+            usage.parameterState += MemoryUsage::sizeOf (mState->state) +
+                                    (size_t) mUndoManager->getNumberOfUnitsTakenUpByStoredCommands ();
+        }
+
+        usage.dspState += MemoryUsage::sizeOf (mParamSettings);
+        usage.delayMemory += mInputCapture.getSizeInBytes ();
+
+        if (mEditorReporter != nullptr)
+        {
+            mEditorReporter->addMemoryUsage (usage);
+        }
+    }
+
+    /**
+     *  Returns how many times per second of audio processBlock has recently been updating effect parameters, each of
+     *  which usually means a filter redesign. Zero once the parameters have settled. Processors that own other
+     *  processors return the sum of theirs
+     */
+    virtual float getParameterUpdatesPerSecond ()
+    {
+        return 0.0f;
+    }
+
+    /**
+     *  Marks the following processBlock calls as the first or a later sub-block of a host block that is processed in
+     *  parts, as the pipelined offline render does. Parameter smoothing only advances on the first, so ramps take as
+     *  long as they would if the block were processed whole. Call from the thread that calls processBlock
+     *
+     *  @param isLaterSubBlock true for every sub-block but the first, false for the first or a whole block
+     */
+    void setLaterSubBlock (bool isLaterSubBlock)
+    {
+        mIsLaterSubBlock = isLaterSubBlock;
+    }
+
+    /**
+     *  Sets the editor whose caches getMemoryUsage counts. Called by AudealizeUI when it is created and deleted
+     *
+     *  @param editor The editor, or nullptr
+     */
+    void setEditorMemoryReporter (MemoryUsage::Reporter* editor)
+    {
+        mEditorReporter = editor;
+    }
 
     /**
      *  Returns the AudioProcessorValueTreeState
@@ -206,7 +367,39 @@ public:
         return true;
     }
 
+    /**
+     *  Returns true while the host is rendering offline, e.g. bouncing a mixdown. Processors owned by another processor
+     *  follow their owner, which is the one the host sets this on
+     */
+    bool isRenderingOffline () const
+    {
+        return mOwner->isNonRealtime ();
+    }
+
 protected:
+    /**
+     *  Returns the quality tier processBlock should run at. @see QualityGovernor::Tier. Offline renders always run at
+     *  kTierFull: there is no callback deadline to keep, and a bounce shouldn't depend on how busy the machine was
+     */
+    int getQualityTier () const
+    {
+        return isRenderingOffline () ? (int) QualityGovernor::kTierFull : mQualityClient.getQualityTier ();
+    }
+
+    /**
+     *  Reports a processed block to the QualityGovernor. Offline blocks aren't reported, since they run as fast as the
+     *  machine allows rather than against a deadline and would lower the tier of every other instance
+     *
+     *  @param numSamples Number of samples in the block
+     */
+    void endQualityBlock (int numSamples)
+    {
+        if (!isRenderingOffline ())
+        {
+            mQualityClient.endBlock (numSamples, getSampleRate ());
+        }
+    }
+
     AudioProcessorValueTreeState* mState;  // and AudioProcessorValueTreeState containing the parameter state
                                            // information
     UndoManager* mUndoManager;
@@ -220,6 +413,15 @@ protected:
 
     float mAmount;  // value in range [0,1]. dictates the amount of the effect to be applied.
 
+    bool mIsLaterSubBlock;  // set by setLaterSubBlock. only touched by the thread calling processBlock
+
+    InputCapture mInputCapture;      // recent input, for rendering previews
+    AuditionPlayer mAuditionPlayer;  // plays previews in place of the processor's output
+
+    QualityGovernor::Client mQualityClient;  // measures processBlock's load and says which quality tier to run at
+
+    MemoryUsage::Reporter* mEditorReporter;  // the open AudealizeUI, if any. only touched by the message thread
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudealizeAudioProcessor);
 };
 }  // namespace audealize
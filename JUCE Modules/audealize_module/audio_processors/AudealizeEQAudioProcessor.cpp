@@ -21,10 +21,16 @@
  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
-#include "AudealizeeqAudioProcessor.h"
+#include "AudealizeEQAudioProcessor.h"
+
+static const double eqSmoothingSeconds = 0.00019;  // ramp length of the band gain smoothing
+static const double eqSwitchSeconds = 0.01;        // crossfade length when switching to a descriptor
 
 AudealizeeqAudioProcessor::AudealizeeqAudioProcessor (AudealizeAudioProcessor* owner)
-    : AudealizeAudioProcessor (owner), mEqualizer (mFreqs, 0.0f)
+    : AudealizeAudioProcessor (owner),
+      mSmoothing (NUMBANDS),
+      mEqualizers (new Equalizer (mFreqs, 0.0f), new Equalizer (mFreqs, 0.0f)),
+      mInputAnalyser (mFreqs)
 {
     paramAmountId = "paramAmountEQ";
     paramBypassId = "paramBypassEQ";
@@ -32,7 +38,7 @@ AudealizeeqAudioProcessor::AudealizeeqAudioProcessor (AudealizeAudioProcessor* o
     // DBG(std::to_string(getSampleRate()));
     mParamSettings.resize (NUMBANDS, 0);
 
-    mGainRange = NormalisableRange<float> (-4.30f, 4.30f, 0.001f);
+    mGainRange = EffectChain::getBandGainRange ();
 
     // Create amount parameter
 
@@ -118,12 +124,19 @@ void AudealizeeqAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    mEqualizer.setSampleRate (sampleRate);
+    mEqualizers.forEach ([sampleRate] (Equalizer& eq) {
+        eq.setSampleRate (sampleRate);
 
-    for (int i = 0; i < NUMBANDS; i++)
-    {
-        mSmoothedVals[i].reset (sampleRate, 0.00019);
-    }
+        // channels are filtered one after the other: the block kernel is the only SIMD parallelism a mono track gets
+        eq.setKernel (Equalizer::kKernelBlockStateSpace);
+    });
+    mEqualizers.prepare (2, samplesPerBlock, (int) (eqSwitchSeconds * sampleRate),
+                         EngineSwitcher<Equalizer>::kFadeEqualGain);
+
+    mInputCapture.prepare (sampleRate, 4.0);
+    mInputAnalyser.prepare (sampleRate);
+
+    mSmoothing.reset (sampleRate, eqSmoothingSeconds);
 }
 
 void AudealizeeqAudioProcessor::releaseResources ()
@@ -160,20 +173,35 @@ void AudealizeeqAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuf
 
     const int numSamples = buffer.getNumSamples ();
 
-    // Parameter smoothing
-    // look through filters
-    for (int i = 0; i < NUMBANDS; i++)
-    {
-        float diff = fabs (mEqualizer.getBandGain (i) - mSmoothedVals[i].getTargetValue ());
+    mQualityClient.beginBlock ();
 
-        // if current value is not within acceptable margin of target value, continue smoothing
-        if (diff > 0.01f * mSmoothedVals[i].getTargetValue ())
-        {
-            String paramID = getParamID (i);
+    mInputCapture.push (buffer, totalNumInputChannels);
+    mInputAnalyser.pushSamples (buffer, totalNumInputChannels);
 
-            float gain = mSmoothedVals[i].getNextValue ();
-            mEqualizer.setBandGain (i, gain * mAmount);
-        }
+    Equalizer& equalizer = mEqualizers.getActive ();
+
+    // Parameter smoothing. Held off while switching to a descriptor: the idle instance is being set to the new
+    // curve and will be crossfaded to instead
+    if (!mEqualizers.isSwitching ())
+    {
+        const float amount = mAmount;
+        mSmoothing.process (numSamples, [&equalizer, amount] (int band, float gain) {
+            equalizer.setBandGain (band, gain * amount);
+        }, !mIsLaterSubBlock);
+    }
+
+    // trade accuracy for CPU while the session is overloaded
+    switch (getQualityTier ())
+    {
+        case QualityGovernor::kTierFull:
+            equalizer.setQuality (Equalizer::kQualityFull);
+            break;
+        case QualityGovernor::kTierReduced:
+            equalizer.setQuality (Equalizer::kQualitySkipFlatBands);
+            break;
+        default:
+            equalizer.setQuality (Equalizer::kQualityReducedSections);
+            break;
     }
 
     // This is the place where you'd normally do the guts of your plugin's
@@ -181,11 +209,22 @@ void AudealizeeqAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuf
 
     if (mState->getParameter (paramBypassId)->getValue () == 1)
     {
-        for (int channel = 0; channel < totalNumInputChannels; ++channel)
+        const bool switched = mEqualizers.process (
+            buffer.getArrayOfWritePointers (), totalNumInputChannels, numSamples,
+            [] (Equalizer& eq, float* const* channels, int numChannels, int numChannelSamples) {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    eq.processBlock (channels[channel], numChannelSamples, channel);
+                }
+            });
+
+        if (switched)
         {
-            float* channelData = buffer.getWritePointer (channel);
-
-            mEqualizer.processBlock (channelData, numSamples, channel);
+            const vector<float>& bandGains = mEqualizers.getActiveSettings ();
+            for (int i = 0; i < bandGains.size (); i++)
+            {
+                mSmoothing.setCurrentValue (i, bandGains[i]);
+            }
         }
     }
 
@@ -193,6 +232,11 @@ void AudealizeeqAudioProcessor::processBlock (AudioSampleBuffer& buffer, MidiBuf
     // channels that didn't contain input data, (because these aren't
     // guaranteed to be empty - they may contain garbage).
     for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i) buffer.clear (i, 0, buffer.getNumSamples ());
+
+    // while a descriptor preview is being auditioned, it replaces the output
+    mAuditionPlayer.process (buffer, totalNumOutputChannels);
+
+    endQualityBlock (numSamples);
 }
 
 bool AudealizeeqAudioProcessor::hasEditor () const
@@ -238,11 +282,13 @@ void AudealizeeqAudioProcessor::parameterChanged (const juce::String& parameterI
     {
         int idx = parameterID.substring (9).getIntValue ();
 
-        mSmoothedVals[idx].setValue (newValue);
+        mSmoothing.setTargetValue (idx, newValue);
     }
     else if (parameterID.equalsIgnoreCase (paramAmountId))
     {
         mAmount = newValue;
+        mSmoothing.reapplyAll ();
+
         float gain;
         for (int i = 0; i < NUMBANDS; i++)
         {
@@ -262,11 +308,12 @@ void AudealizeeqAudioProcessor::parameterChanged (const juce::String& parameterI
     }
 }
 
-void AudealizeeqAudioProcessor::settingsFromMap (vector<float> settings)
+void AudealizeeqAudioProcessor::settingsFromMap (vector<float> settings, bool crossfade)
 {
     mParamSettings = settings;
     normalize (&mParamSettings);
 
+    vector<float> gains (NUMBANDS);
     float gain;
     for (int i = 0; i < NUMBANDS; i++)
     {
@@ -275,14 +322,81 @@ void AudealizeeqAudioProcessor::settingsFromMap (vector<float> settings)
         gain = mGainRange.convertFrom0to1 (gain);
         gain *= mAmount;
         gain = mGainRange.convertTo0to1 (gain);
-        mState->getParameter (getParamID (i))->beginChangeGesture ();
-        mState->getParameter (getParamID (i))->setValueNotifyingHost (gain);
-        mState->getParameter (getParamID (i))->endChangeGesture ();
+        gains[i] = gain;
     }
 
+    // set the idle Equalizer to the new curve off the audio thread and crossfade to it, rather than smoothing every
+    // band of the running one. otherwise the parameter changes below are smoothed as usual
+    if (crossfade)
+    {
+        vector<float> bandGains (NUMBANDS);
+        for (int i = 0; i < NUMBANDS; i++)
+        {
+            bandGains[i] = mGainRange.snapToLegalValue (mGainRange.convertFrom0to1 (gains[i]));
+        }
+
+        const float amount = mAmount;
+        mEqualizers.requestSwitch (
+            [bandGains, amount] (Equalizer& eq) {
+                for (int i = 0; i < NUMBANDS; i++)
+                {
+                    eq.setBandGain (i, bandGains[i] * amount);  // as processBlock applies the smoothed gains
+                }
+            },
+            bandGains);
+    }
+
+    setParametersNotifyingHost (gains);
+
     // DBG(mEqualizer.getBandGain(10));
 }
 
+void AudealizeeqAudioProcessor::renderPreview (const vector<float>& settings, AudioSampleBuffer& buffer,
+                                               double sampleRate)
+{
+    Equalizer eq (mFreqs, sampleRate);
+
+    // same gains processBlock ends up applying after settingsFromMap
+    EffectChain::configureEqualizer (eq, settings, mAmount);
+
+    eq.processBlock (buffer.getWritePointer (0), buffer.getNumSamples (), 0);
+}
+
+vector<float> AudealizeeqAudioProcessor::normaliseMapSettings (const vector<float>& settings)
+{
+    // the curve's shape is what matters: settingsFromMap normalizes the settings, and scaling by the amount doesn't
+    // change the normalized curve
+    vector<float> normalized = settings;
+    if (*std::max_element (normalized.begin (), normalized.end ()) ==
+        *std::min_element (normalized.begin (), normalized.end ()))
+    {
+        return vector<float> ();
+    }
+
+    normalize (&normalized);
+    return normalized;
+}
+
+vector<float> AudealizeeqAudioProcessor::getCurrentMapSettings ()
+{
+    vector<float> gains (NUMBANDS);
+    for (int i = 0; i < NUMBANDS; i++)
+    {
+        gains[i] = mState->getParameter (getParamID (i))->getValue ();
+    }
+
+    return normaliseMapSettings (gains);
+}
+
+void AudealizeeqAudioProcessor::addMemoryUsage (MemoryUsage& usage)
+{
+    AudealizeAudioProcessor::addMemoryUsage (usage);
+
+    mEqualizers.forEach ([&usage] (Equalizer& eq) { eq.addMemoryUsage (usage); });
+    usage.dspState += mEqualizers.getSizeInBytes () + mSmoothing.getSizeInBytes ();
+    usage.dspState += mInputAnalyser.getSizeInBytes () + MemoryUsage::sizeOf (mFreqs);
+}
+
 inline String AudealizeeqAudioProcessor::getParamID (int index)
 {
     return String ("paramGain" + std::to_string (index));
@@ -63,23 +63,37 @@ public:
     void changeProgramName (int index, const String& newName) override;
 
     void parameterChanged (const juce::String& parameterID, float newValue) override;
-    void settingsFromMap (vector<float> settings) override;
+    void settingsFromMap (vector<float> settings, bool crossfade) override;
+    void renderPreview (const vector<float>& settings, AudioSampleBuffer& buffer, double sampleRate) override;
+    vector<float> normaliseMapSettings (const vector<float>& settings) override;
+    vector<float> getCurrentMapSettings () override;
+    void addMemoryUsage (MemoryUsage& usage) override;
+
+    float getParameterUpdatesPerSecond () override
+    {
+        return mSmoothing.getUpdatesPerSecond ();
+    }
 
     inline String getParamID (int index) override;
 
+    InputAnalyser* getInputAnalyser () override
+    {
+        return &mInputAnalyser;
+    }
+
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudealizeeqAudioProcessor)
 
     NormalisableRange<float> mGainRange;  // Range of the graphic eq gain sliders
 
-    LinearSmoothedValue<float> mSmoothedVals[NUMBANDS];
+    SmoothingManager mSmoothing;  // band gains, before the amount
+
+    std::vector<float> mFreqs = EffectChain::getBandFrequencies ();
 
-    std::vector<float> mFreqs = {20,   50,   83,   120,  161,   208,   259,   318,   383,   455,
-                                 537,  628,  729,  843,  971,   1114,  1273,  1452,  1652,  1875,
-                                 2126, 2406, 2719, 3070, 3462,  3901,  4392,  4941,  5556,  6244,
-                                 7014, 7875, 8839, 9917, 11124, 12474, 13984, 15675, 17566, 19682};
+    EngineSwitcher<Equalizer> mEqualizers;  // descriptor changes are crossfaded to the idle instance. each instance
+                                            // keeps the band gains, before the amount, it was configured with
 
-    Equalizer mEqualizer;
+    InputAnalyser mInputAnalyser;  // long-term analysis of the input, for suggesting descriptors
 };
 }
 #endif  // AUDEALIZEEQAUDIOPROCESSOR_H_INCLUDED
@@ -25,6 +25,9 @@
 
 using namespace Audealize;
 
+static const double reverbSmoothingSeconds = 0.0001;  // ramp length of the parameter smoothing
+static const double reverbSwitchSeconds = 0.01;       // crossfade length when switching to a descriptor
+
 String AudealizereverbAudioProcessor::paramD ("paramD");
 String AudealizereverbAudioProcessor::paramG ("paramG");
 String AudealizereverbAudioProcessor::paramM ("paramM");
@@ -32,16 +35,26 @@ String AudealizereverbAudioProcessor::paramF ("paramF");
 String AudealizereverbAudioProcessor::paramE ("paramE");
 
 AudealizereverbAudioProcessor::AudealizereverbAudioProcessor (AudealizeAudioProcessor* owner)
-    : AudealizeAudioProcessor (owner), mReverb ()
+    : AudealizeAudioProcessor (owner),
+      mReverbs (new Audealize::Reverb (), new Audealize::Reverb ()),
+      mSmoothing (kNumParams),
+      mLineFormat (DelayLine::kFormatFloat32)
 {
+
+    mSmoothing.setTargetValue (kParamD, DEFAULT_D);
+    mSmoothing.setTargetValue (kParamG, DEFAULT_G);
+    mSmoothing.setTargetValue (kParamM, DEFAULT_M);
+    mSmoothing.setTargetValue (kParamF, DEFAULT_F);
+    mSmoothing.setTargetValue (kParamE, DEFAULT_E);
+    mSmoothing.setTargetValue (kParamAmount, DEFAULT_MIX);
+
     paramAmountId = "paramAmountReverb";  // important for multi effect plugin
 
     // initialize parameter ranges
-    mParamRange[kParamD] = NormalisableRange<float> (0.01f, 0.1f, 0.0001f);
-    mParamRange[kParamG] = NormalisableRange<float> (0.01f, 0.96f, 0.0001f);
-    mParamRange[kParamM] = NormalisableRange<float> (-0.012f, 0.012f, 0.00001f);
-    mParamRange[kParamF] = NormalisableRange<float> (20.0f, 20000.0f, 0.1f);
-    mParamRange[kParamE] = NormalisableRange<float> (0.0f, 1.0f, 0.0001f);
+    for (int i = 0; i < kNumParams - 1; i++)
+    {
+        mParamRange[i] = EffectChain::getReverbParamRange (i);
+    }
 
     // Initialize parameters
     String prefix = (mOwner == this ? "" : "Reverb: ");
@@ -131,25 +144,34 @@ void AudealizereverbAudioProcessor::changeProgramName (int index, const String&
 
 void AudealizereverbAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Initialize reverberator
-    mReverb.init (mParamRange[kParamD].snapToLegalValue (DEFAULT_D), mParamRange[kParamG].snapToLegalValue (DEFAULT_G),
-                  mParamRange[kParamM].snapToLegalValue (DEFAULT_M), mParamRange[kParamF].snapToLegalValue (DEFAULT_F),
-                  mParamRange[kParamE].snapToLegalValue (DEFAULT_E),
-                  mParamRange[kParamAmount].snapToLegalValue (DEFAULT_MIX), sampleRate);
+    // Initialize reverberators
+    mReverbs.forEach ([this, sampleRate] (Audealize::Reverb& reverb) {
+        reverb.setLineFormat (mLineFormat);
+        reverb.init (mParamRange[kParamD].snapToLegalValue (DEFAULT_D),
+                     mParamRange[kParamG].snapToLegalValue (DEFAULT_G),
+                     mParamRange[kParamM].snapToLegalValue (DEFAULT_M),
+                     mParamRange[kParamF].snapToLegalValue (DEFAULT_F),
+                     mParamRange[kParamE].snapToLegalValue (DEFAULT_E),
+                     mParamRange[kParamAmount].snapToLegalValue (DEFAULT_MIX), sampleRate);
+    });
+    // both instances carry the same dry signal and, after copyStateFrom, the same tail, so their outputs are
+    // correlated enough for an equal-power fade to swell by a couple of dB
+    mReverbs.prepare (2, samplesPerBlock, (int) (reverbSwitchSeconds * sampleRate),
+                      EngineSwitcher<Audealize::Reverb>::kFadeEqualGain);
     // debugParams();
 
-    // Initialize parameter smoothers
-    for (int i = 0; i < kNumParams; i++)
-    {
-        mSmoothedVals[i].reset (sampleRate, 0.0001);
-    }
+    mInputCapture.prepare (sampleRate, 4.0);
+
+    // Initialize parameter smoothing. The reverberators now run at the defaults, and are ramped from there to
+    // the parameters' values
+    mSmoothing.reset (sampleRate, reverbSmoothingSeconds);
 
-    mSmoothedVals[kParamD].setValue (DEFAULT_D);
-    mSmoothedVals[kParamG].setValue (DEFAULT_G);
-    mSmoothedVals[kParamM].setValue (DEFAULT_M);
-    mSmoothedVals[kParamF].setValue (DEFAULT_F);
-    mSmoothedVals[kParamE].setValue (DEFAULT_E);
-    mSmoothedVals[kParamAmount].setValue (DEFAULT_MIX);
+    mSmoothing.setCurrentValue (kParamD, DEFAULT_D);
+    mSmoothing.setCurrentValue (kParamG, DEFAULT_G);
+    mSmoothing.setCurrentValue (kParamM, DEFAULT_M);
+    mSmoothing.setCurrentValue (kParamF, DEFAULT_F);
+    mSmoothing.setCurrentValue (kParamE, DEFAULT_E);
+    mSmoothing.setCurrentValue (kParamAmount, DEFAULT_MIX);
 }
 
 void AudealizereverbAudioProcessor::releaseResources ()
@@ -183,6 +205,8 @@ void AudealizereverbAudioProcessor::processBlock (AudioSampleBuffer& buffer, Mid
     const int totalNumInputChannels = getTotalNumInputChannels ();
     const int totalNumOutputChannels = getTotalNumOutputChannels ();
 
+    mQualityClient.beginBlock ();
+
     // In case we have more outputs than inputs, this code clears any output
     // channels that didn't contain input data, (because these aren't
     // guaranteed to be empty - they may contain garbage).
@@ -191,63 +215,85 @@ void AudealizereverbAudioProcessor::processBlock (AudioSampleBuffer& buffer, Mid
     // this code if your algorithm always overwrites all the output channels.
     for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i) buffer.clear (i, 0, buffer.getNumSamples ());
 
-    // Parameter smoothing
-    float diff;
-
-    diff = fabs (mReverb.get_d () - mSmoothedVals[kParamD].getTargetValue ());
-    if (diff > 0.01f * mSmoothedVals[kParamD].getTargetValue ())
-    {
-        mReverb.set_d (mSmoothedVals[kParamD].getNextValue ());
-    }
+    mInputCapture.push (buffer, totalNumInputChannels);
 
-    diff = fabs (mReverb.get_g () - mSmoothedVals[kParamG].getTargetValue ());
-    if (diff > 0.01f * mSmoothedVals[kParamG].getTargetValue ())
-    {
-        mReverb.set_g (mSmoothedVals[kParamG].getNextValue ());
-    }
+    Audealize::Reverb& reverb = mReverbs.getActive ();
 
-    diff = fabs (mReverb.get_m () - mSmoothedVals[kParamM].getTargetValue ());
-    if (diff > 0.01f * mSmoothedVals[kParamM].getTargetValue ())
+    // Parameter smoothing. Held off while switching to a descriptor: the idle instance is being set to the new
+    // settings and will be crossfaded to instead
+    if (!mReverbs.isSwitching ())
     {
-        mReverb.set_m (mSmoothedVals[kParamM].getNextValue ());
-    }
-
-    diff = fabs (mReverb.get_f () - mSmoothedVals[kParamF].getTargetValue ());
-    if (diff > 0.01f * mSmoothedVals[kParamF].getTargetValue ())
-    {
-        mReverb.set_f (mSmoothedVals[kParamF].getNextValue ());
-    }
-
-    diff = fabs (mReverb.get_E () - mSmoothedVals[kParamE].getTargetValue ());
-    if (diff > 0.01f * mSmoothedVals[kParamE].getTargetValue ())
-    {
-        mReverb.set_E (mSmoothedVals[kParamE].getNextValue ());
+        mSmoothing.process (buffer.getNumSamples (), [&reverb] (int param, float value) {
+            switch (param)
+            {
+                case kParamD:
+                    reverb.set_d (value);
+                    break;
+                case kParamG:
+                    reverb.set_g (value);
+                    break;
+                case kParamM:
+                    reverb.set_m (value);
+                    break;
+                case kParamF:
+                    reverb.set_f (value);
+                    break;
+                case kParamE:
+                    reverb.set_E (value);
+                    break;
+                default:
+                    reverb.set_wetdry (value);
+                    break;
+            }
+        }, !mIsLaterSubBlock);
     }
+    // end parameter smoothing
 
-    diff = fabs (mReverb.get_wetdry () - mSmoothedVals[kParamAmount].getTargetValue ());
-    if (diff > 0.01f * mSmoothedVals[kParamAmount].getTargetValue ())
+    // trade accuracy for CPU while the session is overloaded. the lowpass usually keeps the reverb well below a
+    // quarter of the sample rate, so running the network at half rate is rarely audible
+    switch (getQualityTier ())
     {
-        mReverb.set_wetdry (mSmoothedVals[kParamAmount].getNextValue ());
+        case QualityGovernor::kTierFull:
+            reverb.setQuality (false, 6);
+            break;
+        case QualityGovernor::kTierReduced:
+            reverb.setQuality (true, 6);
+            break;
+        default:
+            reverb.setQuality (true, 3);
+            break;
     }
-    // end parameter smoothing
 
     // Process reverb
     if (mState->getParameter (paramBypassId)->getValue () == 1)
     {
-        if (totalNumInputChannels == 1)
-        {
-            float* channelData = buffer.getWritePointer (0);
-
-            mReverb.processMonoBlock (channelData, buffer.getNumSamples ());
-        }
-        else
+        const bool switched = mReverbs.process (
+            buffer.getArrayOfWritePointers (), jmin (totalNumInputChannels, 2), buffer.getNumSamples (),
+            [] (Audealize::Reverb& r, float* const* channels, int numChannels, int numSamples) {
+                if (numChannels == 1)
+                {
+                    r.processMonoBlock (channels[0], numSamples);
+                }
+                else
+                {
+                    r.processStereoBlock (channels[0], channels[1], numSamples);
+                }
+            });
+
+        if (switched)
         {
-            float* channelData1 = buffer.getWritePointer (0);
-            float* channelData2 = buffer.getWritePointer (1);
-
-            mReverb.processStereoBlock (channelData1, channelData2, buffer.getNumSamples ());
+            const vector<float>& values = mReverbs.getActiveSettings ();
+            for (int i = 0; i < values.size (); i++)
+            {
+                mSmoothing.setCurrentValue (i, values[i]);
+            }
         }
     }
+
+    // while a descriptor preview is being auditioned, it replaces the output
+    mAuditionPlayer.process (buffer, totalNumOutputChannels);
+
+    endQualityBlock (buffer.getNumSamples ());
 }
 
 bool AudealizereverbAudioProcessor::hasEditor () const
@@ -295,16 +341,17 @@ void AudealizereverbAudioProcessor::parameterChanged (const juce::String& parame
     {
         // DBG("param changed :" << parameterID << newValue);
         int idx = getParamIdx (parameterID);
-        mSmoothedVals[idx].setValue (newValue);
-        // DBG(mSmoothedVals[idx].getTargetValue());
+        mSmoothing.setTargetValue (idx, newValue);
+        // DBG(mSmoothing.getTargetValue (idx));
         // debugParams();
     }
 }
 
 void AudealizereverbAudioProcessor::debugParams ()
 {
-    DBG ("\nREVERB: d: " << mReverb.get_d () << " g: " << mReverb.get_g () << " m: " << mReverb.get_m ()
-                         << " f: " << mReverb.get_f () << " E: " << mReverb.get_E ());
+    DBG ("\nREVERB: d: " << mReverbs.getActive ().get_d () << " g: " << mReverbs.getActive ().get_g ()
+                         << " m: " << mReverbs.getActive ().get_m () << " f: " << mReverbs.getActive ().get_f ()
+                         << " E: " << mReverbs.getActive ().get_E ());
     DBG ("PARAMS: d: " << mState->getParameter (paramD)->getValue ()
                        << " g: " << mState->getParameter (paramG)->getValue ()
                        << " m: " << mState->getParameter (paramM)->getValue ()
@@ -315,6 +362,36 @@ void AudealizereverbAudioProcessor::debugParams ()
 /**
  *  Transaltes a parameter index to its corresponding ID string
  */
+vector<float> AudealizereverbAudioProcessor::normaliseMapSettings (const vector<float>& settings)
+{
+    vector<float> values (kNumParams - 1);
+    for (int i = 0; i < kNumParams - 1; i++)
+    {
+        values[i] = mParamRange[i].convertTo0to1 (mParamRange[i].snapToLegalValue (settings[i]));
+    }
+
+    return values;
+}
+
+vector<float> AudealizereverbAudioProcessor::getCurrentMapSettings ()
+{
+    vector<float> values (kNumParams - 1);
+    for (int i = 0; i < kNumParams - 1; i++)
+    {
+        values[i] = mState->getParameter (getParamID (i))->getValue ();
+    }
+
+    return values;
+}
+
+void AudealizereverbAudioProcessor::addMemoryUsage (MemoryUsage& usage)
+{
+    AudealizeAudioProcessor::addMemoryUsage (usage);
+
+    mReverbs.forEach ([&usage] (Audealize::Reverb& reverb) { reverb.addMemoryUsage (usage); });
+    usage.dspState += mReverbs.getSizeInBytes () + mSmoothing.getSizeInBytes ();
+}
+
 String AudealizereverbAudioProcessor::getParamID (int index)
 {
     switch (index)
@@ -370,17 +447,58 @@ int AudealizereverbAudioProcessor::getParamIdx (String paramId)
     }
 }
 
-void AudealizereverbAudioProcessor::settingsFromMap (vector<float> settings)
+void AudealizereverbAudioProcessor::settingsFromMap (vector<float> settings, bool crossfade)
 {
     mParamSettings = settings;
 
     // DBG("Raw: " << settings[0] << " " << settings[1] << " "<< settings[2] << " "<< settings[3] << " "<< settings[4]);
 
+    vector<float> values (kNumParams - 1);
     for (int i = 0; i < kNumParams - 1; i++)
     {
         // for some reason the F and M param ranges are [0,1] in the plugin
-        mState->getParameter (getParamID (i))->beginChangeGesture ();
-        mState->getParameter (getParamID (i))->setValueNotifyingHost (mParamRange[i].convertTo0to1 ((settings[i])));
-        mState->getParameter (getParamID (i))->endChangeGesture ();
+        values[i] = mParamRange[i].convertTo0to1 ((settings[i]));
+    }
+
+    // set the idle Reverb to the new settings off the audio thread and crossfade to it, rather than smoothing every
+    // parameter of the running one. Changing the comb delays of a running reverb is never quite smooth, but the small
+    // steps of a drag are smoothed as usual by the parameter changes below
+    if (crossfade)
+    {
+        vector<float> target (kNumParams);
+        for (int i = 0; i < kNumParams - 1; i++)
+        {
+            target[i] = mParamRange[i].snapToLegalValue (settings[i]);
+        }
+        target[kParamAmount] = mSmoothing.getTargetValue (kParamAmount);
+
+        mReverbs.requestSwitch (
+            [target] (Audealize::Reverb& reverb) {
+                reverb.set_d (target[kParamD]);
+                reverb.set_g (target[kParamG]);
+                reverb.set_m (target[kParamM]);
+                reverb.set_f (target[kParamF]);
+                reverb.set_E (target[kParamE]);
+                reverb.set_wetdry (target[kParamAmount]);
+            },
+            target);
+    }
+
+    setParametersNotifyingHost (values);
+}
+
+void AudealizereverbAudioProcessor::renderPreview (const vector<float>& settings, AudioSampleBuffer& buffer,
+                                                   double sampleRate)
+{
+    float values[kNumParams - 1];
+    for (int i = 0; i < kNumParams - 1; i++)
+    {
+        values[i] = mParamRange[i].snapToLegalValue (settings[i]);
     }
+
+    Audealize::Reverb reverb;
+    reverb.init (values[kParamD], values[kParamG], values[kParamM], values[kParamF], values[kParamE],
+                 mSmoothing.getTargetValue (kParamAmount), sampleRate);
+
+    reverb.processMonoBlock (buffer.getWritePointer (0), buffer.getNumSamples ());
 }
@@ -62,7 +62,25 @@ public:
 
     void parameterChanged (const juce::String& parameterID, float newValue) override;
 
-    void settingsFromMap (vector<float> settings) override;
+    void settingsFromMap (vector<float> settings, bool crossfade) override;
+    void renderPreview (const vector<float>& settings, AudioSampleBuffer& buffer, double sampleRate) override;
+    vector<float> normaliseMapSettings (const vector<float>& settings) override;
+    vector<float> getCurrentMapSettings () override;
+    void addMemoryUsage (MemoryUsage& usage) override;
+
+    float getParameterUpdatesPerSecond () override
+    {
+        return mSmoothing.getUpdatesPerSecond ();
+    }
+
+    /**
+     *  Sets how the reverberators' delay lines store their samples, @see Reverb::setLineFormat. Takes effect at the
+     *  next prepareToPlay
+     */
+    void setDelayLineFormat (DelayLine::Format format)
+    {
+        mLineFormat = format;
+    }
 
     inline String getParamID (int index) override;
 
@@ -94,11 +112,14 @@ public:
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudealizereverbAudioProcessor)
 
-    Audealize::Reverb mReverb;
+    EngineSwitcher<Audealize::Reverb> mReverbs;  // descriptor changes are crossfaded to the idle instance. each
+                                                 // instance keeps the parameter values it was configured with
 
     NormalisableRange<float> mParamRange[kNumParams];
 
-    LinearSmoothedValue<float> mSmoothedVals[kNumParams];
+    SmoothingManager mSmoothing;
+
+    DelayLine::Format mLineFormat;  // storage of the reverberators' delay lines
 
     const float DEFAULT_D = 0.05f;
     const float DEFAULT_G = 0.5f;
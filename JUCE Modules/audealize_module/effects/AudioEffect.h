@@ -87,6 +87,16 @@ public:
         return mSampleRate;
     }
 
+    /**
+     *  Adds the memory allocated by the effect (not including the size of the AudioEffect object itself) to a
+     *  MemoryUsage. Should be overriden by child classes that allocate
+     *
+     *  @param usage The MemoryUsage to add to
+     */
+    virtual void addMemoryUsage (MemoryUsage& usage)
+    {
+    }
+
 protected:
     float mSampleRate;
 };
@@ -0,0 +1,286 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef BiquadCascade_h
+#define BiquadCascade_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// A flat copy of one channel of an Equalizer's filter bank (coefficients + state) that can be run outside of the
+/// Equalizer. Used by the offline renderers to process independent pieces of a signal on separate threads.
+class BiquadCascade
+{
+public:
+    BiquadCascade () : mNumSections (0)
+    {
+    }
+
+    /**
+     *  Copies the coefficients and state of the sections one channel of an Equalizer currently runs: the bands (or
+     *  reduced sections) that haven't been dropped. Finishes any fades in the Equalizer first,
+     *  @see Equalizer::getActiveBiquads
+     *
+     *  @param eq         The Equalizer to copy
+     *  @param channelIdx Channel index
+     */
+    void loadFrom (Equalizer& eq, int channelIdx)
+    {
+        vector<Biquad*> biquads;
+        eq.getActiveBiquads (biquads, channelIdx);
+
+        mNumSections = biquads.size ();
+        mCoeffs.resize (mNumSections * 5);
+        mState.resize (mNumSections * 2);
+
+        for (int i = 0; i < mNumSections; i++)
+        {
+            biquads[i]->getCoefficients (&mCoeffs[i * 5]);
+            biquads[i]->getState (&mState[i * 2]);
+        }
+    }
+
+    /**
+     *  Writes the cascade's state back into one channel of an Equalizer
+     *
+     *  @param eq         The Equalizer to write to. Must still run the sections this cascade was loaded from
+     *  @param channelIdx Channel index
+     */
+    void storeStateTo (Equalizer& eq, int channelIdx) const
+    {
+        vector<Biquad*> biquads;
+        eq.getActiveBiquads (biquads, channelIdx);
+        jassert (biquads.size () == mNumSections);
+
+        for (int i = 0; i < mNumSections && i < biquads.size (); i++)
+        {
+            biquads[i]->setState (&mState[i * 2]);
+        }
+    }
+
+    /**
+     *  Returns the size of the state vector (2 per section)
+     */
+    int getStateSize () const
+    {
+        return mNumSections * 2;
+    }
+
+    /**
+     *  Returns a pointer to the state vector, laid out as {z1, z2} per section
+     */
+    double* getState ()
+    {
+        return mState.data ();
+    }
+
+    /**
+     *  Clears the state of every section
+     */
+    void reset ()
+    {
+        std::fill (mState.begin (), mState.end (), 0.0);
+    }
+
+    /**
+     *  Filters a block of samples in place. Produces the same output as the Equalizer it was loaded from, once that
+     *  has no fades in progress, including the rounding to float and undenormalising between sections
+     *
+     *  @param samples    Pointer to an array of audio samples
+     *  @param numSamples Number of samples
+     */
+    void process (float* samples, int numSamples)
+    {
+        const double* c = mCoeffs.data ();
+        double* z = mState.data ();
+
+        for (int n = 0; n < numSamples; n++)
+        {
+            float x = samples[n];
+            for (int i = 0; i < mNumSections; i++)
+            {
+                const double* k = c + i * 5;
+                double* s = z + i * 2;
+
+                double out = x * k[0] + s[0];
+                s[0] = x * k[1] + s[1] - k[3] * out;
+                s[1] = x * k[2] - k[4] * out;
+
+                float y = (float) out;
+                JUCE_UNDENORMALISE (y);
+                x = y;
+            }
+            samples[n] = x;
+        }
+    }
+
+    /**
+     *  Adds the response of the cascade to zero input, starting from a given state, to a block of samples. Stops
+     *  early once the state has decayed below threshold.
+     *
+     *  @param state      State vector to start from. Holds the state after the last processed sample on return
+     *  @param samples    Pointer to an array of audio samples to add the response to
+     *  @param numSamples Number of samples
+     *  @param threshold  Absolute state magnitude below which the response is treated as silent
+     *
+     *  @return the number of samples that were processed before the response decayed
+     */
+    int addZeroInputResponse (double* state, float* samples, int numSamples, double threshold = 1.0e-10) const
+    {
+        const double* c = mCoeffs.data ();
+        const int stateSize = getStateSize ();
+
+        for (int n = 0; n < numSamples; n++)
+        {
+            if ((n & 63) == 0)
+            {
+                double peak = 0.0;
+                for (int i = 0; i < stateSize; i++)
+                {
+                    peak = jmax (peak, std::abs (state[i]));
+                }
+
+                if (peak < threshold)
+                {
+                    std::fill (state, state + stateSize, 0.0);
+                    return n;
+                }
+            }
+
+            double x = 0.0;
+            for (int i = 0; i < mNumSections; i++)
+            {
+                const double* k = c + i * 5;
+                double* s = state + i * 2;
+
+                double out = x * k[0] + s[0];
+                s[0] = x * k[1] + s[1] - k[3] * out;
+                s[1] = x * k[2] - k[4] * out;
+                x = out;
+            }
+            samples[n] += (float) x;
+        }
+
+        return numSamples;
+    }
+
+    /**
+     *  Computes the state transition matrix of the cascade over a number of samples of zero input, i.e. the matrix
+     *  P such that state[n + numSamples] = P * state[n] when the input is silent.
+     *
+     *  @param numSamples Number of samples to advance the state by
+     *  @param matrix     Receives the row-major getStateSize () x getStateSize () matrix
+     */
+    void getTransitionMatrix (int numSamples, vector<double>& matrix) const
+    {
+        const int size = getStateSize ();
+
+        // one sample transition, built column by column from the response to each unit state
+        vector<double> step (size * size, 0.0), column (size);
+        for (int j = 0; j < size; j++)
+        {
+            std::fill (column.begin (), column.end (), 0.0);
+            column[j] = 1.0;
+            advanceZeroInput (column.data ());
+
+            for (int i = 0; i < size; i++)
+            {
+                step[i * size + j] = column[i];
+            }
+        }
+
+        // raise to the requested power by repeated squaring
+        matrix.assign (size * size, 0.0);
+        for (int i = 0; i < size; i++)
+        {
+            matrix[i * size + i] = 1.0;
+        }
+
+        vector<double> tmp (size * size);
+        for (int p = numSamples; p > 0; p >>= 1)
+        {
+            if (p & 1)
+            {
+                multiply (matrix, step, tmp, size);
+                matrix.swap (tmp);
+            }
+            if (p > 1)
+            {
+                multiply (step, step, tmp, size);
+                step.swap (tmp);
+            }
+        }
+    }
+
+private:
+    int mNumSections;
+    vector<double> mCoeffs;  // {a0, a1, a2, b1, b2} per section
+    vector<double> mState;   // {z1, z2} per section
+
+    /**
+     *  Advances a state vector by one sample of zero input
+     */
+    void advanceZeroInput (double* state) const
+    {
+        double x = 0.0;
+        for (int i = 0; i < mNumSections; i++)
+        {
+            const double* k = &mCoeffs[i * 5];
+            double* s = state + i * 2;
+
+            double out = x * k[0] + s[0];
+            s[0] = x * k[1] + s[1] - k[3] * out;
+            s[1] = x * k[2] - k[4] * out;
+            x = out;
+        }
+    }
+
+    /**
+     *  out = a * b for square row-major matrices
+     */
+    static void multiply (const vector<double>& a, const vector<double>& b, vector<double>& out, int size)
+    {
+        std::fill (out.begin (), out.end (), 0.0);
+        for (int i = 0; i < size; i++)
+        {
+            for (int k = 0; k < size; k++)
+            {
+                const double aik = a[i * size + k];
+                if (aik == 0.0)
+                    continue;
+
+                const double* brow = &b[k * size];
+                double* orow = &out[i * size];
+                for (int j = 0; j < size; j++)
+                {
+                    orow[j] += aik * brow[j];
+                }
+            }
+        }
+    }
+};
+
+}  // namespace Audealize
+
+#endif /* BiquadCascade_h */
@@ -0,0 +1,208 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef BlockStateSpace_h
+#define BlockStateSpace_h
+
+// samples per block: one double per SIMD lane with AVX-512, otherwise 4 (one AVX register, or two SSE registers)
+#if defined(__AVX512F__)
+#define AUDEALIZE_STATE_SPACE_BLOCK 8
+#else
+#define AUDEALIZE_STATE_SPACE_BLOCK 4
+#endif
+
+namespace Audealize
+{
+/// The block state space form of one biquad section, for filtering a single channel several samples at a time.
+///
+/// With the transposed direct form II state s = {z1, z2} of Biquad, a block of blockLength outputs is a linear
+/// function of the state at the start of the block and the block's inputs, and so is the state at the end of it.
+/// Those matrices are precomputed from the coefficients, which turns the serial recursion into short matrix-vector
+/// products the compiler can vectorise. There is no added latency: every block is processed as soon as it is read.
+///
+/// The state stays in Biquad's form, so the block and per-sample paths can take over from each other at any sample.
+class BlockStateSpaceSection
+{
+public:
+    static const int blockLength = AUDEALIZE_STATE_SPACE_BLOCK;
+
+    BlockStateSpaceSection ()
+    {
+        // no coefficients yet: the first update () computes the matrices
+        std::fill (mCoeffs, mCoeffs + 5, std::numeric_limits<double>::quiet_NaN ());
+    }
+
+    /**
+     *  Recomputes the matrices if the coefficients differ from those they were computed from
+     *
+     *  @param coeffs {a0, a1, a2, b1, b2} @see Biquad::getCoefficients
+     */
+    void update (const double* coeffs)
+    {
+        if (std::equal (coeffs, coeffs + 5, mCoeffs))
+        {
+            return;
+        }
+        std::copy (coeffs, coeffs + 5, mCoeffs);
+
+        const double a0 = coeffs[0], a1 = coeffs[1], a2 = coeffs[2], b1 = coeffs[3], b2 = coeffs[4];
+
+        // s[n + 1] = A s[n] + B x[n], y[n] = s[n].z1 + a0 x[n]
+        const double A[2][2] = {{-b1, 1.0}, {-b2, 0.0}};
+        const double B[2] = {a1 - b1 * a0, a2 - b2 * a0};
+
+        // powers[n] = A^n
+        double powers[blockLength + 1][2][2] = {{{1.0, 0.0}, {0.0, 1.0}}};
+        for (int n = 1; n <= blockLength; n++)
+        {
+            multiply (A, powers[n - 1], powers[n]);
+        }
+
+        // output n from the starting state: first row of A^n
+        for (int n = 0; n < blockLength; n++)
+        {
+            mFromState[0][n] = powers[n][0][0];
+            mFromState[1][n] = powers[n][0][1];
+        }
+
+        // impulse response h[0] = a0, h[m] = first row of A^(m - 1) B
+        double h[blockLength];
+        h[0] = a0;
+        for (int m = 1; m < blockLength; m++)
+        {
+            h[m] = powers[m - 1][0][0] * B[0] + powers[m - 1][0][1] * B[1];
+        }
+
+        for (int k = 0; k < blockLength; k++)
+        {
+            for (int n = 0; n < blockLength; n++)
+            {
+                mFromInput[k][n] = n >= k ? h[n - k] : 0.0;
+            }
+
+            // input k reaches the end of the block through A^(blockLength - 1 - k)
+            const double(&P)[2][2] = powers[blockLength - 1 - k];
+            mStateFromInput[0][k] = P[0][0] * B[0] + P[0][1] * B[1];
+            mStateFromInput[1][k] = P[1][0] * B[0] + P[1][1] * B[1];
+        }
+
+        for (int r = 0; r < 2; r++)
+        {
+            for (int c = 0; c < 2; c++)
+            {
+                mStateFromState[r][c] = powers[blockLength][r][c];
+            }
+        }
+    }
+
+    /**
+     *  Filters a block of samples in place. Whole blocks use the state space form; the samples left over at the end
+     *  are run through the biquad recursion. Outputs are rounded to float and undenormalised like
+     *  NChannelFilter::processSample.
+     *
+     *  @param samples    Pointer to an array of audio samples
+     *  @param numSamples Number of samples
+     *  @param state      {z1, z2} of the biquad. Holds the state after the last sample on return
+     */
+    void process (float* samples, int numSamples, double* state) const
+    {
+        double s0 = state[0], s1 = state[1];
+        int i = 0;
+
+        for (; i + blockLength <= numSamples; i += blockLength)
+        {
+            float* block = samples + i;
+            double y[blockLength];
+
+            for (int n = 0; n < blockLength; n++)
+            {
+                y[n] = mFromState[0][n] * s0 + mFromState[1][n] * s1;
+            }
+
+            double next0 = mStateFromState[0][0] * s0 + mStateFromState[0][1] * s1;
+            double next1 = mStateFromState[1][0] * s0 + mStateFromState[1][1] * s1;
+
+            for (int k = 0; k < blockLength; k++)
+            {
+                const double x = block[k];
+                for (int n = 0; n < blockLength; n++)
+                {
+                    y[n] += mFromInput[k][n] * x;
+                }
+                next0 += mStateFromInput[0][k] * x;
+                next1 += mStateFromInput[1][k] * x;
+            }
+
+            s0 = next0;
+            s1 = next1;
+
+            for (int n = 0; n < blockLength; n++)
+            {
+                float out = (float) y[n];
+                JUCE_UNDENORMALISE (out);
+                block[n] = out;
+            }
+        }
+
+        const double a0 = mCoeffs[0], a1 = mCoeffs[1], a2 = mCoeffs[2], b1 = mCoeffs[3], b2 = mCoeffs[4];
+        for (; i < numSamples; i++)
+        {
+            const float in = samples[i];
+            const double out = in * a0 + s0;
+            s0 = in * a1 + s1 - b1 * out;
+            s1 = in * a2 - b2 * out;
+
+            float y = (float) out;
+            JUCE_UNDENORMALISE (y);
+            samples[i] = y;
+        }
+
+        state[0] = s0;
+        state[1] = s1;
+    }
+
+private:
+    double mCoeffs[5];                            // coefficients the matrices were computed from
+    double mFromState[2][blockLength];            // [state variable][output]
+    double mFromInput[blockLength][blockLength];  // [input][output], zero above the diagonal
+    double mStateFromInput[2][blockLength];       // [state variable][input]
+    double mStateFromState[2][2];                 // A^blockLength
+
+    /**
+     *  out = a * b for 2x2 matrices
+     */
+    static void multiply (const double (&a)[2][2], const double (&b)[2][2], double (&out)[2][2])
+    {
+        for (int r = 0; r < 2; r++)
+        {
+            for (int c = 0; c < 2; c++)
+            {
+                out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c];
+            }
+        }
+    }
+};
+
+}  // namespace Audealize
+
+#endif /* BlockStateSpace_h */
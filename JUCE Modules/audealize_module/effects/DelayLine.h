@@ -0,0 +1,472 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef DelayLine_h
+#define DelayLine_h
+
+namespace Audealize
+{
+/// A fixed length delay line, as used by the Reverb's combs, allpasses and clean signal delay, that can store its
+/// samples as 32 bit floats or in one of three 16 bit formats. The 16 bit formats halve the memory the lines take and
+/// the bandwidth the network needs, at the cost of a little noise: the samples are rounded as they are written and
+/// expanded as they are read, inside the same loops that run the filters.
+///
+/// The filters have the same arithmetic as simple_delay::process_comb, process_allpass_comb and process. They work
+/// through the line in runs no longer than the delay, so nothing written in a run is read back in it and each run is
+/// a contiguous loop the compiler can vectorise, conversions included.
+class DelayLine
+{
+public:
+    static const int size = 9600;  // length of the line in samples
+
+    /// The largest magnitude kFormatInt16 can hold. The combs' feedback builds up to several times the input level
+    static const int int16FullScale = 16;
+
+    enum Format
+    {
+        kFormatFloat32 = 0,  // exact
+        kFormatFloat16,      // IEEE half precision, saturated at +-65504. About 11 significant bits
+        kFormatBFloat16,     // the upper half of a float. 8 significant bits, but the full range of a float
+        kFormatInt16         // fixed point, saturated at +-int16FullScale. Evenly spaced steps of int16FullScale / 32767
+    };
+
+    DelayLine () : mFormat (kFormatFloat32), mPos (0)
+    {
+        mFloatData.calloc (size);
+    }
+
+    /**
+     *  Changes the storage format, converting the samples held in the line. Allocates, so call it when the line isn't
+     *  being processed
+     */
+    void setFormat (Format format)
+    {
+        if (format == mFormat)
+        {
+            return;
+        }
+
+        HeapBlock<float> samples (size);
+        for (int i = 0; i < size; i++)
+        {
+            samples[i] = getSample (i);
+        }
+
+        if (format == kFormatFloat32)
+        {
+            mFloatData.malloc (size);
+            mCompactData.free ();
+        }
+        else if (mFormat == kFormatFloat32)
+        {
+            mCompactData.malloc (size);
+            mFloatData.free ();
+        }
+        mFormat = format;
+
+        for (int i = 0; i < size; i++)
+        {
+            setSample (i, samples[i]);
+        }
+    }
+
+    Format getFormat () const
+    {
+        return mFormat;
+    }
+
+    /**
+     *  Zeroes the line
+     */
+    void reset ()
+    {
+        mPos = 0;
+        if (mFormat == kFormatFloat32)
+        {
+            mFloatData.clear (size);
+        }
+        else
+        {
+            mCompactData.clear (size);  // all three formats store zero as zero bits
+        }
+    }
+
+    /**
+     *  Copies the contents and write position of another line, converting them to this line's format. Doesn't
+     *  allocate
+     */
+    void copyFrom (const DelayLine& other)
+    {
+        mPos = other.mPos;
+
+        if (other.mFormat == mFormat)
+        {
+            if (mFormat == kFormatFloat32)
+            {
+                memcpy (mFloatData, other.mFloatData, size * sizeof (float));
+            }
+            else
+            {
+                memcpy (mCompactData, other.mCompactData, size * sizeof (uint16));
+            }
+            return;
+        }
+
+        for (int i = 0; i < size; i++)
+        {
+            setSample (i, other.getSample (i));
+        }
+    }
+
+    /**
+     *  Returns the sample at a position in the line's storage, not relative to the write position
+     */
+    float getSample (int index) const
+    {
+        switch (mFormat)
+        {
+            case kFormatFloat16:
+                return Float16::load (mCompactData[index]);
+            case kFormatBFloat16:
+                return BFloat16::load (mCompactData[index]);
+            case kFormatInt16:
+                return Int16::load ((int16) mCompactData[index]);
+            default:
+                return mFloatData[index];
+        }
+    }
+
+    /**
+     *  Sets the sample at a position in the line's storage, rounding it to the line's format
+     */
+    void setSample (int index, float value)
+    {
+        switch (mFormat)
+        {
+            case kFormatFloat16:
+                mCompactData[index] = Float16::store (value);
+                break;
+            case kFormatBFloat16:
+                mCompactData[index] = BFloat16::store (value);
+                break;
+            case kFormatInt16:
+                mCompactData[index] = (uint16) Int16::store (value);
+                break;
+            default:
+                mFloatData[index] = value;
+                break;
+        }
+    }
+
+    /**
+     *  Returns the write position, the storage index the next sample is written to
+     */
+    int getWritePosition () const
+    {
+        return mPos;
+    }
+
+    /**
+     *  Runs a block through a comb filter and adds its weighted output to a sum
+     *
+     *  @param delay      Delay in samples [1, size)
+     *  @param fb         Feedback gain
+     *  @param weight     Weight of the comb's output in the sum
+     *  @param in         Input samples
+     *  @param sum        Samples to add the output to
+     *  @param numSamples Number of samples
+     */
+    void processComb (unsigned int delay, float fb, float weight, const float* in, float* sum, int numSamples)
+    {
+        switch (mFormat)
+        {
+            case kFormatFloat16:
+                processComb<Float16> (mCompactData, delay, fb, weight, in, sum, numSamples);
+                break;
+            case kFormatBFloat16:
+                processComb<BFloat16> (mCompactData, delay, fb, weight, in, sum, numSamples);
+                break;
+            case kFormatInt16:
+                processComb<Int16> ((int16*) mCompactData.getData (), delay, fb, weight, in, sum, numSamples);
+                break;
+            default:
+                processComb<Float32> (mFloatData, delay, fb, weight, in, sum, numSamples);
+                break;
+        }
+    }
+
+    /**
+     *  Runs a block through an allpass comb filter
+     *
+     *  @param delay      Delay in samples [1, size)
+     *  @param gain       Feedback gain
+     *  @param in         Input samples
+     *  @param out        Output samples. May not be the same as in
+     *  @param numSamples Number of samples
+     */
+    void processAllpass (unsigned int delay, float gain, const float* in, float* out, int numSamples)
+    {
+        switch (mFormat)
+        {
+            case kFormatFloat16:
+                processAllpass<Float16> (mCompactData, delay, gain, in, out, numSamples);
+                break;
+            case kFormatBFloat16:
+                processAllpass<BFloat16> (mCompactData, delay, gain, in, out, numSamples);
+                break;
+            case kFormatInt16:
+                processAllpass<Int16> ((int16*) mCompactData.getData (), delay, gain, in, out, numSamples);
+                break;
+            default:
+                processAllpass<Float32> (mFloatData, delay, gain, in, out, numSamples);
+                break;
+        }
+    }
+
+    /**
+     *  Runs a block through the line as a plain delay
+     *
+     *  @param delay      Delay in samples [1, size)
+     *  @param in         Input samples
+     *  @param out        Output samples. May not be the same as in
+     *  @param numSamples Number of samples
+     */
+    void processDelay (unsigned int delay, const float* in, float* out, int numSamples)
+    {
+        switch (mFormat)
+        {
+            case kFormatFloat16:
+                processDelay<Float16> (mCompactData, delay, in, out, numSamples);
+                break;
+            case kFormatBFloat16:
+                processDelay<BFloat16> (mCompactData, delay, in, out, numSamples);
+                break;
+            case kFormatInt16:
+                processDelay<Int16> ((int16*) mCompactData.getData (), delay, in, out, numSamples);
+                break;
+            default:
+                processDelay<Float32> (mFloatData, delay, in, out, numSamples);
+                break;
+        }
+    }
+
+    size_t getSizeInBytes () const
+    {
+        return size * (mFormat == kFormatFloat32 ? sizeof (float) : sizeof (uint16));
+    }
+
+private:
+    Format mFormat;
+    int mPos;  // write position
+    HeapBlock<float> mFloatData;     // kFormatFloat32 only
+    HeapBlock<uint16> mCompactData;  // the 16 bit formats only
+
+    /// Conversions between the network's floats and the stored samples, one struct per format
+    struct Float32
+    {
+        typedef float Sample;
+
+        static inline float load (float s)
+        {
+            return s;
+        }
+
+        static inline float store (float x)
+        {
+            return x;
+        }
+    };
+
+    // The 16 bit conversions are written without branches, as selects and bit masks, so the loops that use them are
+    // still vectorised
+
+    static inline float toFloat (uint32 bits)
+    {
+        float x;
+        memcpy (&x, &bits, sizeof (x));
+        return x;
+    }
+
+    static inline uint32 toBits (float x)
+    {
+        uint32 bits;
+        memcpy (&bits, &x, sizeof (bits));
+        return bits;
+    }
+
+    /**
+     *  Flushes values below 2^-24 to zero, as dsp::sanitize does, with a bit mask instead of a select
+     */
+    static inline float sanitize (float x)
+    {
+        return toFloat (toBits (x) & (0u - (uint32) (std::abs (x) >= 1.0f / 16777216.0f)));
+    }
+
+    struct Float16
+    {
+        typedef uint16 Sample;
+
+        static inline float load (uint16 s)
+        {
+            // move the exponent and mantissa into place and rebias the exponent. Subnormal halves become normal
+            // floats: give them the smallest normal exponent and subtract its implicit one
+            const uint32 bits = (uint32) (s & 0x7fff) << 13;
+            const float normal = toFloat (bits + (112u << 23));
+            const float subnormal = toFloat (bits + (113u << 23)) - 6.103515625e-05f;  // 2^-14
+            const uint32 mask = 0u - (uint32) (bits < 0x00800000u);
+
+            return toFloat ((toBits (subnormal) & mask) | (toBits (normal) & ~mask) | ((uint32) (s & 0x8000) << 16));
+        }
+
+        static inline uint16 store (float x)
+        {
+            const uint32 bits = toBits (x);
+            const uint32 sign = (bits >> 16) & 0x8000;
+            uint32 magnitude = bits & 0x7fffffffu;
+            magnitude = magnitude < 0x477fe000u ? magnitude : 0x477fe000u;  // saturate at 65504
+
+            // below the smallest normal half, let a float addition round the mantissa into place. Otherwise rebias
+            // the exponent and round to nearest even
+            const uint32 subnormalBits = toBits (toFloat (magnitude) + 0.5f) - 0x3f000000u;
+            const uint32 normalBits = (magnitude + 0xc8000fffu + ((magnitude >> 13) & 1)) >> 13;
+            const uint32 mask = 0u - (uint32) (magnitude < 0x38800000u);
+
+            return (uint16) ((subnormalBits & mask) | (normalBits & ~mask) | sign);
+        }
+    };
+
+    struct BFloat16
+    {
+        typedef uint16 Sample;
+
+        static inline float load (uint16 s)
+        {
+            return toFloat ((uint32) s << 16);
+        }
+
+        static inline uint16 store (float x)
+        {
+            const uint32 bits = toBits (x);
+            return (uint16) ((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);  // round to nearest even
+        }
+    };
+
+    struct Int16
+    {
+        typedef int16 Sample;
+
+        static inline float load (int16 s)
+        {
+            return s * (int16FullScale / 32767.0f);
+        }
+
+        static inline int16 store (float x)
+        {
+            // offset to positive values so truncation rounds to nearest, and clamp to [-32767, 32767]
+            const float offset = x * (32767.0f / int16FullScale) + 32768.5f;
+            const float clamped = offset < 1.0f ? 1.0f : (offset > 65535.0f ? 65535.0f : offset);
+            return (int16) ((int) clamped - 32768);
+        }
+    };
+
+    template <typename Codec>
+    void processComb (typename Codec::Sample* data, unsigned int delay, float fb, float weight, const float* in,
+                      float* sum, int numSamples)
+    {
+        int w = mPos, r = (mPos + size - (int) delay) % size;
+
+        while (numSamples > 0)
+        {
+            const int n = jmin (numSamples, (int) delay, size - w, size - r);
+            for (int i = 0; i < n; i++)
+            {
+                const float old = Codec::load (data[r + i]);
+                const float cur = in[i] + fb * old;
+                data[w + i] = Codec::store (sanitize (cur));
+                sum[i] += old * weight;
+            }
+
+            in += n;
+            sum += n;
+            numSamples -= n;
+            w = (w + n) % size;
+            r = (r + n) % size;
+        }
+        mPos = w;
+    }
+
+    template <typename Codec>
+    void processAllpass (typename Codec::Sample* data, unsigned int delay, float gain, const float* in, float* out,
+                         int numSamples)
+    {
+        int w = mPos, r = (mPos + size - (int) delay) % size;
+
+        while (numSamples > 0)
+        {
+            const int n = jmin (numSamples, (int) delay, size - w, size - r);
+            for (int i = 0; i < n; i++)
+            {
+                const float old = Codec::load (data[r + i]);
+                const float cur = sanitize (in[i] + gain * old);
+                data[w + i] = Codec::store (cur);
+                out[i] = old - gain * cur;
+            }
+
+            in += n;
+            out += n;
+            numSamples -= n;
+            w = (w + n) % size;
+            r = (r + n) % size;
+        }
+        mPos = w;
+    }
+
+    template <typename Codec>
+    void processDelay (typename Codec::Sample* data, unsigned int delay, const float* in, float* out, int numSamples)
+    {
+        int w = mPos, r = (mPos + size - (int) delay) % size;
+
+        while (numSamples > 0)
+        {
+            const int n = jmin (numSamples, (int) delay, size - w, size - r);
+            for (int i = 0; i < n; i++)
+            {
+                out[i] = Codec::load (data[r + i]);
+                data[w + i] = Codec::store (in[i]);
+            }
+
+            in += n;
+            out += n;
+            numSamples -= n;
+            w = (w + n) % size;
+            r = (r + n) % size;
+        }
+        mPos = w;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (DelayLine)
+};
+
+}  // namespace Audealize
+
+#endif /* DelayLine_h */
@@ -0,0 +1,336 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef EngineSwitcher_h
+#define EngineSwitcher_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// Holds two instances of an effect and switches the running one to new settings by configuring the idle one on the
+/// shared WorkerPool, then crossfading to it on the audio thread. Descriptor changes move
+/// every parameter at once; smoothing them on the running instance means recomputing coefficients every block until
+/// each parameter settles, whereas a switch costs the audio thread one extra instance for the length of the fade.
+///
+/// When the fade starts the incoming instance takes over the outgoing one's signal state with copyStateFrom, so filter
+/// memories and reverb tails carry on instead of starting from silence. EffectType must provide
+/// void copyStateFrom (EffectType& other).
+///
+/// Each request can carry the settings it configures, e.g. parameter values to snap the running instance's smoothing
+/// to. They are kept with the instance they were applied to, so the audio thread can read the running instance's
+/// settings while the idle one is being configured with the next request's.
+template <class EffectType>
+class EngineSwitcher
+{
+public:
+    typedef std::function<void (EffectType&)> Configurer;
+
+    enum FadeShape
+    {
+        kFadeEqualGain = 0,  // for instances whose outputs are strongly correlated, e.g. two EQ curves
+        kFadeEqualPower      // for instances whose outputs are mostly uncorrelated
+    };
+
+    static const int maxChannels = 8;
+    static const int retryMs = 2;  // how soon the configuring job checks again while a fade is running
+
+    /**
+     *  Constructor. Takes ownership of both instances, which must be set up identically
+     */
+    EngineSwitcher (EffectType* first, EffectType* second)
+        : mActive (0), mState (kIdle), mFadeLength (1), mFadePos (0), mJobQueued (false), mPendingGeneration (0)
+    {
+        mEngines[0] = first;
+        mEngines[1] = second;
+    }
+
+    ~EngineSwitcher ()
+    {
+        mToken.cancel ();
+        mWorkerPool->waitFor (mToken);
+    }
+
+    /**
+     *  Allocates the buffer the incoming instance is processed into and sets the length of the fade. Call from
+     *  prepareToPlay
+     *
+     *  @param numChannels  Maximum number of channels processed
+     *  @param maxBlockSize Expected block size. Larger blocks are faded in pieces of this size
+     *  @param fadeSamples  Length of the crossfade in samples
+     *  @param shape        @see EngineSwitcher::FadeShape
+     */
+    void prepare (int numChannels, int maxBlockSize, int fadeSamples, FadeShape shape)
+    {
+        jassert (numChannels <= maxChannels);
+
+        mScratch.setSize (jlimit (1, (int) maxChannels, numChannels), jmax (1, maxBlockSize));
+
+        // the incoming gain; the outgoing gain at position n is mFadeCurve[mFadeLength - n]
+        mFadeLength = jmax (1, fadeSamples);
+        mFadeCurve.malloc (mFadeLength + 1);
+        for (int n = 0; n <= mFadeLength; n++)
+        {
+            const double x = (double) n / mFadeLength;
+            mFadeCurve[n] = (float) (shape == kFadeEqualPower ? std::sin (0.5 * double_Pi * x) : x);
+        }
+    }
+
+    /**
+     *  Runs a function on both instances, e.g. to set the sample rate. Waits for a configuring job to finish, but
+     *  must not be called concurrently with process
+     */
+    template <typename Function>
+    void forEach (Function function)
+    {
+        const ScopedLock sl (mConfigureLock);
+        function (*mEngines[0]);
+        function (*mEngines[1]);
+    }
+
+    /**
+     *  Returns the instance currently being heard (the outgoing one while fading). Call from the audio thread
+     */
+    EffectType& getActive ()
+    {
+        return *mEngines[mActive.get ()];
+    }
+
+    /**
+     *  Requests a switch. The configurer is run on the idle instance on the WorkerPool, and the audio thread fades to
+     *  it once it is done. A request that hasn't started fading yet is replaced by a newer one. Call from the message
+     *  thread
+     *
+     *  @param configure Sets the idle instance to the new settings
+     *  @param settings  Kept with the instance once it is configured. @see getActiveSettings
+     */
+    void requestSwitch (Configurer configure, const vector<float>& settings = vector<float> ())
+    {
+        const ScopedLock sl (mLock);
+
+        mPending = configure;
+        mPendingSettings = settings;
+        mPendingGeneration = ++mRequestedGeneration;
+
+        if (!mJobQueued)
+        {
+            mJobQueued = true;
+            mWorkerPool->submitRecurring ("Engine switch", WorkerPool::kPriorityInteractive, mToken,
+                                          [this] () { return configureNext (); });
+        }
+    }
+
+    /**
+     *  Returns true from a call to requestSwitch until the fade to its settings has finished. Parameter smoothing of
+     *  the running instance should be held off meanwhile
+     */
+    bool isSwitching () const
+    {
+        return mRequestedGeneration.get () != mCompletedGeneration.get ();
+    }
+
+    /**
+     *  Returns the settings passed with the request the running instance was last configured by. Call from the audio
+     *  thread, e.g. after process returns true
+     */
+    const vector<float>& getActiveSettings () const
+    {
+        return mSettings[mActive.get ()];
+    }
+
+    /**
+     *  Processes a block in place, crossfading from the running instance to the idle one if it has been configured.
+     *  Call from the audio thread
+     *
+     *  @param channels    The channels to process
+     *  @param numChannels Number of channels
+     *  @param numSamples  Number of samples
+     *  @param process     Called as process (EffectType&, float* const* channels, int numChannels, int numSamples)
+     *                     to run one instance over a block in place
+     *
+     *  @return true if a switch finished during this block. getActiveSettings () then returns the settings it was
+     *          requested with
+     */
+    template <typename ProcessFunction>
+    bool process (float* const* channels, int numChannels, int numSamples, ProcessFunction process)
+    {
+        jassert (numChannels <= mScratch.getNumChannels ());
+
+        if (mState.get () == kReady && mState.compareAndSetBool (kFading, kReady))
+        {
+            mEngines[1 - mActive.get ()]->copyStateFrom (*mEngines[mActive.get ()]);
+            mFadePos = 0;
+        }
+
+        EffectType& from = *mEngines[mActive.get ()];
+
+        if (mState.get () != kFading)
+        {
+            process (from, channels, numChannels, numSamples);
+            return false;
+        }
+
+        EffectType& to = *mEngines[1 - mActive.get ()];
+        float* out[maxChannels];
+        float* in[maxChannels];
+
+        int pos = 0;
+        while (pos < numSamples && mFadePos < mFadeLength)
+        {
+            const int n = jmin (numSamples - pos, mScratch.getNumSamples (), mFadeLength - mFadePos);
+
+            for (int c = 0; c < numChannels; c++)
+            {
+                out[c] = channels[c] + pos;
+                in[c] = mScratch.getWritePointer (c);
+                FloatVectorOperations::copy (in[c], out[c], n);
+            }
+
+            process (from, out, numChannels, n);
+            process (to, in, numChannels, n);
+
+            const float* fadeIn = mFadeCurve + mFadePos;
+            const float* fadeOut = mFadeCurve + (mFadeLength - mFadePos);
+            for (int c = 0; c < numChannels; c++)
+            {
+                for (int i = 0; i < n; i++)
+                {
+                    out[c][i] = out[c][i] * fadeOut[-i] + in[c][i] * fadeIn[i];
+                }
+            }
+
+            pos += n;
+            mFadePos += n;
+        }
+
+        if (mFadePos < mFadeLength)
+        {
+            return false;
+        }
+
+        // the incoming instance is now the only one heard
+        mActive = 1 - mActive.get ();
+        mCompletedGeneration = mReadyGeneration.get ();
+        mState = kIdle;
+
+        if (pos < numSamples)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                out[c] = channels[c] + pos;
+            }
+            process (to, out, numChannels, numSamples - pos);
+        }
+
+        return true;
+    }
+
+    /**
+     *  Returns the memory allocated for the fade, in bytes. The instances report their own
+     */
+    size_t getSizeInBytes () const
+    {
+        return (size_t) mScratch.getNumChannels () * (size_t) mScratch.getNumSamples () * sizeof (float) +
+               (size_t) (mFadeLength + 1) * sizeof (float);
+    }
+
+private:
+    enum State
+    {
+        kIdle = 0,  // the idle instance is free to be configured
+        kReady,     // the idle instance has been configured; the audio thread starts the fade on its next block
+        kFading     // the audio thread is running both instances
+    };
+
+    ScopedPointer<EffectType> mEngines[2];
+    vector<float> mSettings[2];  // the settings of each instance's last request. only written while it is idle
+    Atomic<int> mActive;  // index of the running instance
+    Atomic<int> mState;   // @see State
+
+    AudioSampleBuffer mScratch;   // the incoming instance's output while fading
+    HeapBlock<float> mFadeCurve;  // mFadeLength + 1 gains
+    int mFadeLength, mFadePos;    // mFadePos is only touched by the audio thread
+
+    CriticalSection mLock;  // guards mPending, mPendingSettings, mPendingGeneration and mJobQueued
+    Configurer mPending;
+    vector<float> mPendingSettings;
+    bool mJobQueued;
+    int mPendingGeneration;
+
+    // each request is numbered, so isSwitching can tell when the latest one has been heard
+    Atomic<int> mRequestedGeneration, mReadyGeneration, mCompletedGeneration;
+
+    CriticalSection mConfigureLock;  // held while an instance is being configured off the audio thread
+
+    SharedResourcePointer<WorkerPool> mWorkerPool;
+    WorkerPool::CancellationToken mToken;
+
+    /**
+     *  Body of the configuring job: configures the idle instance with the latest request once it is free
+     *
+     *  @return the number of milliseconds until the job should run again, or -1 when there is nothing left to do
+     */
+    int configureNext ()
+    {
+        Configurer configure;
+        vector<float> settings;
+        int generation;
+        {
+            const ScopedLock sl (mLock);
+
+            if (mPending == nullptr)
+            {
+                mJobQueued = false;
+                return -1;
+            }
+
+            // the idle instance is still fading out, or the audio thread has just started fading to it
+            if (mState.get () == kFading || (mState.get () == kReady && !mState.compareAndSetBool (kIdle, kReady)))
+            {
+                return retryMs;
+            }
+
+            configure.swap (mPending);
+            settings.swap (mPendingSettings);
+            generation = mPendingGeneration;
+        }
+
+        {
+            const ScopedLock sl (mConfigureLock);
+            const int idle = 1 - mActive.get ();
+            configure (*mEngines[idle]);
+            mSettings[idle].swap (settings);
+        }
+
+        mReadyGeneration = generation;
+        mState = kReady;
+
+        // pick up anything requested while configuring
+        return retryMs;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (EngineSwitcher)
+};
+}
+
+#endif /* EngineSwitcher_h */
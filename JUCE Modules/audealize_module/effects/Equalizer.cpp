@@ -0,0 +1,403 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "Equalizer.h"
+
+namespace Audealize
+{
+Equalizer::Thresholds Equalizer::getThresholds (Quality quality)
+{
+    // a peaking filter within 0.05 dB of unity is inaudible; within 0.01 dB it barely changes the samples
+    Thresholds thresholds;
+    thresholds.drop = quality == kQualityFull ? 0.01f : 0.05f;
+    thresholds.restore = thresholds.drop * 2.0f;
+    return thresholds;
+}
+
+void Equalizer::updateQuality ()
+{
+    mSamplesSinceUpdate = 0;
+
+    if (mFadeFrom != mQuality &&
+        std::count (mFadeRemaining.begin (), mFadeRemaining.end (), 0) == (int) mFadeRemaining.size ())
+    {
+        mFadeFrom = mQuality;
+    }
+
+    if (!mStarted)
+    {
+        startSchedule ();
+        return;
+    }
+
+    const bool fullBankRunning = mQuality != kQualityReducedSections || mFadeFrom != kQualityReducedSections;
+    const bool reducedBankRunning = mQuality == kQualityReducedSections || mFadeFrom == kQualityReducedSections;
+
+    if (fullBankRunning && (mBandsDirty || mBandSchedule.numFading > 0))
+    {
+        const Thresholds t = getThresholds (mQuality == kQualityReducedSections ? mFadeFrom : mQuality);
+        mBandSchedule.update (mFilters, t.drop, t.restore, mChannelUsed);
+        mBandsDirty = false;
+    }
+
+    if (reducedBankRunning && (mReducedDirty || mReducedSchedule.numFading > 0))
+    {
+        if (mReducedDirty)
+        {
+            refitReducedSections ();
+        }
+
+        const Thresholds t = getThresholds (kQualityReducedSections);
+        mReducedSchedule.update (mReducedFilters, t.drop, t.restore, mChannelUsed);
+    }
+
+    std::fill (mChannelUsed.begin (), mChannelUsed.end (), false);
+}
+
+void Equalizer::startSchedule ()
+{
+    if (mQuality == kQualityReducedSections)
+    {
+        refitReducedSections ();
+        mReducedSchedule.start (mReducedFilters, getThresholds (mQuality).restore);
+    }
+    else
+    {
+        mBandSchedule.start (mFilters, getThresholds (mQuality).restore);
+    }
+
+    mBandsDirty = false;
+    mStarted = true;
+}
+
+void Equalizer::getActiveBiquads (vector<Biquad*>& biquads, int channelIdx)
+{
+    // with no channel marked as used, updating completes every fade, and the crossfade between banks is cut short
+    std::fill (mFadeRemaining.begin (), mFadeRemaining.end (), 0);
+    std::fill (mChannelUsed.begin (), mChannelUsed.end (), false);
+    updateQuality ();
+
+    const bool reduced = mQuality == kQualityReducedSections;
+    const SectionSchedule& schedule = reduced ? mReducedSchedule : mBandSchedule;
+    vector<NChannelFilter>& bank = reduced ? mReducedFilters : mFilters;
+
+    biquads.clear ();
+    for (int i = 0; i < schedule.active.size (); i++)
+    {
+        biquads.push_back (&bank[schedule.active[i]].getBiquad (channelIdx));
+    }
+}
+
+void Equalizer::copyStateFrom (Equalizer& other)
+{
+    jassert (other.mNumBands == mNumBands && other.mChannels == mChannels);
+
+    mQuality = mFadeFrom = other.mQuality;
+    std::fill (mFadeRemaining.begin (), mFadeRemaining.end (), 0);
+    startSchedule ();
+
+    // after starting the schedule, which clears the state of the sections it runs
+    double state[2];
+    for (int k = 0; k < mNumBands; k++)
+    {
+        for (int c = 0; c < mChannels; c++)
+        {
+            other.mFilters[k].getBiquad (c).getState (state);
+            mFilters[k].getBiquad (c).setState (state);
+        }
+    }
+    for (int k = 0; k < (int) mReducedFilters.size (); k++)
+    {
+        for (int c = 0; c < mChannels; c++)
+        {
+            other.mReducedFilters[k].getBiquad (c).getState (state);
+            mReducedFilters[k].getBiquad (c).setState (state);
+        }
+    }
+}
+
+void Equalizer::refitReducedSections ()
+{
+    for (int k = 0; k < mReducedFilters.size (); k++)
+    {
+        float gain = 0.0f;
+        for (int i = 0; i < mNumBands; i++)
+        {
+            gain += mReducedFit[k * mNumBands + i] * mGains[i];
+        }
+
+        if (std::abs (gain - mReducedFilters[k].getGain ()) > 1.0e-4f)
+        {
+            mReducedFilters[k].setGain (gain);
+        }
+    }
+
+    mReducedDirty = false;
+}
+
+void Equalizer::SectionSchedule::resize (int numSections, int channels)
+{
+    numChannels = channels;
+    numFading = 0;
+    active.clear ();
+    state.assign (numSections, kOut);
+    mix.assign (numSections * channels, 0.0f);
+}
+
+void Equalizer::SectionSchedule::start (vector<NChannelFilter>& bank, float restoreThreshold)
+{
+    numFading = 0;
+    active.clear ();
+
+    for (int k = 0; k < bank.size (); k++)
+    {
+        for (int c = 0; c < numChannels; c++)
+        {
+            bank[k].getBiquad (c).reset ();
+        }
+
+        const bool in = std::abs (bank[k].getGain ()) >= restoreThreshold;
+        state[k] = in ? kIn : kOut;
+        std::fill (mix.begin () + k * numChannels, mix.begin () + (k + 1) * numChannels, in ? 1.0f : 0.0f);
+
+        if (in)
+        {
+            active.push_back (k);
+        }
+    }
+}
+
+void Equalizer::SectionSchedule::update (vector<NChannelFilter>& bank, float dropThreshold, float restoreThreshold,
+                                         const vector<bool>& channelUsed)
+{
+    numFading = 0;
+    active.clear ();
+
+    for (int k = 0; k < bank.size (); k++)
+    {
+        const float gain = std::abs (bank[k].getGain ());
+        float* w = &mix[k * numChannels];
+
+        if ((state[k] == kIn || state[k] == kFadingIn) && gain < dropThreshold)
+        {
+            state[k] = kFadingOut;
+        }
+        else if ((state[k] == kOut || state[k] == kFadingOut) && gain >= restoreThreshold)
+        {
+            // a section that was dropped comes back from silence, not from the state it had back then
+            if (state[k] == kOut)
+            {
+                for (int c = 0; c < numChannels; c++)
+                {
+                    bank[k].getBiquad (c).reset ();
+                }
+            }
+            state[k] = kFadingIn;
+        }
+
+        if (state[k] == kFadingIn || state[k] == kFadingOut)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                if (!channelUsed[c])
+                {
+                    w[c] = state[k] == kFadingIn ? 1.0f : 0.0f;
+                }
+            }
+        }
+
+        // fades finish once every channel has got there
+        if (state[k] == kFadingOut && *std::max_element (w, w + numChannels) == 0.0f)
+        {
+            state[k] = kOut;
+        }
+        else if (state[k] == kFadingIn && *std::min_element (w, w + numChannels) == 1.0f)
+        {
+            state[k] = kIn;
+        }
+
+        if (state[k] != kOut)
+        {
+            active.push_back (k);
+        }
+        if (state[k] == kFadingIn || state[k] == kFadingOut)
+        {
+            numFading++;
+        }
+    }
+}
+
+void Equalizer::calcReducedSections ()
+{
+    // neighbouring bands closer than a third of an octave share one section of twice the width. the low bands are
+    // spaced further apart and keep a section each
+    vector<float> sectionFreqs, sectionQs;
+    for (int i = 0; i < mNumBands; i++)
+    {
+        if (i + 1 < mNumBands && mFreqs[i + 1] < mFreqs[i] * 1.26f)
+        {
+            sectionFreqs.push_back (std::sqrt (mFreqs[i] * mFreqs[i + 1]));
+            sectionQs.push_back (mQ * 0.5f);
+            i++;
+        }
+        else
+        {
+            sectionFreqs.push_back (mFreqs[i]);
+            sectionQs.push_back (mQ);
+        }
+    }
+
+    const int numSections = sectionFreqs.size ();
+
+    mReducedFilters.resize (numSections);
+    mReducedSchedule.resize (numSections, mChannels);
+    mReducedStateSpace.resize (numSections);
+    mReducedFit.assign (numSections * mNumBands, 0.0f);
+    mReducedDirty = true;
+
+    for (int k = 0; k < numSections; k++)
+    {
+        mReducedFilters[k].setNumChannels (mChannels);
+        mReducedFilters[k].setFilter (bq_type_peak, sectionFreqs[k], sectionQs[k], 0.0f, mSampleRate);
+    }
+
+    if (mSampleRate <= 0.0f || numSections == 0)
+    {
+        return;
+    }
+
+    // the fit is made at the band centers and halfway between them, so the dips between narrow bands count too
+    vector<float> fitFreqs;
+    for (int i = 0; i < mNumBands; i++)
+    {
+        fitFreqs.push_back (mFreqs[i]);
+        if (i + 1 < mNumBands)
+        {
+            fitFreqs.push_back (std::sqrt (mFreqs[i] * mFreqs[i + 1]));
+        }
+    }
+
+    // response in dB at each fit frequency per dB of gain: of every band (G) and every section (A). small boosts and
+    // cuts of a peaking filter scale its dB response almost linearly, and the fitted gains stay within a few dB
+    const int n = mNumBands, m = numSections, p = fitFreqs.size ();
+    vector<double> G (p * n), A (p * m);
+    for (int i = 0; i < p; i++)
+    {
+        for (int j = 0; j < n; j++)
+        {
+            G[i * n + j] = peakResponseDB (mFreqs[j], mQ, 1.0f, fitFreqs[i], mSampleRate);
+        }
+        for (int k = 0; k < m; k++)
+        {
+            A[i * m + k] = peakResponseDB (sectionFreqs[k], sectionQs[k], 1.0f, fitFreqs[i], mSampleRate);
+        }
+    }
+
+    // section gains = (A'A + lambda I)^-1 A'G band gains. the small ridge term keeps neighbouring sections from
+    // fighting each other with large opposite gains
+    vector<double> M (m * m, 0.0), R (m * n, 0.0);
+    double trace = 0.0;
+    for (int a = 0; a < m; a++)
+    {
+        for (int b = 0; b < m; b++)
+        {
+            double sum = 0.0;
+            for (int i = 0; i < p; i++)
+            {
+                sum += A[i * m + a] * A[i * m + b];
+            }
+            M[a * m + b] = sum;
+        }
+        trace += M[a * m + a];
+
+        for (int j = 0; j < n; j++)
+        {
+            double sum = 0.0;
+            for (int i = 0; i < p; i++)
+            {
+                sum += A[i * m + a] * G[i * n + j];
+            }
+            R[a * n + j] = sum;
+        }
+    }
+
+    const double lambda = 1.0e-3 * trace / m;
+    for (int a = 0; a < m; a++)
+    {
+        M[a * m + a] += lambda;
+    }
+
+    // Gauss-Jordan elimination. M is symmetric positive definite, so no pivoting is needed
+    for (int r = 0; r < m; r++)
+    {
+        const double pivot = M[r * m + r];
+        for (int b = 0; b < m; b++)
+        {
+            M[r * m + b] /= pivot;
+        }
+        for (int j = 0; j < n; j++)
+        {
+            R[r * n + j] /= pivot;
+        }
+
+        for (int a = 0; a < m; a++)
+        {
+            const double factor = M[a * m + r];
+            if (a == r || factor == 0.0)
+            {
+                continue;
+            }
+
+            for (int b = 0; b < m; b++)
+            {
+                M[a * m + b] -= factor * M[r * m + b];
+            }
+            for (int j = 0; j < n; j++)
+            {
+                R[a * n + j] -= factor * R[r * n + j];
+            }
+        }
+    }
+
+    for (int k = 0; k < m * n; k++)
+    {
+        mReducedFit[k] = (float) R[k];
+    }
+}
+
+double Equalizer::peakResponseDB (float fc, float Q, float gainDB, float freq, float sampleRate)
+{
+    Biquad bq (bq_type_peak, fc / sampleRate, Q, gainDB);
+    double c[5];
+    bq.getCoefficients (c);
+
+    // |H(e^jw)|^2 with the {a0, a1, a2, b1, b2} coefficients @see Biquad::getCoefficients
+    const double w = 2.0 * double_Pi * freq / sampleRate;
+    const double cw = std::cos (w), c2w = std::cos (2.0 * w);
+    const double num = c[0] * c[0] + c[1] * c[1] + c[2] * c[2] + 2.0 * (c[0] * c[1] + c[1] * c[2]) * cw +
+                       2.0 * c[0] * c[2] * c2w;
+    const double den = 1.0 + c[3] * c[3] + c[4] * c[4] + 2.0 * (c[3] + c[3] * c[4]) * cw + 2.0 * c[4] * c2w;
+
+    return 10.0 * std::log10 (num / den);
+}
+}
@@ -29,20 +29,57 @@ using std::vector;
 namespace Audealize
 {
 /// An N-band graphic equalizer made up of NChannelFilter. Construct with a vector of center frequencies and a sample rate.
+///
+/// Bands whose gain is within a hundredth of a dB of 0 are nearly identity filters, so they are dropped from the
+/// cascade: the cost of processing is proportional to the number of bands that actually shape the sound. A band is
+/// faded out over sectionFadeSamples before it's dropped, and its state is flushed so it comes back from silence. The
+/// thresholds for dropping and restoring a band are apart, so a gain that hovers around them doesn't toggle it.
+///
+/// The equalizer can trade accuracy for CPU with setQuality (). In kQualityReducedSections the curve is approximated
+/// by half as many wider sections, whose gains are fitted by least squares to the response of the full cascade at the
+/// band centers; the fit is precomputed whenever the frequencies, Q or sample rate change.
+///
+/// setKernel () selects how a channel is run through the cascade. kKernelBlockStateSpace filters each section several
+/// samples at a time with BlockStateSpaceSection, which gives a single channel the SIMD parallelism that LaneEqualizer
+/// gets from running several signals at once.
 class Equalizer : public AudioEffect
 {
 public:
+    enum Quality
+    {
+        kQualityFull = 0,          // every band that isn't at unity gain
+        kQualitySkipFlatBands,     // bands within 0.05 dB of unity are left out of the cascade too
+        kQualityReducedSections    // fitted half-size cascade, also skipping flat sections
+    };
+
+    enum Kernel
+    {
+        kKernelPerSample = 0,    // every sample through every section in turn
+        kKernelBlockStateSpace   // each section over the whole block, blockLength samples at a time
+    };
+
+    static const int crossfadeSamples = 512;   // length of the crossfade when switching filter banks
+    static const int sectionFadeSamples = 128;  // length of the fade when a band is dropped or restored
+
     Equalizer (vector<float> freqs, float sampleRate)
         : AudioEffect (sampleRate), mFilters (freqs.size ()), mFreqs (freqs.size (), 0.0f), mGains (freqs.size (), 0.0f)
     {
         mQ = 4.31f;
         mChannels = 2;
         mNumBands = freqs.size ();
+        mQuality = kQualityFull;
+        mFadeFrom = kQualityFull;
+        mKernel = kKernelPerSample;
+        mFadeRemaining.resize (mChannels, 0);
+        mChannelUsed.resize (mChannels, false);
+        mBandsDirty = mReducedDirty = true;
+        mSamplesSinceUpdate = 0;
         setFreqs (freqs);
     }
 
     /**
-     *  Process a single sample of audio
+     *  Process a single sample of audio. Gain changes are applied before the next sample, so an Equalizer can be
+     *  driven by this alone; quality changes don't crossfade as they do in processBlock
      *
      *  @param sample     A float audio sample
      *  @param channelIdx Channel index [0, num channels)
@@ -51,13 +88,136 @@ public:
      */
     float processSample (float sample, int channelIdx)
     {
-        float in = sample;
-        for (int i = 0; i < mFilters.size (); i++)
+        // fades only finish in updateQuality, so while sections are fading it runs once per fade length
+        const bool fading = mBandSchedule.numFading > 0 || mReducedSchedule.numFading > 0;
+
+        if (!mStarted || mBandsDirty || (mQuality == kQualityReducedSections && mReducedDirty) ||
+            (fading && channelIdx == 0 && ++mSamplesSinceUpdate >= sectionFadeSamples))
         {
-            in = mFilters[i].processSample (in, channelIdx);
+            updateQuality ();
         }
+        mChannelUsed[channelIdx] = true;
 
-        return in;
+        return processPath (sample, channelIdx, mQuality);
+    }
+
+    /**
+     *  Process a block of audio, applying any pending quality change
+     *
+     *  @param samples    Pointer to an array of audio samples
+     *  @param numSamples Number of samples
+     *  @param channelIdx Channel index
+     */
+    void processBlock (float* const samples, int numSamples, int channelIdx) override
+    {
+        // channels are processed one after the other: changes are applied before the first one
+        if (channelIdx == 0)
+        {
+            updateQuality ();
+        }
+        mChannelUsed[channelIdx] = true;
+
+        int& fade = mFadeRemaining[channelIdx];
+        int i = 0;
+
+        // the previous bank keeps running until the new one has faded in
+        for (; i < numSamples && fade > 0; i++, fade--)
+        {
+            const float from = processPath (samples[i], channelIdx, mFadeFrom);
+            const float to = processPath (samples[i], channelIdx, mQuality);
+            samples[i] = to + (from - to) * ((float) fade / crossfadeSamples);
+        }
+
+        // sections that are fading are mixed sample by sample
+        if (mKernel == kKernelBlockStateSpace && i < numSamples)
+        {
+            const bool reduced = mQuality == kQualityReducedSections;
+            SectionSchedule& schedule = reduced ? mReducedSchedule : mBandSchedule;
+
+            if (schedule.numFading == 0)
+            {
+                schedule.processBlockStateSpace (reduced ? mReducedFilters : mFilters,
+                                                 reduced ? mReducedStateSpace : mStateSpace, samples + i,
+                                                 numSamples - i, channelIdx);
+                return;
+            }
+        }
+
+        for (; i < numSamples; i++)
+        {
+            samples[i] = processPath (samples[i], channelIdx, mQuality);
+        }
+    }
+
+    /**
+     *  Selects how processBlock runs the cascade. Both kernels produce the same output to within float rounding, so
+     *  this can be changed at any time
+     *
+     *  @param kernel @see Equalizer::Kernel
+     */
+    void setKernel (Kernel kernel)
+    {
+        mKernel = kernel;
+    }
+
+    /**
+     *  Returns the kernel processBlock uses. @see Equalizer::Kernel
+     */
+    Kernel getKernel ()
+    {
+        return mKernel;
+    }
+
+    /**
+     *  Sets how accurately the curve is reproduced. Switching to or from kQualityReducedSections crossfades between
+     *  the two filter banks over crossfadeSamples; switching between kQualityFull and kQualitySkipFlatBands only
+     *  changes which bands are dropped, and they fade out/in individually. Call from the thread that processes the
+     *  audio.
+     *
+     *  @param quality @see Equalizer::Quality
+     */
+    void setQuality (Quality quality)
+    {
+        if (quality == mQuality)
+        {
+            return;
+        }
+
+        if ((quality == kQualityReducedSections) != (mQuality == kQualityReducedSections))
+        {
+            // the bank fading in has been idle: start it from silence, with its sections already in
+            if (quality == kQualityReducedSections)
+            {
+                refitReducedSections ();
+                mReducedSchedule.start (mReducedFilters, getThresholds (quality).restore);
+            }
+            else
+            {
+                mBandSchedule.start (mFilters, getThresholds (quality).restore);
+            }
+
+            mFadeFrom = mQuality;
+            std::fill (mFadeRemaining.begin (), mFadeRemaining.end (), crossfadeSamples);
+        }
+
+        mQuality = quality;
+        mBandsDirty = true;
+    }
+
+    /**
+     *  Returns the number of filter sections currently being run, including those fading in or out
+     */
+    int getNumActiveSections ()
+    {
+        return mQuality == kQualityReducedSections ? mReducedSchedule.active.size () : mBandSchedule.active.size ();
+    }
+
+    /**
+     *  Returns the current quality. @see Equalizer::Quality
+     */
+    Quality getQuality ()
+    {
+        return mQuality;
     }
 
     /**
@@ -84,6 +244,7 @@ public:
             mNumBands = freqs.size ();
             mFilters.resize (mNumBands);
             mFreqs.resize (mNumBands);
+            mGains.resize (mNumBands, 0.0f);
         }
 
         for (int i = 0; i < mNumBands; i++)
@@ -93,6 +254,13 @@ public:
             mFilters[i].setNumChannels (mChannels);
             mFilters[i].setFilter (bq_type_peak, freqs[i], mQ, mGains[i], mSampleRate);
         }
+
+        mBandSchedule.resize (mNumBands, mChannels);
+        mStateSpace.resize (mNumBands);
+        mBandsDirty = true;
+        mStarted = false;
+
+        calcReducedSections ();
     }
 
     /**
@@ -119,6 +287,9 @@ public:
     {
         mGains[bandIdx] = gainDB;
         mFilters[bandIdx].setGain (gainDB);
+
+        mBandsDirty = true;
+        mReducedDirty = true;
     }
 
     /**
@@ -168,6 +339,19 @@ public:
         return mFilters[bandIdx].getGain ();
     }
 
+    /**
+     *  Sets the number of audio channels the filters process
+     *
+     *  @param numChannels New number of channels
+     */
+    void setNumChannels (int numChannels)
+    {
+        mChannels = numChannels;
+        mFadeRemaining.assign (mChannels, 0);
+        mChannelUsed.assign (mChannels, false);
+        setFreqs (mFreqs);
+    }
+
     /**
      *  Returns the number of channels (1 = mono, 2 = stereo, etc..) Not bands!
      *
@@ -178,11 +362,235 @@ public:
         return mChannels;
     }
 
+    /**
+     *  Returns the number of eq bands
+     */
+    int getNumBands ()
+    {
+        return mNumBands;
+    }
+
+    /**
+     *  Returns one of the filters in the bank given its index
+     *
+     *  @param bandIdx index of the filter
+     */
+    NChannelFilter& getFilter (int bandIdx)
+    {
+        return mFilters[bandIdx];
+    }
+
+    /**
+     *  Applies any pending gain or quality change, finishes every fade and returns the biquads of one channel that
+     *  processBlock now runs, in cascade order. Lets the current cascade be run outside of the Equalizer,
+     *  @see BiquadCascade. Call from the thread that processes the audio.
+     *
+     *  @param biquads    Receives the biquads. Dropped sections aren't included
+     *  @param channelIdx Channel index
+     */
+    void getActiveBiquads (vector<Biquad*>& biquads, int channelIdx);
+
+    /**
+     *  Takes over the quality setting and filter state of another Equalizer with the same bands and channels, so this
+     *  one can carry on filtering the same signal with its own gains. Call from the thread that processes the audio.
+     *
+     *  @param other The Equalizer to copy
+     */
+    void copyStateFrom (Equalizer& other);
+
+    /**
+     *  Adds the memory allocated by the filter banks and section schedules to a MemoryUsage
+     */
+    void addMemoryUsage (MemoryUsage& usage) override
+    {
+        usage.dspState += getSizeInBytes (mFilters) + getSizeInBytes (mReducedFilters) + MemoryUsage::sizeOf (mFreqs) +
+                          MemoryUsage::sizeOf (mGains) + MemoryUsage::sizeOf (mReducedFit) +
+                          MemoryUsage::sizeOf (mFadeRemaining) + MemoryUsage::sizeOf (mChannelUsed) +
+                          mBandSchedule.getSizeInBytes () + mReducedSchedule.getSizeInBytes () +
+                          MemoryUsage::sizeOf (mStateSpace) + MemoryUsage::sizeOf (mReducedStateSpace);
+    }
+
 private:
     vector<NChannelFilter> mFilters;
     vector<float> mFreqs, mGains;
     int mChannels, mNumBands;
     float mQ;
+
+    /// The sections of a filter bank that are being run. Sections are dropped when their gain falls below one
+    /// threshold and restored when it rises above a higher one; either way they are faded over sectionFadeSamples.
+    struct SectionSchedule
+    {
+        enum State
+        {
+            kOut = 0,
+            kFadingIn,
+            kIn,
+            kFadingOut
+        };
+
+        vector<int> active;   // sections being run, in cascade order
+        vector<char> state;   // @see SectionSchedule::State, per section
+        vector<float> mix;    // [section][channel]: 0 = bypassed, 1 = fully in
+        int numChannels = 0;
+        int numFading = 0;
+
+        void resize (int numSections, int channels);
+
+        size_t getSizeInBytes () const
+        {
+            return MemoryUsage::sizeOf (active) + MemoryUsage::sizeOf (state) + MemoryUsage::sizeOf (mix);
+        }
+
+        /**
+         *  Flushes every section and starts those above the restore threshold fully in
+         */
+        void start (vector<NChannelFilter>& bank, float restoreThreshold);
+
+        /**
+         *  Starts fades for sections that crossed a threshold and drops sections that have faded out
+         *
+         *  @param channelUsed Whether each channel has been processed since the last update. Fades in channels
+         *                     that weren't are completed immediately
+         */
+        void update (vector<NChannelFilter>& bank, float dropThreshold, float restoreThreshold,
+                     const vector<bool>& channelUsed);
+
+        /**
+         *  Runs a sample through the active sections of a bank
+         */
+        inline float process (vector<NChannelFilter>& bank, float in, int channelIdx)
+        {
+            if (numFading == 0)
+            {
+                for (int i = 0; i < active.size (); i++)
+                {
+                    in = bank[active[i]].processSample (in, channelIdx);
+                }
+                return in;
+            }
+
+            const float step = 1.0f / sectionFadeSamples;
+            for (int i = 0; i < active.size (); i++)
+            {
+                const int k = active[i];
+                const float out = bank[k].processSample (in, channelIdx);
+
+                if (state[k] == kIn)
+                {
+                    in = out;
+                    continue;
+                }
+
+                float& w = mix[k * numChannels + channelIdx];
+                in += (out - in) * w;
+                w = state[k] == kFadingIn ? jmin (1.0f, w + step) : jmax (0.0f, w - step);
+            }
+            return in;
+        }
+
+        /**
+         *  Runs a block through the active sections of a bank one section at a time, using their block state space
+         *  forms. Only valid while no section is fading
+         *
+         *  @param forms The state space form of each section of the bank, updated if the coefficients changed
+         */
+        void processBlockStateSpace (vector<NChannelFilter>& bank, vector<BlockStateSpaceSection>& forms,
+                                     float* samples, int numSamples, int channelIdx)
+        {
+            jassert (numFading == 0);
+
+            for (int i = 0; i < active.size (); i++)
+            {
+                const int k = active[i];
+                Biquad& biquad = bank[k].getBiquad (channelIdx);
+
+                double coeffs[5], state[2];
+                biquad.getCoefficients (coeffs);
+                biquad.getState (state);
+
+                forms[k].update (coeffs);
+                forms[k].process (samples, numSamples, state);
+                biquad.setState (state);
+            }
+        }
+    };
+
+    /// Gains in dB below which sections are dropped and above which they are restored
+    struct Thresholds
+    {
+        float drop, restore;
+    };
+
+    Quality mQuality, mFadeFrom;
+    Kernel mKernel;
+    vector<int> mFadeRemaining;  // samples left in the crossfade from mFadeFrom, per channel
+    vector<bool> mChannelUsed;   // channels processed since the last updateQuality
+    int mSamplesSinceUpdate;     // samples of channel 0 processSample has run while fading, since updateQuality
+
+    SectionSchedule mBandSchedule;
+    bool mBandsDirty;
+    bool mStarted;  // false until the first block after the filters were set up: nothing to fade from yet
+
+    vector<NChannelFilter> mReducedFilters;
+    vector<float> mReducedFit;  // [section][band]: fitted section gain per dB of band gain
+    SectionSchedule mReducedSchedule;
+    bool mReducedDirty;
+
+    vector<BlockStateSpaceSection> mStateSpace, mReducedStateSpace;  // per section of mFilters / mReducedFilters
+
+    /**
+     *  Returns the memory allocated by a filter bank, in bytes
+     */
+    static size_t getSizeInBytes (const vector<NChannelFilter>& bank)
+    {
+        size_t size = MemoryUsage::sizeOf (bank);
+        for (const NChannelFilter& filter : bank)
+        {
+            size += filter.getSizeInBytes ();
+        }
+        return size;
+    }
+
+    /**
+     *  Runs a sample through the filters used by one quality setting
+     */
+    inline float processPath (float in, int channelIdx, Quality quality)
+    {
+        if (quality == kQualityReducedSections)
+        {
+            return mReducedSchedule.process (mReducedFilters, in, channelIdx);
+        }
+
+        return mBandSchedule.process (mFilters, in, channelIdx);
+    }
+
+    static Thresholds getThresholds (Quality quality);
+
+    /**
+     *  Updates which sections are run after the gains or quality changed, and moves fades along
+     */
+    void updateQuality ();
+
+    /**
+     *  Sets up the schedule of the bank used by the current quality from scratch, with no fades
+     */
+    void startSchedule ();
+
+    /**
+     *  Sets the gains of the reduced sections from the band gains
+     */
+    void refitReducedSections ();
+
+    /**
+     *  Lays out the reduced sections and precomputes the least squares fit of their gains. Called whenever the
+     *  frequencies, Q or sample rate change
+     */
+    void calcReducedSections ();
+
+    /**
+     *  Returns the response in dB of a peaking filter at a frequency
+     */
+    static double peakResponseDB (float fc, float Q, float gainDB, float freq, float sampleRate);
 };
 
 }  // namespace Audealize
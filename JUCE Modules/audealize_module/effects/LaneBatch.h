@@ -0,0 +1,364 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+/*
+    Lane-batched versions of the Equalizer and Reverb. Each lane carries a different mono signal through the same
+    coefficient set, so the innermost loops run across lanes and are vectorised by the compiler: one lane per float
+    in a SIMD register (16 with AVX-512, 8 with AVX/AVX2, 4 otherwise).
+
+    Audio is passed as lane-interleaved blocks: sample n of lane l is at block[n * numLanes + l]. The kernels mostly
+    run in single precision, so they match the scalar effects to within float rounding rather than bit for bit.
+*/
+
+#ifndef LaneBatch_h
+#define LaneBatch_h
+
+#if defined(__AVX512F__)
+#define AUDEALIZE_NUM_LANES 16
+#elif defined(__AVX__)
+#define AUDEALIZE_NUM_LANES 8
+#else
+#define AUDEALIZE_NUM_LANES 4
+#endif
+
+using std::vector;
+
+namespace Audealize
+{
+/// An Equalizer filter bank that processes AUDEALIZE_NUM_LANES mono signals at once.
+///
+/// Sections whose poles sit close to the unit circle (the low bands) lose too much accuracy in single precision, so
+/// they are run in double precision lanes. The sections of a cascade commute, so these are simply run first.
+class LaneEqualizer
+{
+public:
+    static const int numLanes = AUDEALIZE_NUM_LANES;
+
+    LaneEqualizer ()
+    {
+    }
+
+    /**
+     *  Copies the filter coefficients of an Equalizer (channel 0) and clears the state of every lane
+     *
+     *  @param eq The Equalizer to copy
+     */
+    void setCoefficients (Equalizer& eq)
+    {
+        mDouble.clear ();
+        mFloat.clear ();
+
+        for (int i = 0; i < eq.getNumBands (); i++)
+        {
+            double c[5];
+            eq.getFilter (i).getBiquad (0).getCoefficients (c);
+
+            // b2 is the squared pole radius
+            if (c[4] > 0.99)
+            {
+                mDouble.addSection (c);
+            }
+            else
+            {
+                mFloat.addSection (c);
+            }
+        }
+
+        mDouble.allocate ();
+        mFloat.allocate ();
+    }
+
+    /**
+     *  Clears the filter state of one lane, e.g. before it starts on a new signal
+     */
+    void resetLane (int lane)
+    {
+        mDouble.resetLane (lane);
+        mFloat.resetLane (lane);
+    }
+
+    /**
+     *  Filters a lane-interleaved block in place
+     *
+     *  @param block     numFrames * numLanes samples
+     *  @param numFrames Number of samples per lane
+     */
+    void process (float* block, int numFrames)
+    {
+        double x[numLanes];
+
+        for (int n = 0; n < numFrames; n++)
+        {
+            float* frame = block + n * numLanes;
+
+            if (mDouble.numSections > 0)
+            {
+                for (int l = 0; l < numLanes; l++)
+                {
+                    x[l] = frame[l];
+                }
+
+                mDouble.process (x);
+
+                for (int l = 0; l < numLanes; l++)
+                {
+                    frame[l] = (float) x[l];
+                }
+            }
+
+            mFloat.process (frame);
+        }
+    }
+
+private:
+    /// Coefficients and per-lane state of a group of sections, in one precision
+    template <typename T>
+    struct Sections
+    {
+        int numSections = 0;
+        vector<T> coeffs;      // {a0, a1, a2, b1, b2} per section
+        HeapBlock<T> z1, z2;  // [section][lane]
+
+        void clear ()
+        {
+            numSections = 0;
+            coeffs.clear ();
+        }
+
+        void addSection (const double* c)
+        {
+            for (int k = 0; k < 5; k++)
+            {
+                coeffs.push_back ((T) c[k]);
+            }
+            numSections++;
+        }
+
+        void allocate ()
+        {
+            z1.calloc (jmax (1, numSections) * numLanes);
+            z2.calloc (jmax (1, numSections) * numLanes);
+        }
+
+        void resetLane (int lane)
+        {
+            for (int i = 0; i < numSections; i++)
+            {
+                z1[i * numLanes + lane] = z2[i * numLanes + lane] = 0;
+            }
+        }
+
+        /**
+         *  Runs one frame (one sample of every lane) through the sections
+         */
+        inline void process (T* x)
+        {
+            for (int i = 0; i < numSections; i++)
+            {
+                const T a0 = coeffs[i * 5], a1 = coeffs[i * 5 + 1], a2 = coeffs[i * 5 + 2];
+                const T b1 = coeffs[i * 5 + 3], b2 = coeffs[i * 5 + 4];
+                T* s1 = z1 + i * numLanes;
+                T* s2 = z2 + i * numLanes;
+
+                for (int l = 0; l < numLanes; l++)
+                {
+                    const T in = x[l];
+                    const T out = in * a0 + s1[l];
+                    s1[l] = in * a1 + s2[l] - b1 * out;
+                    s2[l] = in * a2 - b2 * out;
+                    x[l] = out;
+                }
+            }
+        }
+    };
+
+    Sections<double> mDouble;  // sections with poles close to the unit circle
+    Sections<float> mFloat;
+
+    JUCE_DECLARE_NON_COPYABLE (LaneEqualizer)
+};
+
+/// The mono processing path of Reverb for AUDEALIZE_NUM_LANES signals at once. All lanes share one write position,
+/// so the delay lines are stored interleaved ([sample][lane]) and every read/write is a contiguous lane vector.
+class LaneReverb
+{
+public:
+    static const int numLanes = AUDEALIZE_NUM_LANES;
+    static const int delaySize = 9600;  // same as the Reverb's delay lines
+
+    LaneReverb () : mPos (0)
+    {
+        for (int i = 0; i < kNumLines; i++)
+        {
+            mLines[i].calloc (delaySize * numLanes);
+        }
+        mLowpassZ1.calloc (numLanes);
+        mLowpassZ2.calloc (numLanes);
+    }
+
+    /**
+     *  Copies the current settings of a Reverb and clears the state of every lane
+     *
+     *  @param reverb The Reverb to copy
+     */
+    void setCoefficients (Reverb& reverb)
+    {
+        mCoeffs = reverb.getCoefficients ();
+        for (int i = 0; i < 5; i++)
+        {
+            mLowpass[i] = (float) mCoeffs.lowpass[i];
+        }
+
+        for (int lane = 0; lane < numLanes; lane++)
+        {
+            resetLane (lane);
+        }
+        mPos = 0;
+    }
+
+    /**
+     *  Clears the delay lines and filter state of one lane, e.g. before it starts on a new signal
+     */
+    void resetLane (int lane)
+    {
+        for (int i = 0; i < kNumLines; i++)
+        {
+            for (int n = 0; n < delaySize; n++)
+            {
+                mLines[i][n * numLanes + lane] = 0.0f;
+            }
+        }
+        mLowpassZ1[lane] = mLowpassZ2[lane] = 0.0f;
+    }
+
+    /**
+     *  Processes a lane-interleaved block in place
+     *
+     *  @param block     numFrames * numLanes samples
+     *  @param numFrames Number of samples per lane
+     */
+    void process (float* block, int numFrames)
+    {
+        const Reverb::Coefficients& c = mCoeffs;
+        const float smallValue = 1.0f / 16777216.0f;  // see dsp::sanitize
+
+        float combSum[numLanes], rev[numLanes];
+
+        for (int n = 0; n < numFrames; n++)
+        {
+            float* x = block + n * numLanes;
+            const int writeIdx = mPos * numLanes;
+
+            // comb filter network
+            for (int l = 0; l < numLanes; l++)
+            {
+                combSum[l] = 0.0f;
+            }
+            for (int i = 0; i < 6; i++)
+            {
+                float* line = mLines[kComb0 + i];
+                const float* old = line + readIndex (c.combDelay[i]);
+                const float fb = c.combGain[i];
+
+                for (int l = 0; l < numLanes; l++)
+                {
+                    const float o = old[l];
+                    const float cur = x[l] * c.wet + fb * o;
+                    line[writeIdx + l] = std::abs (cur) < smallValue ? 0.0f : cur;
+                    combSum[l] += o;
+                }
+            }
+
+            // allpass filter
+            {
+                float* line = mLines[kAllpass];
+                const float* old = line + readIndex (c.allpassDelay);
+
+                for (int l = 0; l < numLanes; l++)
+                {
+                    const float o = old[l];
+                    float cur = combSum[l] + ALLPASSGAIN * o;
+                    cur = std::abs (cur) < smallValue ? 0.0f : cur;
+                    line[writeIdx + l] = cur;
+                    rev[l] = o - ALLPASSGAIN * cur;
+                }
+            }
+
+            // lowpass filter, reverb gain and mix with the delayed dry signal
+            {
+                float* line = mLines[kDry];
+                const float* old = line + readIndex (c.dryDelay);
+                const float a0 = mLowpass[0], a1 = mLowpass[1], a2 = mLowpass[2], b1 = mLowpass[3], b2 = mLowpass[4];
+
+                for (int l = 0; l < numLanes; l++)
+                {
+                    const float in = rev[l];
+                    const float out = in * a0 + mLowpassZ1[l];
+                    mLowpassZ1[l] = in * a1 + mLowpassZ2[l] - b1 * out;
+                    mLowpassZ2[l] = in * a2 - b2 * out;
+
+                    const float dry = x[l];
+                    const float delayed = c.wet * old[l] * c.gainclean;
+                    line[writeIdx + l] = dry;
+
+                    x[l] = (delayed + out * c.gain) * .5f * c.gainscale + dry * c.dry;
+                }
+            }
+
+            if (++mPos == delaySize)
+            {
+                mPos = 0;
+            }
+        }
+    }
+
+private:
+    enum Lines
+    {
+        kComb0 = 0,
+        kAllpass = 6,
+        kDry,
+        kNumLines
+    };
+
+    Reverb::Coefficients mCoeffs;
+    float mLowpass[5];
+
+    HeapBlock<float> mLines[kNumLines];         // [sample][lane]
+    HeapBlock<float> mLowpassZ1, mLowpassZ2;   // [lane]
+    int mPos;                                   // shared write position of every line
+
+    /**
+     *  Returns the offset of the lane vector written delay samples ago
+     */
+    inline int readIndex (unsigned int delay) const
+    {
+        return ((mPos + delaySize - (int) delay) % delaySize) * numLanes;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (LaneReverb)
+};
+
+}  // namespace Audealize
+
+#endif /* LaneBatch_h */
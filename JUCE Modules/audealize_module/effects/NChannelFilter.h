@@ -184,6 +184,24 @@ public:
         return mGain;
     }
 
+    /**
+     *  Returns the Biquad that processes one of the channels
+     *
+     *  @param channelIdx Channel index
+     */
+    Biquad& getBiquad (int channelIdx)
+    {
+        return filters[channelIdx];
+    }
+
+    /**
+     *  Returns the memory allocated for the per-channel filters, in bytes
+     */
+    size_t getSizeInBytes () const
+    {
+        return MemoryUsage::sizeOf (filters);
+    }
+
 private:
     vector<Biquad> filters;  // vector of the filters
     int mChannels;           // number of audio channels to be processed
@@ -43,16 +43,35 @@ using std::to_string;
 namespace Audealize
 {
 /// A parametric reverberator
+///
+/// The reverberation network (combs, allpasses, lowpass and the delayed clean signal) can be run at half the sample
+/// rate and with fewer combs to save CPU, @see Reverb::setQuality. The dry signal is always mixed in at full rate.
 class Reverb : AudioEffect
 {
 public:
-    Reverb () : mComb (6), mAllpass (2), mDelay (2)
+    Reverb ()
     {
         // Initialize samples to 0
         mSample[0] = mSample[1] = 0;
         mLowpass = NChannelFilter (bq_type_lowpass, 2, f, 1.0f, 0.0f, mSampleRate);
         da = 0.006f + MINDELAY;
 
+        mHalfRate = false;
+        mNetworkRate = mSampleRate;
+        mPhase = 0;
+        mAccum[0] = mAccum[1] = 0.0f;
+        mPrevOut[0] = mPrevOut[1] = mLastOut[0] = mLastOut[1] = 0.0f;
+
+        mNumCombs = 6;
+        mCombsFading = false;
+        mCombStep = 0.0f;
+        for (int i = 0; i < 6; i++)
+        {
+            mCombWeight[i] = mCombTarget[i] = 1.0f;
+        }
+        mScratch.calloc (9600);
+        mStage.calloc (kNumStageBuffers * stageSize);
+
         resetBuffs ();
     }
 
@@ -68,42 +87,7 @@ public:
      */
     void processMonoBlock (float* channelData, int blockSize)
     {
-        float samp, sampRev, sampDry, sampOut;
-
-        for (int i = 0; i < blockSize; i++)
-        {
-            sampDry = channelData[i];
-
-            // Process sample through comb filter network
-            sampRev = processCombs (sampDry * wet);
-
-            // Process allpass filter
-            sampRev = mAllpass[0].process_allpass_comb (sampRev, mDelayVal[0] * mSampleRate, ALLPASSGAIN);
-
-            // Process lowpass filter
-            sampRev = mLowpass.processSample (sampRev, 0);
-
-            sampRev *= gain;
-
-            // Delay unprocessed signal to match phase shift caused by the delayed comb filters
-            samp = wet * mDelay[0].process (sampDry, MINDELAY * mSampleRate);
-
-            samp *= gainclean;
-
-            // Average clean and filtered samples
-            samp = (samp + sampRev) * .5f;
-
-            samp *= gainscale;
-
-            sampDry *= dry;
-
-            // Write processed sample back to the buffer
-            sampOut = samp + sampDry;
-            // DBG ("processing mono");
-
-            JUCE_UNDENORMALISE (sampOut);
-            channelData[i] = sampOut;
-        }
+        processBlock (&channelData, 1, blockSize);
     }
 
     /**
@@ -115,58 +99,8 @@ public:
      */
     void processStereoBlock (float* channelData1, float* channelData2, int blockSize)
     {
-        float sampL, sampR, sampRevL, sampRevR, sampDryL, sampDryR, sampSum, sampOutL, sampOutR;
-
-        for (int i = 0; i < blockSize; i++)
-        {
-            sampDryL = channelData1[i];
-            sampDryR = channelData2[i];
-
-            // Average left and right channels for comb network
-            sampSum = sampDryL + sampDryR;
-            sampSum *= 0.5f;
-            sampSum *= wet;
-            // Process sample through comb filter network
-            sampRevL = sampRevR = processCombs (sampSum);
-
-            // Process allpass filters
-            sampRevL = mAllpass[0].process_allpass_comb (sampRevL, mDelayVal[0] * mSampleRate, ALLPASSGAIN);
-
-            sampRevR = mAllpass[1].process_allpass_comb (sampRevR, mDelayVal[1] * mSampleRate, ALLPASSGAIN);
-
-            // Process lowpass filters
-            sampRevL = mLowpass.processSample (sampRevL, 0);
-            sampRevR = mLowpass.processSample (sampRevR, 1);
-
-            sampRevL *= gain;
-            sampRevR *= gain;
-
-            // Delay unprocessed signal to match phase shift caused by the delayed comb filters
-            sampL = wet * mDelay[0].process (sampDryL, MINDELAY * mSampleRate);
-            sampR = wet * mDelay[1].process (sampDryR, MINDELAY * mSampleRate);
-
-            sampL *= gainclean;
-            sampR *= gainclean;
-
-            // Average clean and filtered samples
-            sampL = (sampL + sampRevL) * .5f;
-            sampR = (sampR + sampRevR) * .5f;
-
-            sampL *= gainscale;
-            sampR *= gainscale;
-
-            sampDryL *= dry;
-            sampDryR *= dry;
-
-            // Write processed sample back to the buffer
-            sampOutL = sampDryL + sampL;
-            sampOutR = sampDryR + sampR;
-
-            JUCE_UNDENORMALISE (sampOutL);
-            JUCE_UNDENORMALISE (sampOutR);
-            channelData1[i] = sampOutL;
-            channelData2[i] = sampOutR;
-        }
+        float* channels[2] = {channelData1, channelData2};
+        processBlock (channels, 2, blockSize);
     }
 
     /**
@@ -176,7 +110,8 @@ public:
     void init (float d_val, float g_val, float m_val, float f_val, float E_val, float wetdry_val, float sampleRate)
     {
         mSampleRate = sampleRate;
-        mLowpass.setSampleRate (sampleRate);
+        mNetworkRate = mHalfRate ? sampleRate * .5f : sampleRate;
+        mLowpass.setSampleRate (mNetworkRate);
         set_d (d_val);
         set_g (g_val);
         set_m (m_val);
@@ -192,26 +127,195 @@ public:
     void setSampleRate (float sampleRate)
     {
         mSampleRate = sampleRate;
-        mLowpass.setSampleRate (sampleRate);
+        mNetworkRate = mHalfRate ? sampleRate * .5f : sampleRate;
+        mLowpass.setSampleRate (mNetworkRate);
         set_m (m);
         set_d (d);
+        set_f (f);
         resetBuffs ();
     }
 
+    /**
+     *  Sets how much of the network is run. Changes are applied without interrupting the reverb tail: combs that
+     *  are dropped or added are faded out/in over 20 ms, and when the rate changes, the contents of the delay lines
+     *  are resampled to the new rate. Call from the thread that processes the audio.
+     *
+     *  @param halfRate true to run the network at half the sample rate
+     *  @param numCombs Number of comb filters to run [1, 6]. The combs with the shortest delays are dropped first
+     */
+    void setQuality (bool halfRate, int numCombs)
+    {
+        numCombs = jlimit (1, 6, numCombs);
+
+        if (halfRate != mHalfRate)
+        {
+            resampleLines (halfRate);
+
+            mHalfRate = halfRate;
+            mNetworkRate = halfRate ? mSampleRate * .5f : mSampleRate;
+            mLowpass.setSampleRate (mNetworkRate);
+            set_m (m);
+            set_d (d);
+            set_f (f);
+
+            // the interpolation continues from the last full rate output
+            mPhase = 0;
+            mAccum[0] = mAccum[1] = 0.0f;
+            mPrevOut[0] = mLastOut[0];
+            mPrevOut[1] = mLastOut[1];
+        }
+
+        if (numCombs != mNumCombs)
+        {
+            // fewer combs have less energy between them; keep the tail at the same level
+            const float weight = std::sqrt (6.0f / numCombs);
+            for (int i = 0; i < 6; i++)
+            {
+                if (i < numCombs && mCombWeight[i] == 0.0f)
+                {
+                    mComb[i].reset ();
+                }
+                mCombTarget[i] = i < numCombs ? weight : 0.0f;
+            }
+
+            mNumCombs = numCombs;
+            mCombsFading = true;
+        }
+
+        mCombStep = 1.0f / (0.02f * mNetworkRate);
+    }
+
+    /**
+     *  Returns true if the network is running at half the sample rate
+     */
+    bool isHalfRate ()
+    {
+        return mHalfRate;
+    }
+
+    /**
+     *  Returns the number of comb filters being run
+     */
+    int getNumCombs ()
+    {
+        return mNumCombs;
+    }
+
+    /**
+     *  Sets how the delay lines store their samples. The 16 bit formats halve the memory the lines take, and the
+     *  memory traffic of the network, at the cost of some noise in the reverberation, @see DelayLine::Format. The
+     *  contents of the lines are converted, so the tail carries on. Allocates: call from prepareToPlay or while the
+     *  audio isn't running.
+     *
+     *  @param format Storage format of every comb, allpass and clean signal delay line
+     */
+    void setLineFormat (DelayLine::Format format)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            mComb[i].setFormat (format);
+        }
+        for (int c = 0; c < 2; c++)
+        {
+            mAllpass[c].setFormat (format);
+            mDelay[c].setFormat (format);
+        }
+    }
+
+    /**
+     *  Returns the storage format of the delay lines
+     */
+    DelayLine::Format getLineFormat ()
+    {
+        return mComb[0].getFormat ();
+    }
+
+    /**
+     *  Takes over the quality setting and the contents of the delay lines and filters of another Reverb at the same
+     *  sample rate, so this one can carry on the other's tail with its own parameters. The lines keep their own
+     *  storage format. Call from the thread that processes the audio.
+     *
+     *  @param other The Reverb to copy
+     */
+    void copyStateFrom (Reverb& other)
+    {
+        jassert (other.mSampleRate == mSampleRate);
+
+        if (other.mHalfRate != mHalfRate)
+        {
+            mHalfRate = other.mHalfRate;
+            mNetworkRate = other.mNetworkRate;
+            mLowpass.setSampleRate (mNetworkRate);
+            set_m (m);
+            set_d (d);
+            set_f (f);
+        }
+
+        mNumCombs = other.mNumCombs;
+        mCombsFading = other.mCombsFading;
+        mCombStep = other.mCombStep;
+        for (int i = 0; i < 6; i++)
+        {
+            mCombWeight[i] = other.mCombWeight[i];
+            mCombTarget[i] = other.mCombTarget[i];
+        }
+
+        for (int i = 0; i < 6; i++)
+        {
+            mComb[i].copyFrom (other.mComb[i]);
+        }
+        for (int c = 0; c < 2; c++)
+        {
+            mAllpass[c].copyFrom (other.mAllpass[c]);
+            mDelay[c].copyFrom (other.mDelay[c]);
+        }
+
+        double state[2];
+        for (int c = 0; c < 2; c++)
+        {
+            other.mLowpass.getBiquad (c).getState (state);
+            mLowpass.getBiquad (c).setState (state);
+
+            mSample[c] = other.mSample[c];
+            mAccum[c] = other.mAccum[c];
+            mPrevOut[c] = other.mPrevOut[c];
+            mLastOut[c] = other.mLastOut[c];
+        }
+        mPhase = other.mPhase;
+    }
+
+    /**
+     *  Adds the memory allocated by the delay lines and the lowpass filter to a MemoryUsage
+     */
+    void addMemoryUsage (MemoryUsage& usage) override
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            usage.delayMemory += mComb[i].getSizeInBytes ();
+        }
+        for (int c = 0; c < 2; c++)
+        {
+            usage.delayMemory += mAllpass[c].getSizeInBytes () + mDelay[c].getSizeInBytes ();
+        }
+        usage.delayMemory += lineSize * sizeof (float);  // mScratch
+        usage.dspState += kNumStageBuffers * stageSize * sizeof (float);
+        usage.dspState += mLowpass.getSizeInBytes ();
+    }
+
     /**
      *  Zero out all delay/filter buffers
      */
     void resetBuffs ()
     {
-        for (auto d : mAllpass)
+        for (auto& d : mAllpass)
         {
             d.reset ();
         }
-        for (auto d : mComb)
+        for (auto& d : mComb)
         {
             d.reset ();
         }
-        for (auto d : mDelay)
+        for (auto& d : mDelay)
         {
             d.reset ();
         }
@@ -226,7 +330,7 @@ public:
         calc_rt ();
         for (int i = 0; i < 6; i++)
         {
-            mCombDelay[i] = prevPrime (d * (15 - i) / 15.0f * mSampleRate) / mSampleRate;
+            mCombDelay[i] = prevPrime (d * (15 - i) / 15.0f * mNetworkRate) / mNetworkRate;
             mCombGain[i] = powf (.001, mCombDelay[i] / rt);
         }
     }
@@ -240,14 +344,16 @@ public:
     void set_m (float m_val)
     {
         m = m_val;
-        mDelayVal[0] = prevPrime ((da + m / 2) * mSampleRate) / mSampleRate;
-        mDelayVal[1] = prevPrime ((da - m / 2) * mSampleRate) / mSampleRate;
+        mDelayVal[0] = prevPrime ((da + m / 2) * mNetworkRate) / mNetworkRate;
+        mDelayVal[1] = prevPrime ((da - m / 2) * mNetworkRate) / mNetworkRate;
     }
 
     void set_f (float f_val)
     {
         f = f_val;
-        mLowpass.setFreq (f);
+
+        // keep the cutoff below the network's nyquist frequency
+        mLowpass.setFreq (mHalfRate ? jmin (f, 0.45f * mNetworkRate) : f);
     }
 
     void set_E (float E_val)
@@ -302,6 +408,44 @@ public:
         return wetdry;
     }
 
+    /**
+     *  The per-sample values derived from the main reverberator parameters. Lets the reverb be run outside of this
+     *  class (e.g. by the lane-batched offline renderer) with exactly the same delays and gains
+     */
+    struct Coefficients
+    {
+        unsigned int combDelay[6];  // comb filter delays in samples
+        float combGain[6];          // comb filter feedback gains
+        unsigned int allpassDelay;  // delay of the first allpass filter in samples
+        unsigned int dryDelay;      // delay of the unprocessed signal in samples
+        double lowpass[5];          // lowpass filter biquad coefficients @see Biquad::getCoefficients
+        float wet, dry, gain, gainclean, gainscale;
+    };
+
+    /**
+     *  Returns the values the mono processing path currently uses. Only valid at full rate
+     */
+    Coefficients getCoefficients ()
+    {
+        jassert (!mHalfRate);
+
+        Coefficients c;
+        for (int i = 0; i < 6; i++)
+        {
+            c.combDelay[i] = mCombDelay[i] * mSampleRate;
+            c.combGain[i] = mCombGain[i];
+        }
+        c.allpassDelay = mDelayVal[0] * mSampleRate;
+        c.dryDelay = MINDELAY * mSampleRate;
+        mLowpass.getBiquad (0).getCoefficients (c.lowpass);
+        c.wet = wet;
+        c.dry = dry;
+        c.gain = gain;
+        c.gainclean = gainclean;
+        c.gainscale = gainscale;
+        return c;
+    }
+
 private:
     /**
      *  The main reverberator parameters
@@ -319,10 +463,252 @@ private:
 
     float mSample[2], mCombDelay[6], mCombGain[6], mDelayVal[2];
 
-    vector<simple_delay<9600, float>> mComb, mAllpass, mDelay;
+    DelayLine mComb[6], mAllpass[2], mDelay[2];
 
     NChannelFilter mLowpass;
 
+    bool mHalfRate;       // network runs at half the sample rate
+    float mNetworkRate;   // sample rate the network runs at
+    int mPhase;           // position within the current pair of input samples at half rate
+    float mAccum[2];      // sum of the current pair of input samples, per channel
+    float mPrevOut[2], mLastOut[2];  // last two network outputs, per channel
+
+    int mNumCombs;
+    bool mCombsFading;
+    float mCombWeight[6], mCombTarget[6], mCombStep;
+
+    HeapBlock<float> mScratch;  // used when resampling the delay lines
+
+    static const int lineSize = DelayLine::size;
+    static const int stageSize = 256;  // network samples processed per stage
+
+    /// Scratch buffers of the processing stages, stageSize floats each
+    enum StageBuffer
+    {
+        kCombIn = 0,            // comb network input
+        kCombSum,               // comb network output
+        kRev,                   // lowpassed reverberation, per channel
+        kDelayed = kRev + 2,    // delayed clean signal, per channel
+        kNetIn = kDelayed + 2,  // averaged input pairs at half rate, per channel
+        kNumStageBuffers = kNetIn + 2
+    };
+
+    HeapBlock<float> mStage;
+
+    /**
+     *  Processes a block of one or two channels. The network is run in stages of up to stageSize network samples:
+     *  the combs, the allpasses, the lowpass and the clean signal's delay each run over the whole stage in turn.
+     *  The outputs are then mixed with the dry signal in a single pass, with the gains folded together.
+     */
+    void processBlock (float* const* channels, int numChannels, int blockSize)
+    {
+        const float cleanGain = wet * gainclean * .5f * gainscale;  // delayed clean signal
+        const float revGain = gain * .5f * gainscale;               // reverberated signal
+
+        const int chunkSize = mHalfRate ? stageSize * 2 : stageSize;
+        for (int start = 0; start < blockSize; start += chunkSize)
+        {
+            const int numSamples = jmin (chunkSize, blockSize - start);
+
+            if (!mHalfRate)
+            {
+                const float* in[2] = {channels[0] + start, numChannels > 1 ? channels[1] + start : nullptr};
+                runNetwork (in, numChannels, numSamples);
+
+                for (int c = 0; c < numChannels; c++)
+                {
+                    float* data = channels[c] + start;
+                    const float* delayed = stage (kDelayed + c);
+                    const float* rev = stage (kRev + c);
+
+                    for (int i = 0; i < numSamples; i++)
+                    {
+                        float out = delayed[i] * cleanGain + rev[i] * revGain + data[i] * dry;
+                        JUCE_UNDENORMALISE (out);
+                        data[i] = out;
+                    }
+
+                    mLastOut[c] = delayed[numSamples - 1] * cleanGain + rev[numSamples - 1] * revGain;
+                }
+                continue;
+            }
+
+            // average pairs of input samples...
+            const int startPhase = mPhase;
+            int numNetwork = 0;
+            for (int i = 0; i < numSamples; i++)
+            {
+                for (int c = 0; c < numChannels; c++)
+                {
+                    mAccum[c] += channels[c][start + i];
+                }
+
+                if (++mPhase == 2)
+                {
+                    mPhase = 0;
+                    for (int c = 0; c < numChannels; c++)
+                    {
+                        stage (kNetIn + c)[numNetwork] = mAccum[c] * .5f;
+                        mAccum[c] = 0.0f;
+                    }
+                    numNetwork++;
+                }
+            }
+
+            const float* in[2] = {stage (kNetIn), stage (kNetIn + 1)};
+            runNetwork (in, numChannels, numNetwork);
+
+            // ...and interpolate between network outputs
+            for (int c = 0; c < numChannels; c++)
+            {
+                float* data = channels[c] + start;
+                const float* delayed = stage (kDelayed + c);
+                const float* rev = stage (kRev + c);
+                int phase = startPhase, k = 0;
+
+                for (int i = 0; i < numSamples; i++)
+                {
+                    float samp;
+                    if (++phase == 2)
+                    {
+                        phase = 0;
+                        mPrevOut[c] = mLastOut[c];
+                        mLastOut[c] = delayed[k] * cleanGain + rev[k] * revGain;
+                        samp = (mPrevOut[c] + mLastOut[c]) * .5f;
+                        k++;
+                    }
+                    else
+                    {
+                        samp = mLastOut[c];
+                    }
+
+                    float out = samp + data[i] * dry;
+                    JUCE_UNDENORMALISE (out);
+                    data[i] = out;
+                }
+            }
+        }
+    }
+
+    /**
+     *  Runs a stage of network samples through the network. Leaves the lowpassed reverberation in the kRev buffers
+     *  and the delayed clean signal in the kDelayed buffers, one of each per channel, before any gains are applied.
+     *
+     *  @param in          Network input, one pointer per channel
+     *  @param numChannels 1 or 2. In stereo the combs are fed with the average of both channels
+     *  @param numSamples  Number of samples per channel [0, stageSize]
+     */
+    void runNetwork (const float* const* in, int numChannels, int numSamples)
+    {
+        float* combIn = stage (kCombIn);
+        float* combSum = stage (kCombSum);
+
+        if (numChannels == 1)
+        {
+            for (int i = 0; i < numSamples; i++)
+            {
+                combIn[i] = in[0][i] * wet;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; i++)
+            {
+                combIn[i] = (in[0][i] + in[1][i]) * 0.5f * wet;
+            }
+        }
+
+        // Process comb filter network. The weights only change while combs are fading in or out
+        if (mCombsFading)
+        {
+            for (int i = 0; i < numSamples; i++)
+            {
+                combSum[i] = processCombs (combIn[i]);
+            }
+        }
+        else
+        {
+            std::fill (combSum, combSum + numSamples, 0.0f);
+            for (int j = 0; j < 6; j++)
+            {
+                if (mCombWeight[j] != 0.0f)
+                {
+                    mComb[j].processComb (mCombDelay[j] * mNetworkRate, mCombGain[j], mCombWeight[j], combIn, combSum,
+                                          numSamples);
+                }
+            }
+        }
+
+        for (int c = 0; c < numChannels; c++)
+        {
+            float* rev = stage (kRev + c);
+
+            // Process allpass and lowpass filters
+            mAllpass[c].processAllpass (mDelayVal[c] * mNetworkRate, ALLPASSGAIN, combSum, rev, numSamples);
+            for (int i = 0; i < numSamples; i++)
+            {
+                rev[i] = mLowpass.processSample (rev[i], c);
+            }
+
+            // Delay unprocessed signal to match phase shift caused by the delayed comb filters
+            mDelay[c].processDelay (MINDELAY * mNetworkRate, in[c], stage (kDelayed + c), numSamples);
+        }
+    }
+
+    /**
+     *  Returns one of the stage buffers. @see Reverb::StageBuffer
+     */
+    inline float* stage (int buffer)
+    {
+        return mStage + buffer * stageSize;
+    }
+
+    /**
+     *  Resamples the history held in every delay line when the network rate changes
+     *
+     *  @param toHalfRate true if the network is switching to half rate
+     */
+    void resampleLines (bool toHalfRate)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            resampleLine (mComb[i], toHalfRate);
+        }
+        for (int c = 0; c < 2; c++)
+        {
+            resampleLine (mAllpass[c], toHalfRate);
+            resampleLine (mDelay[c], toHalfRate);
+        }
+    }
+
+    void resampleLine (DelayLine& line, bool toHalfRate)
+    {
+        const int size = lineSize;
+        const int pos = line.getWritePosition ();
+
+        // history[k] is the sample written k samples ago
+        for (int k = 0; k < size; k++)
+        {
+            mScratch[k] = line.getSample ((pos + 2 * size - 1 - k) % size);
+        }
+
+        for (int k = 0; k < size; k++)
+        {
+            float value;
+            if (toHalfRate)
+            {
+                value = 2 * k + 1 < size ? (mScratch[2 * k] + mScratch[2 * k + 1]) * .5f : 0.0f;
+            }
+            else
+            {
+                const int j = k / 2;
+                value = (k & 1) == 0 || j + 1 >= size ? mScratch[j] : (mScratch[j] + mScratch[j + 1]) * .5f;
+            }
+
+            line.setSample ((pos + 2 * size - 1 - k) % size, value);
+        }
+    }
+
     /**
      *  Processes an audio sample through a network of parallel comb filters
      *
@@ -333,10 +719,27 @@ private:
     float processCombs (float sample)
     {
         float outSample = 0;
-        for (int i = 0; i < mComb.size (); i++)
+
+        bool fading = false;
+        for (int i = 0; i < 6; i++)
         {
-            outSample += mComb[i].process_comb (sample, mCombDelay[i] * mSampleRate, mCombGain[i]);
+            if (mCombWeight[i] == 0.0f && mCombTarget[i] == 0.0f)
+            {
+                continue;
+            }
+
+            mComb[i].processComb (mCombDelay[i] * mNetworkRate, mCombGain[i], mCombWeight[i], &sample, &outSample, 1);
+
+            if (mCombWeight[i] != mCombTarget[i])
+            {
+                const float step = mCombTarget[i] > mCombWeight[i] ? mCombStep : -mCombStep;
+                mCombWeight[i] = std::abs (mCombTarget[i] - mCombWeight[i]) <= mCombStep ? mCombTarget[i]
+                                                                                         : mCombWeight[i] + step;
+                fading = true;
+            }
         }
+        mCombsFading = fading;
+
         return outSample;
     }
 
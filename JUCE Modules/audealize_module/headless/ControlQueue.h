@@ -0,0 +1,148 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef ControlQueue_h
+#define ControlQueue_h
+
+namespace Audealize
+{
+/// A change to an EffectChain, prepared on a control thread so that applying it on the audio thread only copies
+/// values: descriptor lookups and the settings-to-gains mapping are done before the message is queued.
+struct ControlMessage
+{
+    enum Type
+    {
+        kSetBandGains = 0,  // values holds one gain per band
+        kSetReverb,         // values holds d, g, m, f and E, amount the wet/dry mix
+        kSetEnabled         // effect is turned on if enabled is true
+    };
+
+    static const int maxValues = 40;  // enough for every equalizer band
+
+    Type type;
+    EffectChain::Effect effect;
+    bool enabled;
+    float amount;
+    int numValues;
+    float values[maxValues];
+
+    /**
+     *  Applies the change to an EffectChain
+     */
+    void applyTo (EffectChain& chain) const
+    {
+        switch (type)
+        {
+            case kSetBandGains:
+                chain.setBandGains (values, numValues);
+                break;
+            case kSetReverb:
+                EffectChain::configureReverb (chain.getReverb (), values, amount);
+                break;
+            case kSetEnabled:
+                chain.setEnabled (effect, enabled);
+                break;
+        }
+    }
+};
+
+/// A fixed size, lock-free queue of ControlMessages from one control thread to one audio thread.
+class ControlQueue
+{
+public:
+    /**
+     *  @param capacity Number of messages that can be queued
+     */
+    ControlQueue (int capacity = 64) : mFifo (capacity + 1), mMessages ((size_t) capacity + 1)
+    {
+    }
+
+    /**
+     *  Queues a message. Call from the control thread only
+     *
+     *  @return false if the queue is full
+     */
+    bool push (const ControlMessage& message)
+    {
+        int start1, size1, start2, size2;
+        mFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            return false;
+        }
+
+        mMessages[start1] = message;
+        mFifo.finishedWrite (1);
+        return true;
+    }
+
+    /**
+     *  Takes the oldest message off the queue. Call from the audio thread only
+     *
+     *  @return false if the queue is empty
+     */
+    bool pop (ControlMessage& message)
+    {
+        int start1, size1, start2, size2;
+        mFifo.prepareToRead (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            return false;
+        }
+
+        message = mMessages[start1];
+        mFifo.finishedRead (1);
+        return true;
+    }
+
+    /**
+     *  Applies every queued message to an EffectChain. Call from the audio thread only
+     *
+     *  @return the number of messages applied
+     */
+    int applyAll (EffectChain& chain)
+    {
+        int numApplied = 0;
+        ControlMessage message;
+
+        while (pop (message))
+        {
+            message.applyTo (chain);
+            numApplied++;
+        }
+
+        return numApplied;
+    }
+
+private:
+    AbstractFifo mFifo;
+    HeapBlock<ControlMessage> mMessages;
+
+    JUCE_DECLARE_NON_COPYABLE (ControlQueue)
+};
+
+}  // namespace Audealize
+
+#endif /* ControlQueue_h */
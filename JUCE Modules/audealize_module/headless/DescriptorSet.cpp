@@ -0,0 +1,121 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+namespace Audealize
+{
+bool DescriptorSet::loadFromFile (const File& file)
+{
+    const String text = file.loadFileAsString ();
+    if (text.isEmpty ())
+    {
+        return false;
+    }
+
+    try
+    {
+        return loadFromJson (json::parse (text.toStdString ()));
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+bool DescriptorSet::loadFromJson (const json& j)
+{
+    mDescriptors.clear ();
+    mBasis = DescriptorBasis ();
+
+    const json* descriptors = &j;
+    const char* valuesKey = "settings";
+
+    // compact descriptor sets hold a reduced basis and the descriptors' coefficients in it
+    if (j.is_object () && j.find ("descriptors") != j.end ())
+    {
+        if (!mBasis.fromJson (j["basis"]))
+        {
+            return false;
+        }
+        descriptors = &j["descriptors"];
+        valuesKey = "coeffs";
+    }
+
+    if (!descriptors->is_array ())
+    {
+        return false;
+    }
+
+    mDescriptors.reserve (descriptors->size ());
+    for (json::const_iterator it = descriptors->begin (); it != descriptors->end (); ++it)
+    {
+        const json& d = *it;
+        if (!d.is_object () || d.find ("word") == d.end () || d.find (valuesKey) == d.end ())
+        {
+            continue;
+        }
+
+        Descriptor descriptor;
+        descriptor.word = String (d["word"].get<std::string> ());
+        descriptor.language = d.find ("lang") != d.end () ? String (d["lang"].get<std::string> ()) : String ();
+        descriptor.agreement = d.find ("agreement") != d.end () ? d["agreement"].get<float> () : 0.0f;
+        descriptor.values = d[valuesKey].get<vector<float>> ();
+
+        mDescriptors.push_back (descriptor);
+    }
+
+    return !mDescriptors.empty ();
+}
+
+int DescriptorSet::indexOf (const String& word, const String& language) const
+{
+    for (int i = 0; i < mDescriptors.size (); i++)
+    {
+        const Descriptor& d = mDescriptors[i];
+        if (d.word.equalsIgnoreCase (word) && (language.isEmpty () || d.language.equalsIgnoreCase (language)))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+vector<float> DescriptorSet::getSettings (int index) const
+{
+    const vector<float>& values = mDescriptors[index].values;
+    return mBasis.isEmpty () ? values : mBasis.reconstruct (values);
+}
+
+size_t DescriptorSet::getSizeInBytes () const
+{
+    size_t size = MemoryUsage::sizeOf (mDescriptors) + mBasis.getSizeInBytes ();
+    for (int i = 0; i < mDescriptors.size (); i++)
+    {
+        const Descriptor& d = mDescriptors[i];
+        size += MemoryUsage::sizeOf (d.word) + MemoryUsage::sizeOf (d.language) + MemoryUsage::sizeOf (d.values);
+    }
+
+    return size;
+}
+
+}  // namespace Audealize
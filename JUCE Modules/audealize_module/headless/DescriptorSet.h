@@ -0,0 +1,114 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef DescriptorSet_h
+#define DescriptorSet_h
+
+using std::vector;
+using json = nlohmann::json;
+
+namespace Audealize
+{
+/// Read access to a descriptor set as stored in the plugins' data files (eqdescriptors.json, reverbdescriptors.json):
+/// a list of descriptors with a word, language, agreement, map position and settings, or the compact form, in which
+/// a DescriptorBasis is stored with the descriptors' coefficients in it.
+class DescriptorSet
+{
+public:
+    DescriptorSet ()
+    {
+    }
+
+    /**
+     *  Reads a descriptor set from a json file
+     *
+     *  @return false if the file couldn't be read or doesn't hold a descriptor set
+     */
+    bool loadFromFile (const File& file);
+
+    /**
+     *  Reads a descriptor set from parsed json, in either the full or the compact form
+     *
+     *  @return false if the json doesn't hold a descriptor set
+     */
+    bool loadFromJson (const json& j);
+
+    /**
+     *  Returns the number of descriptors
+     */
+    int size () const
+    {
+        return (int) mDescriptors.size ();
+    }
+
+    /**
+     *  Returns the index of a descriptor, or -1 if there is none. Words are compared ignoring case
+     *
+     *  @param word     The descriptor's word
+     *  @param language The descriptor's language, or an empty string to match the first descriptor in any language
+     */
+    int indexOf (const String& word, const String& language = String ()) const;
+
+    const String& getWord (int index) const
+    {
+        return mDescriptors[index].word;
+    }
+
+    const String& getLanguage (int index) const
+    {
+        return mDescriptors[index].language;
+    }
+
+    /**
+     *  Returns how much the people who used a descriptor agreed on its settings. Lower is better
+     */
+    float getAgreement (int index) const
+    {
+        return mDescriptors[index].agreement;
+    }
+
+    /**
+     *  Returns a descriptor's settings, ready for EffectChain. Settings of compact sets are reconstructed from the
+     *  basis, normalized to [0, 1]
+     */
+    vector<float> getSettings (int index) const;
+
+    size_t getSizeInBytes () const;
+
+private:
+    struct Descriptor
+    {
+        String word, language;
+        float agreement;
+        vector<float> values;  // settings, or coefficients in mBasis
+    };
+
+    vector<Descriptor> mDescriptors;
+    DescriptorBasis mBasis;
+
+    JUCE_DECLARE_NON_COPYABLE (DescriptorSet)
+};
+
+}  // namespace Audealize
+
+#endif /* DescriptorSet_h */
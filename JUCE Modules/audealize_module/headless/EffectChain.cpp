@@ -0,0 +1,172 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+namespace Audealize
+{
+static const float eqBandFrequencyList[] = {20,   50,   83,   120,  161,   208,   259,   318,   383,   455,
+                                            537,  628,  729,  843,  971,   1114,  1273,  1452,  1652,  1875,
+                                            2126, 2406, 2719, 3070, 3462,  3901,  4392,  4941,  5556,  6244,
+                                            7014, 7875, 8839, 9917, 11124, 12474, 13984, 15675, 17566, 19682};
+
+static const vector<float> eqBandFrequencies (eqBandFrequencyList,
+                                              eqBandFrequencyList + sizeof (eqBandFrequencyList) / sizeof (float));
+
+// the Reverb plugin's defaults: d, g, m, f, E and the wet/dry mix
+static const float reverbDefaults[] = {0.05f, 0.5f, 0.005f, 5500.0f, 0.95f, 0.75f};
+
+EffectChain::EffectChain () : mEqualizer (eqBandFrequencies, 44100.0f)
+{
+    mEqualizer.setKernel (Equalizer::kKernelBlockStateSpace);
+
+    mReverb.init (reverbDefaults[0], reverbDefaults[1], reverbDefaults[2], reverbDefaults[3], reverbDefaults[4],
+                  reverbDefaults[5], 44100.0f);
+
+    std::fill (mEnabled, mEnabled + kNumEffects, true);
+}
+
+void EffectChain::prepare (double sampleRate)
+{
+    mEqualizer.setSampleRate ((float) sampleRate);
+    mReverb.init (reverbDefaults[0], reverbDefaults[1], reverbDefaults[2], reverbDefaults[3], reverbDefaults[4],
+                  reverbDefaults[5], (float) sampleRate);
+}
+
+void EffectChain::setEqualizerSettings (const vector<float>& settings, float amount)
+{
+    configureEqualizer (mEqualizer, settings, amount);
+}
+
+void EffectChain::setReverbSettings (const vector<float>& settings, float amount)
+{
+    configureReverb (mReverb, settings, amount);
+}
+
+void EffectChain::setBandGains (const float* gains, int numGains)
+{
+    numGains = jmin (numGains, mEqualizer.getNumBands ());
+
+    for (int i = 0; i < numGains; i++)
+    {
+        mEqualizer.setBandGain (i, gains[i]);
+    }
+}
+
+void EffectChain::process (float* const* channels, int numChannels, int numSamples)
+{
+    numChannels = jmin (numChannels, 2);
+
+    if (mEnabled[kEqualizer])
+    {
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            mEqualizer.processBlock (channels[channel], numSamples, channel);
+        }
+    }
+
+    if (mEnabled[kReverb])
+    {
+        if (numChannels == 1)
+        {
+            mReverb.processMonoBlock (channels[0], numSamples);
+        }
+        else if (numChannels == 2)
+        {
+            mReverb.processStereoBlock (channels[0], channels[1], numSamples);
+        }
+    }
+}
+
+const vector<float>& EffectChain::getBandFrequencies ()
+{
+    return eqBandFrequencies;
+}
+
+NormalisableRange<float> EffectChain::getBandGainRange ()
+{
+    return NormalisableRange<float> (-4.30f, 4.30f, 0.001f);
+}
+
+NormalisableRange<float> EffectChain::getReverbParamRange (int index)
+{
+    switch (index)
+    {
+        case 0:
+            return NormalisableRange<float> (0.01f, 0.1f, 0.0001f);
+        case 1:
+            return NormalisableRange<float> (0.01f, 0.96f, 0.0001f);
+        case 2:
+            return NormalisableRange<float> (-0.012f, 0.012f, 0.00001f);
+        case 3:
+            return NormalisableRange<float> (20.0f, 20000.0f, 0.1f);
+        default:
+            return NormalisableRange<float> (0.0f, 1.0f, 0.0001f);
+    }
+}
+
+void EffectChain::configureEqualizer (Equalizer& eq, const vector<float>& settings, float amount)
+{
+    vector<float> gains (eq.getNumBands ());
+    const int numBands = getBandGains (settings, amount, gains.data (), eq.getNumBands ());
+
+    for (int i = 0; i < numBands; i++)
+    {
+        eq.setBandGain (i, gains[i]);
+    }
+}
+
+int EffectChain::getBandGains (const vector<float>& settings, float amount, float* gains, int numBands)
+{
+    vector<float> normalized = settings;
+    DescriptorBasis::normalize (normalized);
+
+    const NormalisableRange<float> range = getBandGainRange ();
+    numBands = jmin (numBands, (int) normalized.size ());
+
+    for (int i = 0; i < numBands; i++)
+    {
+        // the processors scale the gain parameters by the amount, and the band gains by it again
+        const float gain = range.snapToLegalValue (range.convertFrom0to1 (normalized[i]) * amount);
+        gains[i] = gain * amount;
+    }
+
+    return numBands;
+}
+
+void EffectChain::configureReverb (Reverb& reverb, const vector<float>& settings, float amount)
+{
+    jassert (settings.size () >= 5);
+
+    configureReverb (reverb, settings.data (), amount);
+}
+
+void EffectChain::configureReverb (Reverb& reverb, const float* settings, float amount)
+{
+    reverb.set_d (getReverbParamRange (0).snapToLegalValue (settings[0]));
+    reverb.set_g (getReverbParamRange (1).snapToLegalValue (settings[1]));
+    reverb.set_m (getReverbParamRange (2).snapToLegalValue (settings[2]));
+    reverb.set_f (getReverbParamRange (3).snapToLegalValue (settings[3]));
+    reverb.set_E (getReverbParamRange (4).snapToLegalValue (settings[4]));
+    reverb.set_wetdry (amount);
+}
+
+}  // namespace Audealize
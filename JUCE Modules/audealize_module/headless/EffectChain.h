@@ -0,0 +1,166 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef EffectChain_h
+#define EffectChain_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// An Equalizer followed by a Reverb, configured from descriptor settings the same way the Audealize plugins
+/// configure them. For hosts that process audio without the plugins, e.g. render servers and command line tools.
+///
+/// The static members hold the mapping from descriptor settings to effect parameters, which the plugins' processors
+/// share.
+class EffectChain
+{
+public:
+    enum Effect
+    {
+        kEqualizer = 0,
+        kReverb,
+        kNumEffects
+    };
+
+    EffectChain ();
+
+    /**
+     *  Sets the sample rate, and resets the reverb to its default settings. Call before processing
+     *
+     *  @param sampleRate Sample rate
+     */
+    void prepare (double sampleRate);
+
+    /**
+     *  Sets the equalizer to a descriptor's curve
+     *
+     *  @param settings One gain per band, as stored in a DescriptorSet. Only the shape of the curve matters
+     *  @param amount   How much of the curve to apply, in [0, 1]
+     */
+    void setEqualizerSettings (const vector<float>& settings, float amount);
+
+    /**
+     *  Sets the reverb to a descriptor's settings
+     *
+     *  @param settings d, g, m, f and E, as stored in a DescriptorSet. Further values are ignored
+     *  @param amount   Wet/dry mix, in [0, 1]
+     */
+    void setReverbSettings (const vector<float>& settings, float amount);
+
+    /**
+     *  Sets the equalizer's band gains directly, e.g. to gains prepared with getBandGains on another thread
+     *
+     *  @param gains    One gain per band, in dB
+     *  @param numGains Number of gains. Extra bands are left unchanged
+     */
+    void setBandGains (const float* gains, int numGains);
+
+    /**
+     *  Turns one of the effects on or off. Both are on initially
+     */
+    void setEnabled (Effect effect, bool enabled)
+    {
+        mEnabled[effect] = enabled;
+    }
+
+    bool isEnabled (Effect effect) const
+    {
+        return mEnabled[effect];
+    }
+
+    /**
+     *  Processes a block of one or two channels in place
+     *
+     *  @param channels    Pointers to the channels' samples
+     *  @param numChannels Number of channels. Only the first two are processed
+     *  @param numSamples  Number of samples per channel
+     */
+    void process (float* const* channels, int numChannels, int numSamples);
+
+    Equalizer& getEqualizer ()
+    {
+        return mEqualizer;
+    }
+
+    Reverb& getReverb ()
+    {
+        return mReverb;
+    }
+
+    /**
+     *  Returns the center frequencies of the equalizer bands, in Hz
+     */
+    static const vector<float>& getBandFrequencies ();
+
+    /**
+     *  Returns the range of the band gain parameters
+     */
+    static NormalisableRange<float> getBandGainRange ();
+
+    /**
+     *  Returns the range of one of the reverb parameters
+     *
+     *  @param index 0 to 4 for d, g, m, f and E
+     */
+    static NormalisableRange<float> getReverbParamRange (int index);
+
+    /**
+     *  Sets the band gains of an Equalizer to a descriptor's curve. @see setEqualizerSettings
+     */
+    static void configureEqualizer (Equalizer& eq, const vector<float>& settings, float amount);
+
+    /**
+     *  Computes the band gains configureEqualizer would set, without touching an Equalizer
+     *
+     *  @param settings One gain per band, as stored in a DescriptorSet
+     *  @param amount   How much of the curve to apply, in [0, 1]
+     *  @param gains    Receives one gain per band, in dB
+     *  @param numBands Number of gains to compute
+     *
+     *  @return the number of gains computed, which is less than numBands if there are fewer settings
+     */
+    static int getBandGains (const vector<float>& settings, float amount, float* gains, int numBands);
+
+    /**
+     *  Sets the parameters of a Reverb to a descriptor's settings. @see setReverbSettings
+     */
+    static void configureReverb (Reverb& reverb, const vector<float>& settings, float amount);
+
+    /**
+     *  Sets the parameters of a Reverb from the first five values of an array. Doesn't allocate, so it can be called
+     *  on an audio thread
+     */
+    static void configureReverb (Reverb& reverb, const float* settings, float amount);
+
+private:
+    Equalizer mEqualizer;
+    Reverb mReverb;
+    bool mEnabled[kNumEffects];
+
+    JUCE_DECLARE_NON_COPYABLE (EffectChain)
+};
+
+}  // namespace Audealize
+
+#endif /* EffectChain_h */
@@ -0,0 +1,119 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef StreamRingBuffer_h
+#define StreamRingBuffer_h
+
+namespace Audealize
+{
+/// A byte ring buffer for streaming raw audio between a file descriptor and the DSP, without intermediate copies:
+/// the writer is handed the free space to read() into, and the reader the buffered data to process or write() from.
+///
+/// One thread may write while another reads. Both sides get contiguous regions only, so a region ends at the end of
+/// the storage; when the capacity is a multiple of the size a side always consumes, that side's regions never split.
+class StreamRingBuffer
+{
+public:
+    /**
+     *  @param capacity Size of the storage in bytes. One byte less than this can be buffered
+     */
+    StreamRingBuffer (int capacity) : mFifo (capacity), mData ((size_t) capacity)
+    {
+    }
+
+    /**
+     *  Returns the largest contiguous region of free space
+     *
+     *  @param dest Receives the start of the region
+     *
+     *  @return the size of the region in bytes
+     */
+    int getWriteRegion (char*& dest) const
+    {
+        int start1, size1, start2, size2;
+        mFifo.prepareToWrite (mFifo.getFreeSpace (), start1, size1, start2, size2);
+
+        dest = mData + start1;
+        return size1;
+    }
+
+    /**
+     *  Marks bytes at the start of the write region as filled
+     */
+    void commitWrite (int numBytes)
+    {
+        mFifo.finishedWrite (numBytes);
+    }
+
+    /**
+     *  Returns the largest contiguous region of buffered data
+     *
+     *  @param src Receives the start of the region
+     *
+     *  @return the size of the region in bytes
+     */
+    int getReadRegion (const char*& src) const
+    {
+        int start1, size1, start2, size2;
+        mFifo.prepareToRead (mFifo.getNumReady (), start1, size1, start2, size2);
+
+        src = mData + start1;
+        return size1;
+    }
+
+    /**
+     *  Marks bytes at the start of the read region as consumed
+     */
+    void commitRead (int numBytes)
+    {
+        mFifo.finishedRead (numBytes);
+    }
+
+    int getNumReady () const
+    {
+        return mFifo.getNumReady ();
+    }
+
+    int getFreeSpace () const
+    {
+        return mFifo.getFreeSpace ();
+    }
+
+    /**
+     *  Discards all buffered data. Not thread safe
+     */
+    void reset ()
+    {
+        mFifo.reset ();
+    }
+
+private:
+    AbstractFifo mFifo;
+    HeapBlock<char> mData;
+
+    JUCE_DECLARE_NON_COPYABLE (StreamRingBuffer)
+};
+
+}  // namespace Audealize
+
+#endif /* StreamRingBuffer_h */
@@ -0,0 +1,451 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "OfflineRenderer.h"
+
+namespace Audealize
+{
+/// Wraps a task so it can be run by a juce::ThreadPool
+class OfflineRenderer::Job : public ThreadPoolJob
+{
+public:
+    Job (const std::function<void ()>& task) : ThreadPoolJob ("OfflineRenderer"), mTask (task)
+    {
+    }
+
+    JobStatus runJob () override
+    {
+        mTask ();
+        return jobHasFinished;
+    }
+
+private:
+    std::function<void ()> mTask;
+};
+
+OfflineRenderer::OfflineRenderer (int numThreads)
+    : mThreadPool (jmax (1, numThreads)), mNumThreads (jmax (1, numThreads)), mMinChunkSize (1 << 16)
+{
+    mFormatManager.registerBasicFormats ();
+}
+
+OfflineRenderer::~OfflineRenderer ()
+{
+    mThreadPool.removeAllJobs (true, 5000);
+}
+
+void OfflineRenderer::setMinimumChunkSize (int numSamples)
+{
+    mMinChunkSize = jmax (1024, numSamples);
+}
+
+void OfflineRenderer::renderEqualizer (Equalizer& eq, AudioSampleBuffer& buffer, RenderMode mode)
+{
+    jassert (buffer.getNumChannels () <= eq.getNumChannels ());
+
+    if (mode == kRenderChunkParallel && buffer.getNumSamples () >= 2 * mMinChunkSize)
+    {
+        renderChunkParallel (eq, buffer);
+        return;
+    }
+
+    const int numChannels = jmin (buffer.getNumChannels (), eq.getNumChannels ());
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        eq.processBlock (buffer.getWritePointer (channel), buffer.getNumSamples (), channel);
+    }
+}
+
+bool OfflineRenderer::renderFile (Equalizer& eq, const File& input, const File& output, RenderMode mode)
+{
+    ScopedPointer<AudioFormatReader> reader (mFormatManager.createReaderFor (input));
+    if (reader == nullptr || reader->lengthInSamples > std::numeric_limits<int>::max ())
+    {
+        return false;
+    }
+
+    const int numChannels = jmin ((int) reader->numChannels, eq.getNumChannels ());
+    const int numSamples = (int) reader->lengthInSamples;
+
+    AudioSampleBuffer buffer (numChannels, numSamples);
+    reader->read (&buffer, 0, numSamples, 0, true, numChannels > 1);
+
+    eq.setSampleRate ((float) reader->sampleRate);
+    renderEqualizer (eq, buffer, mode);
+
+    output.deleteFile ();
+    ScopedPointer<FileOutputStream> stream (output.createOutputStream ());
+    if (stream == nullptr)
+    {
+        return false;
+    }
+
+    WavAudioFormat wav;
+    ScopedPointer<AudioFormatWriter> writer (
+        wav.createWriterFor (stream, reader->sampleRate, (unsigned int) numChannels, 24, StringPairArray (), 0));
+    if (writer == nullptr)
+    {
+        return false;
+    }
+    stream.release ();  // now owned by the writer
+
+    return writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+}
+
+int OfflineRenderer::renderBatch (Equalizer* eq, Reverb* reverb, const Array<File>& inputs,
+                                  const Array<File>& outputs, double tailSeconds)
+{
+    jassert (inputs.size () == outputs.size ());
+
+    if (inputs.size () == 0 || inputs.size () != outputs.size ())
+    {
+        return 0;
+    }
+
+    // all lanes share one coefficient set, so the batch runs at the sample rate of the first file
+    double sampleRate = 0.0;
+    {
+        ScopedPointer<AudioFormatReader> reader (mFormatManager.createReaderFor (inputs[0]));
+        if (reader == nullptr)
+        {
+            return 0;
+        }
+        sampleRate = reader->sampleRate;
+    }
+
+    if (eq != nullptr)
+    {
+        eq->setSampleRate ((float) sampleRate);
+    }
+    if (reverb != nullptr)
+    {
+        reverb->setSampleRate ((float) sampleRate);
+    }
+
+    const int64 tailSamples = (int64) (jmax (0.0, tailSeconds) * sampleRate);
+    Atomic<int> nextFile (0), numRendered (0);
+
+    const int numFilesPerThread = LaneEqualizer::numLanes;
+    const int numWorkers = jmin (mNumThreads, (inputs.size () + numFilesPerThread - 1) / numFilesPerThread);
+
+    vector<std::function<void ()>> tasks;
+    for (int i = 0; i < numWorkers; i++)
+    {
+        tasks.push_back ([&]() {
+            renderBatchLanes (eq, reverb, inputs, outputs, sampleRate, tailSamples, nextFile, numRendered);
+        });
+    }
+    runJobs (tasks);
+
+    return numRendered.get ();
+}
+
+void OfflineRenderer::renderBatchLanes (Equalizer* eq, Reverb* reverb, const Array<File>& inputs,
+                                        const Array<File>& outputs, double sampleRate, int64 tailSamples,
+                                        Atomic<int>& nextFile, Atomic<int>& numRendered)
+{
+    const int numLanes = LaneEqualizer::numLanes;
+    const int blockSize = 1024;
+
+    /// A file being streamed through one lane
+    struct Lane
+    {
+        ScopedPointer<AudioFormatReader> reader;
+        ScopedPointer<AudioFormatWriter> writer;
+        int64 readPos, inputLength, samplesLeft;  // samplesLeft includes the tail
+    };
+
+    Lane lanes[numLanes];
+    for (int l = 0; l < numLanes; l++)
+    {
+        lanes[l].samplesLeft = 0;
+    }
+
+    ScopedPointer<LaneEqualizer> laneEq;
+    ScopedPointer<LaneReverb> laneReverb;
+    if (eq != nullptr)
+    {
+        laneEq = new LaneEqualizer ();
+        laneEq->setCoefficients (*eq);
+    }
+    if (reverb != nullptr)
+    {
+        laneReverb = new LaneReverb ();
+        laneReverb->setCoefficients (*reverb);
+    }
+
+    HeapBlock<float> block ((size_t) (blockSize * numLanes));
+    AudioSampleBuffer laneBuffer (1, blockSize);
+    WavAudioFormat wav;
+
+    for (;;)
+    {
+        // refill lanes whose file has finished
+        int numActive = 0;
+        for (int l = 0; l < numLanes; l++)
+        {
+            Lane& lane = lanes[l];
+
+            while (lane.samplesLeft == 0)
+            {
+                const int fileIdx = ++nextFile - 1;
+                if (fileIdx >= inputs.size ())
+                {
+                    break;
+                }
+
+                lane.reader = mFormatManager.createReaderFor (inputs[fileIdx]);
+                if (lane.reader == nullptr || lane.reader->sampleRate != sampleRate)
+                {
+                    lane.reader = nullptr;
+                    continue;
+                }
+
+                outputs[fileIdx].deleteFile ();
+                ScopedPointer<FileOutputStream> stream (outputs[fileIdx].createOutputStream ());
+                if (stream == nullptr)
+                {
+                    lane.reader = nullptr;
+                    continue;
+                }
+
+                lane.writer = wav.createWriterFor (stream, sampleRate, 1, 24, StringPairArray (), 0);
+                if (lane.writer == nullptr)
+                {
+                    lane.reader = nullptr;
+                    continue;
+                }
+                stream.release ();  // now owned by the writer
+
+                lane.readPos = 0;
+                lane.inputLength = lane.reader->lengthInSamples;
+                lane.samplesLeft = lane.inputLength + tailSamples;
+
+                if (lane.samplesLeft == 0)  // empty file, nothing to render
+                {
+                    lane.writer = nullptr;
+                    lane.reader = nullptr;
+                    ++numRendered;
+                    continue;
+                }
+
+                if (laneEq != nullptr)
+                {
+                    laneEq->resetLane (l);
+                }
+                if (laneReverb != nullptr)
+                {
+                    laneReverb->resetLane (l);
+                }
+            }
+
+            if (lane.samplesLeft > 0)
+            {
+                numActive++;
+            }
+        }
+
+        if (numActive == 0)
+        {
+            break;
+        }
+
+        // gather one block from every lane. finished lanes and input past the end of a file read as silence
+        for (int l = 0; l < numLanes; l++)
+        {
+            Lane& lane = lanes[l];
+            const int numToRead = (int) jlimit ((int64) 0, (int64) blockSize, lane.inputLength - lane.readPos);
+
+            laneBuffer.clear ();
+            if (lane.samplesLeft > 0 && numToRead > 0)
+            {
+                lane.reader->read (&laneBuffer, 0, numToRead, lane.readPos, true, false);
+                lane.readPos += numToRead;
+            }
+
+            const float* src = laneBuffer.getReadPointer (0);
+            for (int n = 0; n < blockSize; n++)
+            {
+                block[n * numLanes + l] = src[n];
+            }
+        }
+
+        if (laneEq != nullptr)
+        {
+            laneEq->process (block, blockSize);
+        }
+        if (laneReverb != nullptr)
+        {
+            laneReverb->process (block, blockSize);
+        }
+
+        // scatter back and write only the valid part of each lane
+        for (int l = 0; l < numLanes; l++)
+        {
+            Lane& lane = lanes[l];
+            if (lane.samplesLeft == 0)
+            {
+                continue;
+            }
+
+            float* dest = laneBuffer.getWritePointer (0);
+            for (int n = 0; n < blockSize; n++)
+            {
+                dest[n] = block[n * numLanes + l];
+            }
+
+            const int numToWrite = (int) jmin ((int64) blockSize, lane.samplesLeft);
+            bool ok = lane.writer->writeFromAudioSampleBuffer (laneBuffer, 0, numToWrite);
+            lane.samplesLeft = ok ? lane.samplesLeft - numToWrite : 0;
+
+            if (lane.samplesLeft == 0)
+            {
+                lane.writer = nullptr;  // flushes and closes the file
+                lane.reader = nullptr;
+
+                if (ok)
+                {
+                    ++numRendered;
+                }
+            }
+        }
+    }
+}
+
+void OfflineRenderer::renderChunkParallel (Equalizer& eq, AudioSampleBuffer& buffer)
+{
+    const int numChannels = jmin (buffer.getNumChannels (), eq.getNumChannels ());
+    const int numSamples = buffer.getNumSamples ();
+    const int chunkSize = jmax (mMinChunkSize, (numSamples + mNumThreads - 1) / mNumThreads);
+    const int numChunks = (numSamples + chunkSize - 1) / chunkSize;
+
+    // one cascade per chunk per channel. the first chunk starts from the Equalizer's actual state, the rest from
+    // silence
+    vector<vector<BiquadCascade>> cascades (numChannels, vector<BiquadCascade> (numChunks));
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        for (int chunk = 0; chunk < numChunks; chunk++)
+        {
+            cascades[channel][chunk].loadFrom (eq, channel);
+            if (chunk > 0)
+            {
+                cascades[channel][chunk].reset ();
+            }
+        }
+    }
+
+    // phase 1: filter every chunk independently
+    vector<std::function<void ()>> tasks;
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        float* samples = buffer.getWritePointer (channel);
+        for (int chunk = 0; chunk < numChunks; chunk++)
+        {
+            const int start = chunk * chunkSize;
+            const int length = jmin (chunkSize, numSamples - start);
+            BiquadCascade* cascade = &cascades[channel][chunk];
+
+            tasks.push_back ([=]() { cascade->process (samples + start, length); });
+        }
+    }
+    runJobs (tasks);
+
+    // phase 2: propagate the true state at each chunk boundary. the end state of chunk k is its zero-state end state
+    // plus the transition matrix applied to its true start state
+    const int stateSize = cascades[0][0].getStateSize ();
+    vector<vector<vector<double>>> startStates (numChannels, vector<vector<double>> (numChunks));
+    vector<double> transition;
+
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        cascades[channel][0].getTransitionMatrix (chunkSize, transition);
+
+        vector<double> state (cascades[channel][0].getState (), cascades[channel][0].getState () + stateSize);
+        for (int chunk = 1; chunk < numChunks; chunk++)
+        {
+            startStates[channel][chunk] = state;
+
+            if (chunk < numChunks - 1)
+            {
+                const double* zeroStateEnd = cascades[channel][chunk].getState ();
+                for (int i = 0; i < stateSize; i++)
+                {
+                    double sum = zeroStateEnd[i];
+                    for (int j = 0; j < stateSize; j++)
+                    {
+                        sum += transition[i * stateSize + j] * startStates[channel][chunk][j];
+                    }
+                    state[i] = sum;
+                }
+            }
+        }
+    }
+
+    // phase 3: add the response to each chunk's true start state. what's left of that response at the end of the
+    // last chunk completes the Equalizer's final state
+    tasks.clear ();
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        float* samples = buffer.getWritePointer (channel);
+        for (int chunk = 1; chunk < numChunks; chunk++)
+        {
+            const int start = chunk * chunkSize;
+            const int length = jmin (chunkSize, numSamples - start);
+            BiquadCascade* cascade = &cascades[channel][chunk];
+            vector<double>* startState = &startStates[channel][chunk];
+
+            tasks.push_back ([=]() {
+                cascade->addZeroInputResponse (startState->data (), samples + start, length);
+
+                double* state = cascade->getState ();
+                for (int i = 0; i < stateSize; i++)
+                {
+                    state[i] += (*startState)[i];
+                }
+            });
+        }
+    }
+    runJobs (tasks);
+
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        cascades[channel][numChunks - 1].storeStateTo (eq, channel);
+    }
+}
+
+void OfflineRenderer::runJobs (const vector<std::function<void ()>>& tasks)
+{
+    OwnedArray<Job> jobs;
+    for (int i = 0; i < tasks.size (); i++)
+    {
+        jobs.add (new Job (tasks[i]));
+        mThreadPool.addJob (jobs.getLast (), false);
+    }
+
+    for (int i = 0; i < jobs.size (); i++)
+    {
+        mThreadPool.waitForJobToFinish (jobs[i], -1);
+    }
+}
+
+}  // namespace Audealize
@@ -0,0 +1,132 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef OfflineRenderer_h
+#define OfflineRenderer_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// Renders whole buffers or audio files through an Equalizer outside of the audio thread.
+///
+/// In chunk-parallel mode the signal is split into chunks which are filtered from zero state on separate threads.
+/// The true state at the start of each chunk is then propagated serially using the cascade's state transition
+/// matrix, and each chunk is corrected by adding the cascade's zero-input response to that state. The chunks run the
+/// sections the Equalizer's section schedule currently runs (@see BiquadCascade::loadFrom), so the result matches
+/// serial processing to within float rounding, except that band fades in progress are finished straight away.
+///
+/// Large batches of mono files that share one setting can be rendered with renderBatch, which runs a different file
+/// in each SIMD lane of LaneEqualizer / LaneReverb.
+class OfflineRenderer
+{
+public:
+    enum RenderMode
+    {
+        kRenderSerial = 0,
+        kRenderChunkParallel
+    };
+
+    OfflineRenderer (int numThreads = SystemStats::getNumCpus ());
+    ~OfflineRenderer ();
+
+    /**
+     *  Sets the smallest chunk the signal will be split into in chunk-parallel mode. Chunks shorter than the decay
+     *  time of the filters make the zero-input correction as expensive as the filtering itself.
+     *
+     *  @param numSamples Minimum chunk length in samples
+     */
+    void setMinimumChunkSize (int numSamples);
+
+    /**
+     *  Filters a buffer in place. The Equalizer's state is advanced as if the buffer had been processed with
+     *  Equalizer::processBlock, so consecutive calls continue seamlessly. In chunk-parallel mode any band fades or
+     *  quality crossfade in progress are finished before rendering, rather than spread over the first samples.
+     *
+     *  @param eq     The Equalizer to render through
+     *  @param buffer Audio to filter. Must not have more channels than the Equalizer
+     *  @param mode   @see OfflineRenderer::RenderMode
+     */
+    void renderEqualizer (Equalizer& eq, AudioSampleBuffer& buffer, RenderMode mode = kRenderChunkParallel);
+
+    /**
+     *  Reads an audio file, filters it and writes the result as a 24 bit wav file. The Equalizer's sample rate is set
+     *  to that of the input file.
+     *
+     *  @param eq     The Equalizer to render through
+     *  @param input  File to read
+     *  @param output File to write. Overwritten if it exists
+     *  @param mode   @see OfflineRenderer::RenderMode
+     *
+     *  @return true if the file was rendered successfully
+     */
+    bool renderFile (Equalizer& eq, const File& input, const File& output, RenderMode mode = kRenderChunkParallel);
+
+    /**
+     *  Renders many mono files through the same Equalizer and/or Reverb settings. Each worker thread carries
+     *  AUDEALIZE_NUM_LANES files at once, one per SIMD lane. Files are streamed in blocks, and a lane whose file
+     *  has finished is masked until it is refilled with the next file in the queue, so files of different lengths
+     *  can share a batch.
+     *
+     *  The effects are set to the sample rate of the first input file; files with a different sample rate are
+     *  skipped. Only the first channel of multichannel files is rendered. Outputs are written as 24 bit wav files.
+     *
+     *  @param eq          Equalizer to render through, or nullptr
+     *  @param reverb      Reverb to render through (after the Equalizer), or nullptr
+     *  @param inputs      Files to read
+     *  @param outputs     Files to write, one per input. Overwritten if they exist
+     *  @param tailSeconds Length of silence appended to each input so the reverb tail is rendered
+     *
+     *  @return the number of files that were rendered successfully
+     */
+    int renderBatch (Equalizer* eq, Reverb* reverb, const Array<File>& inputs, const Array<File>& outputs,
+                     double tailSeconds = 0.0);
+
+private:
+    class Job;
+
+    ThreadPool mThreadPool;
+    int mNumThreads;
+    int mMinChunkSize;
+
+    AudioFormatManager mFormatManager;
+
+    void renderChunkParallel (Equalizer& eq, AudioSampleBuffer& buffer);
+
+    /**
+     *  Worker loop of renderBatch. Takes files from the shared queue until it is empty
+     */
+    void renderBatchLanes (Equalizer* eq, Reverb* reverb, const Array<File>& inputs, const Array<File>& outputs,
+                           double sampleRate, int64 tailSamples, Atomic<int>& nextFile, Atomic<int>& numRendered);
+
+    /**
+     *  Runs a set of tasks on the thread pool and waits for them all to finish
+     */
+    void runJobs (const vector<std::function<void ()>>& tasks);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
+
+}  // namespace Audealize
+
+#endif /* OfflineRenderer_h */
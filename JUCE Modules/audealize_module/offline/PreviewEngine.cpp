@@ -0,0 +1,347 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "PreviewEngine.h"
+
+namespace Audealize
+{
+//==============================================================================
+AuditionBuffer::Ptr PreviewCache::get (const String& key)
+{
+    const ScopedLock sl (mLock);
+
+    std::map<String, EntryList::iterator>::iterator it = mIndex.find (key);
+    if (it == mIndex.end ())
+    {
+        return nullptr;
+    }
+
+    mEntries.splice (mEntries.begin (), mEntries, it->second);
+    return it->second->second;
+}
+
+bool PreviewCache::contains (const String& key)
+{
+    const ScopedLock sl (mLock);
+    return mIndex.find (key) != mIndex.end ();
+}
+
+void PreviewCache::add (const String& key, AuditionBuffer::Ptr buffer)
+{
+    const ScopedLock sl (mLock);
+
+    std::map<String, EntryList::iterator>::iterator it = mIndex.find (key);
+    if (it != mIndex.end ())
+    {
+        mBytes -= it->second->second->getSizeInBytes ();
+        mEntries.erase (it->second);
+        mIndex.erase (it);
+    }
+
+    mEntries.push_front (std::make_pair (key, buffer));
+    mIndex[key] = mEntries.begin ();
+    mBytes += buffer->getSizeInBytes ();
+
+    // evict least recently used, but always keep the newest render
+    while (mBytes > mMaxBytes && mEntries.size () > 1)
+    {
+        mBytes -= mEntries.back ().second->getSizeInBytes ();
+        mIndex.erase (mEntries.back ().first);
+        mEntries.pop_back ();
+    }
+}
+
+void PreviewCache::clear ()
+{
+    const ScopedLock sl (mLock);
+
+    mEntries.clear ();
+    mIndex.clear ();
+    mBytes = 0;
+}
+
+size_t PreviewCache::getSizeInBytes ()
+{
+    const ScopedLock sl (mLock);
+    return mBytes;
+}
+
+//==============================================================================
+/// Renders one descriptor's preview. Owned by the job submitted to the WorkerPool, so it is destroyed (and tells the
+/// engine it has finished) whether it ran or was dropped
+class PreviewEngine::RenderJob
+{
+public:
+    RenderJob (PreviewEngine& engine, const String& key, const WorkerPool::CancellationToken& token,
+               const vector<float>& settings, AuditionBuffer::Ptr input)
+        : mEngine (engine), mKey (key), mToken (token), mSettings (settings), mInput (input)
+    {
+    }
+
+    ~RenderJob ()
+    {
+        mEngine.renderFinished (mKey, mToken, mRender);
+    }
+
+    void run ()
+    {
+        const AudioSampleBuffer& input = mInput->samples;
+        const int length = input.getNumSamples ();
+
+        // render the loop twice so the effect's state (e.g. the reverb tail) wraps around seamlessly, and keep the
+        // second pass
+        AudioSampleBuffer buffer (1, length * 2);
+        buffer.copyFrom (0, 0, input, 0, 0, length);
+        buffer.copyFrom (0, length, input, 0, 0, length);
+
+        if (mToken.isCancelled ())
+        {
+            return;
+        }
+
+        mEngine.processor.renderPreview (mSettings, buffer, mEngine.processor.getInputCapture ().getSampleRate ());
+
+        if (mToken.isCancelled ())
+        {
+            return;
+        }
+
+        mRender = new AuditionBuffer (length);
+        mRender->samples.copyFrom (0, 0, buffer, 0, length, length);
+    }
+
+private:
+    PreviewEngine& mEngine;
+    String mKey;
+    WorkerPool::CancellationToken mToken;
+    vector<float> mSettings;
+    AuditionBuffer::Ptr mInput, mRender;
+};
+
+//==============================================================================
+PreviewEngine::PreviewEngine (AudealizeAudioProcessor& p, size_t maxCacheBytes, double loopSeconds)
+    : processor (p), mCache (maxCacheBytes), mLoopSeconds (loopSeconds)
+{
+}
+
+PreviewEngine::~PreviewEngine ()
+{
+    stopAudition ();
+
+    // a cancelled render can still be running after a new one for the same key has replaced it in mQueuedRenders,
+    // so wait for every job, not just the latest of each key. The render jobs use this engine until they are
+    // destroyed
+    vector<WorkerPool::CancellationToken> tokens;
+    {
+        const ScopedLock sl (mLock);
+        for (size_t i = 0; i < mJobs.size (); i++)
+        {
+            mJobs[i].cancel ();
+        }
+        tokens = mJobs;
+    }
+
+    for (size_t i = 0; i < tokens.size (); i++)
+    {
+        mWorkerPool->waitFor (tokens[i]);
+    }
+}
+
+void PreviewEngine::captureInput ()
+{
+    const double sampleRate = processor.getInputCapture ().getSampleRate ();
+    const int length = (int) (mLoopSeconds * sampleRate);
+    const int fadeLength = (int) (0.01 * sampleRate);
+
+    AudioSampleBuffer recent;
+    if (processor.getInputCapture ().getRecent (recent, length + fadeLength) < length + fadeLength)
+    {
+        mInput = nullptr;  // not enough input yet
+        mInputId = String ();
+        return;
+    }
+
+    // crossfade the extra samples at the end into the start of the loop so it wraps around without a click
+    AuditionBuffer::Ptr input = new AuditionBuffer (length);
+    const float* src = recent.getReadPointer (0);
+    float* dest = input->samples.getWritePointer (0);
+
+    for (int i = 0; i < length; i++)
+    {
+        dest[i] = src[i];
+    }
+    for (int i = 0; i < fadeLength; i++)
+    {
+        const float fade = (float) i / fadeLength;
+        dest[i] = src[i] * fade + src[i + length] * (1.0f - fade);
+    }
+
+    // FNV-1a hash of the captured audio
+    uint64 hash = 14695981039346656037ULL;
+    const uint8* bytes = reinterpret_cast<const uint8*> (dest);
+    for (size_t i = 0; i < input->getSizeInBytes (); i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+
+    // renders also depend on the sample rate and on the processor's amount parameter
+    const float amount = processor.getParameterPtrFromID (processor.getParamAmountID ())->getValue ();
+    mInput = input;
+    mInputId = String::toHexString ((int64) hash) + "|" + String (sampleRate) + "|" + String (amount, 3);
+}
+
+void PreviewEngine::prefetch (const vector<String>& words, const vector<vector<float>>& settings)
+{
+    jassert (words.size () == settings.size ());
+
+    if (mInput == nullptr)
+    {
+        return;
+    }
+
+    StringArray wanted;
+    for (int i = 0; i < words.size (); i++)
+    {
+        wanted.add (getKey (words[i]));
+    }
+
+    {
+        const ScopedLock sl (mLock);
+        if (mPendingKey.isNotEmpty ())
+        {
+            wanted.addIfNotAlreadyThere (mPendingKey);
+        }
+    }
+
+    // cancel renders that are no longer wanted
+    {
+        const ScopedLock sl (mLock);
+        for (std::map<String, WorkerPool::CancellationToken>::iterator it = mQueuedRenders.begin ();
+             it != mQueuedRenders.end (); ++it)
+        {
+            if (!wanted.contains (it->first))
+            {
+                it->second.cancel ();
+            }
+        }
+    }
+
+    for (int i = 0; i < words.size (); i++)
+    {
+        queueRender (wanted[i], settings[i], WorkerPool::kPriorityBackground);
+    }
+}
+
+void PreviewEngine::audition (const String& word, const vector<float>& settings)
+{
+    if (mInput == nullptr)
+    {
+        return;
+    }
+
+    const String key = getKey (word);
+    AuditionBuffer::Ptr render = mCache.get (key);
+
+    if (render != nullptr)
+    {
+        {
+            const ScopedLock sl (mLock);
+            mPendingKey = String ();
+        }
+        processor.getAuditionPlayer ().play (render);
+        return;
+    }
+
+    {
+        const ScopedLock sl (mLock);
+        mPendingKey = key;
+    }
+    queueRender (key, settings, WorkerPool::kPriorityInteractive);
+}
+
+void PreviewEngine::stopAudition ()
+{
+    {
+        const ScopedLock sl (mLock);
+        mPendingKey = String ();
+    }
+    processor.getAuditionPlayer ().stop ();
+}
+
+void PreviewEngine::queueRender (const String& key, const vector<float>& settings, int priority)
+{
+    if (mCache.contains (key))
+    {
+        return;
+    }
+
+    // a render that was cancelled but hasn't been dropped yet is replaced
+    WorkerPool::CancellationToken token;
+    {
+        const ScopedLock sl (mLock);
+        std::map<String, WorkerPool::CancellationToken>::iterator it = mQueuedRenders.find (key);
+        if (it != mQueuedRenders.end () && !it->second.isCancelled ())
+        {
+            return;
+        }
+        mQueuedRenders[key] = token;
+        mJobs.push_back (token);
+    }
+
+    // if the pool's queue is full the job is destroyed straight away, which calls renderFinished
+    std::shared_ptr<RenderJob> job (new RenderJob (*this, key, token, settings, mInput));
+    mWorkerPool->submit ("Preview render", priority, token, [job] () { job->run (); });
+}
+
+void PreviewEngine::renderFinished (const String& key, const WorkerPool::CancellationToken& token,
+                                    AuditionBuffer::Ptr render)
+{
+    bool shouldPlay = false;
+    {
+        const ScopedLock sl (mLock);
+
+        std::map<String, WorkerPool::CancellationToken>::iterator it = mQueuedRenders.find (key);
+        if (it != mQueuedRenders.end () && it->second == token)
+        {
+            mQueuedRenders.erase (it);
+        }
+        mJobs.erase (std::remove (mJobs.begin (), mJobs.end (), token), mJobs.end ());
+
+        if (render != nullptr && key == mPendingKey)
+        {
+            mPendingKey = String ();
+            shouldPlay = true;
+        }
+    }
+
+    if (render != nullptr)
+    {
+        mCache.add (key, render);
+    }
+
+    if (shouldPlay)
+    {
+        processor.getAuditionPlayer ().play (render);
+    }
+}
+}
@@ -0,0 +1,165 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PreviewEngine_h
+#define PreviewEngine_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// A least-recently-used cache of rendered previews, bounded by the memory used by the audio data
+class PreviewCache
+{
+public:
+    PreviewCache (size_t maxBytes) : mMaxBytes (maxBytes), mBytes (0)
+    {
+    }
+
+    /**
+     *  Returns a cached render and marks it as most recently used, or nullptr if it isn't cached
+     */
+    AuditionBuffer::Ptr get (const String& key);
+
+    /**
+     *  Returns true if a render is cached. Doesn't affect the order of eviction
+     */
+    bool contains (const String& key);
+
+    /**
+     *  Adds a render, evicting the least recently used ones until the cache fits in its memory limit
+     */
+    void add (const String& key, AuditionBuffer::Ptr buffer);
+
+    /**
+     *  Removes everything from the cache
+     */
+    void clear ();
+
+    /**
+     *  Returns the memory currently used by cached audio, in bytes
+     */
+    size_t getSizeInBytes ();
+
+private:
+    typedef std::list<std::pair<String, AuditionBuffer::Ptr>> EntryList;
+
+    EntryList mEntries;                            // most recently used first
+    std::map<String, EntryList::iterator> mIndex;  // key -> position in mEntries
+    size_t mMaxBytes, mBytes;
+    CriticalSection mLock;
+
+    JUCE_DECLARE_NON_COPYABLE (PreviewCache)
+};
+
+/// Renders short loops of an AudealizeAudioProcessor's recent input through the settings of individual descriptors,
+/// on the shared WorkerPool and with a private effect instance, so descriptors can be auditioned without changing the
+/// processor's parameters. Renders are cached by descriptor and by a hash of the input they were made from.
+class PreviewEngine
+{
+public:
+    /**
+     *  Constructor
+     *
+     *  @param p             The processor whose input is previewed and whose output is replaced while auditioning
+     *  @param maxCacheBytes Memory limit of the render cache
+     *  @param loopSeconds   Length of the preview loop
+     */
+    PreviewEngine (AudealizeAudioProcessor& p, size_t maxCacheBytes = 32 * 1024 * 1024, double loopSeconds = 3.0);
+    ~PreviewEngine ();
+
+    /**
+     *  Takes a copy of the processor's most recent input to render subsequent previews from
+     */
+    void captureInput ();
+
+    /**
+     *  Queues renders for a set of descriptors (e.g. those near the mouse), dropping queued renders that are no longer
+     *  wanted. Descriptors that are already cached are skipped
+     *
+     *  @param words    The descriptors
+     *  @param settings The settings of each descriptor, as passed to AudealizeAudioProcessor::settingsFromMap
+     */
+    void prefetch (const vector<String>& words, const vector<vector<float>>& settings);
+
+    /**
+     *  Plays the preview of a descriptor in place of the processor's output, as soon as it has been rendered
+     *
+     *  @param word     The descriptor
+     *  @param settings The settings of the descriptor
+     */
+    void audition (const String& word, const vector<float>& settings);
+
+    /**
+     *  Stops auditioning so the processor's own output is heard again
+     */
+    void stopAudition ();
+
+    /**
+     *  Returns the memory used by cached renders, in bytes
+     */
+    size_t getCacheSizeInBytes ()
+    {
+        return mCache.getSizeInBytes ();
+    }
+
+private:
+    class RenderJob;
+
+    AudealizeAudioProcessor& processor;
+
+    PreviewCache mCache;
+    double mLoopSeconds;
+
+    AuditionBuffer::Ptr mInput;  // the captured loop all previews are rendered from
+    String mInputId;             // identifies mInput (and the processor state that affects renders) in cache keys
+
+    CriticalSection mLock;  // guards mPendingKey, mQueuedRenders and mJobs, which are touched by the render jobs
+    String mPendingKey;     // render to start playing as soon as it is finished
+    std::map<String, WorkerPool::CancellationToken> mQueuedRenders;  // latest render of each key, queued or running
+    vector<WorkerPool::CancellationToken> mJobs;  // every render job that hasn't finished, cancelled ones included
+
+    SharedResourcePointer<WorkerPool> mWorkerPool;
+
+    String getKey (const String& word) const
+    {
+        return word + "|" + mInputId;
+    }
+
+    /**
+     *  Submits a render unless it is cached or already queued
+     *
+     *  @param priority @see WorkerPool::Priority
+     */
+    void queueRender (const String& key, const vector<float>& settings, int priority);
+
+    /**
+     *  Called by a RenderJob when it has finished (or been dropped before it ran)
+     */
+    void renderFinished (const String& key, const WorkerPool::CancellationToken& token, AuditionBuffer::Ptr render);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PreviewEngine)
+};
+}
+
+#endif /* PreviewEngine_h */
@@ -89,7 +89,13 @@ AboutComponent::AboutComponent ()
     mLabLinkButton->setButtonText (TRANS ("music.cs.northwestern.edu"));
     mLabLinkButton->addListener (this);
 
-    mLogoDrawable = Drawable::createFromImageData (AudealizeImages::iallogo_svg, AudealizeImages::iallogo_svgSize);
+    addAndMakeVisible (mMemoryLabel = new Label ("Memory", String ()));
+    mMemoryLabel->setFont (Font (Font::getDefaultSansSerifFontName (), 11.00f, Font::plain));
+    mMemoryLabel->setJustificationType (Justification::centred);
+    mMemoryLabel->setEditable (false, false, false);
+    mMemoryLabel->setColour (TextEditor::backgroundColourId, Colour (0x00000000));
+
+    mLogoDrawable = mResources->createGraphic (UIResources::kLabLogo);
 
     setAlwaysOnTop (true);
     setSize (496, 320);
@@ -104,6 +110,7 @@ AboutComponent::~AboutComponent ()
     mAudealizeLabel = nullptr;
     mVersionLabel = nullptr;
     mLabLinkButton = nullptr;
+    mMemoryLabel = nullptr;
     mLogoDrawable = nullptr;
 }
 
@@ -129,6 +136,14 @@ void AboutComponent::resized ()
     mAudealizeLabel->setBounds (24, 16, 150, 24);
     mVersionLabel->setBounds (114, 14, 150, 25);
     mLabLinkButton->setBounds (249, 222, 240, 24);
+    mMemoryLabel->setBounds (249, 246, 240, 22);
+}
+
+void AboutComponent::setMemoryUsage (const MemoryUsage& usage)
+{
+    mMemoryLabel->setText ("Memory in use: " + File::descriptionOfSizeInBytes ((int64) usage.getTotal ()),
+                           dontSendNotification);
+    mMemoryLabel->setTooltip (usage.toString ());
 }
 
 void AboutComponent::buttonClicked (Button* buttonThatWasClicked)
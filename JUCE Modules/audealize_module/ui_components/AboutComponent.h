@@ -45,6 +45,14 @@ public:
     void resized () override;
     void buttonClicked (Button* buttonThatWasClicked) override;
 
+    /**
+     *  Shows how much memory the plugin instance is using: the total, with each category in the tooltip. Called
+     *  each time the component is shown
+     *
+     *  @param usage The processor's MemoryUsage
+     */
+    void setMemoryUsage (const MemoryUsage& usage);
+
     void focusLost (FocusChangeType cause) override
     {
         setVisible (false);
@@ -56,6 +64,8 @@ public:
     }
 
 private:
+    SharedResourcePointer<UIResources> mResources;
+
     ScopedPointer<Label> mGrantInfoLabel;           // NSF grant information
     ScopedPointer<Label> mCopyrightLabel;           // copyright information
     ScopedPointer<HyperlinkButton> audealizeLink;   // link to audealze.appspot.com
@@ -63,6 +73,7 @@ private:
     ScopedPointer<Label> mAudealizeLabel;           // Audealize title text
     ScopedPointer<Label> mVersionLabel;             // plugin version string
     ScopedPointer<HyperlinkButton> mLabLinkButton;  // link to the lab website
+    ScopedPointer<Label> mMemoryLabel;              // memory used by the plugin instance
     ScopedPointer<Drawable> mLogoDrawable;          // Interactive Audio Lab logo graphic
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AboutComponent)
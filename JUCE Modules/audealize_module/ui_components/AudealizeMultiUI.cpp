@@ -37,16 +37,16 @@ AudealizeMultiUI::AudealizeMultiUI (AudioProcessor& p, vector<AudealizeUI*> Aude
     {
         if ((bool) darkMode)
         {
-            LookAndFeel::setDefaultLookAndFeel (&mLookAndFeelDark);
+            LookAndFeel::setDefaultLookAndFeel (&mResources->getLookAndFeel (true));
         }
         else
         {
-            LookAndFeel::setDefaultLookAndFeel (&mLookAndFeel);
+            LookAndFeel::setDefaultLookAndFeel (&mResources->getLookAndFeel (false));
         }
     }
     else
     {
-        LookAndFeel::setDefaultLookAndFeel (&mLookAndFeelDark);
+        LookAndFeel::setDefaultLookAndFeel (&mResources->getLookAndFeel (true));
     }
 
     mToolTip.setMillisecondsBeforeTipAppears (.25);
@@ -84,8 +84,7 @@ AudealizeMultiUI::AudealizeMultiUI (AudioProcessor& p, vector<AudealizeUI*> Aude
     label->setColour (TextEditor::backgroundColourId, Colour (0x00000000));
 
     // dark mode button
-    mDarkModeGraphic =
-        Drawable::createFromImageData (AudealizeImages::darkModeButton_svg, AudealizeImages::darkModeButton_svgSize);
+    mDarkModeGraphic = mResources->createGraphic (UIResources::kDarkModeButton);
 
     addAndMakeVisible (mDarkModeButton =
                            new DrawableButton ("Dark", DrawableButton::ButtonStyle::ImageOnButtonBackground));
@@ -252,6 +251,10 @@ void AudealizeMultiUI::buttonClicked (juce::Button* buttonThatWasClicked)
 {
     if (buttonThatWasClicked == mInfoButton)
     {
+        if (AudealizeAudioProcessor* processor = dynamic_cast<AudealizeAudioProcessor*> (getAudioProcessor ()))
+        {
+            mAboutComponent->setMemoryUsage (processor->getMemoryUsage ());
+        }
         mAboutComponent->setVisible (true);
     }
     else if (buttonThatWasClicked == mDarkModeButton)
@@ -259,7 +262,7 @@ void AudealizeMultiUI::buttonClicked (juce::Button* buttonThatWasClicked)
         bool isDark = static_cast<AudealizeLookAndFeel&> (getLookAndFeel ()).isDarkModeActive ();
         if (isDark)
         {
-            setLookAndFeel (&mLookAndFeel);
+            setLookAndFeel (&mResources->getLookAndFeel (false));
             mDarkModeGraphic->replaceColour (Colour (0xffbbbbbb), Colour (0xff606060));
 
             mDarkModeButton->setImages (mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic,
@@ -267,7 +270,7 @@ void AudealizeMultiUI::buttonClicked (juce::Button* buttonThatWasClicked)
         }
         else
         {
-            setLookAndFeel (&mLookAndFeelDark);
+            setLookAndFeel (&mResources->getLookAndFeel (true));
             mDarkModeGraphic->replaceColour (Colour (0xff606060), Colour (0xffbbbbbb));
 
             mDarkModeButton->setImages (mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic,
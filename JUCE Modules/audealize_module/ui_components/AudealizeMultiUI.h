@@ -64,6 +64,9 @@ public:
     void mouseDown (const MouseEvent& event) override;
 
 private:
+    // look and feels and graphics shared by every editor. Declared first so they outlive the child components
+    SharedResourcePointer<UIResources> mResources;
+
     var properties;
 
     vector<AudealizeUI*> mAudealizeUIs;
@@ -78,9 +81,6 @@ private:
     ScopedPointer<AudealizeTabbedComponent> mTabbedComponent;
     ScopedPointer<Label> label;
 
-    AudealizeLookAndFeel mLookAndFeel;
-    AudealizeLookAndFeelDark mLookAndFeelDark;
-
     ScopedPointer<AboutComponent> mAboutComponent;
     ScopedPointer<TextButton> mInfoButton;
     DropShadower mShadow;
@@ -44,16 +44,16 @@ AudealizeUI::AudealizeUI (AudealizeAudioProcessor& p, ScopedPointer<TraditionalU
     {
         if ((bool) darkMode)
         {
-            LookAndFeel::setDefaultLookAndFeel (&mLookAndFeelDark);
+            LookAndFeel::setDefaultLookAndFeel (&mResources->getLookAndFeel (true));
         }
         else
         {
-            LookAndFeel::setDefaultLookAndFeel (&mLookAndFeel);
+            LookAndFeel::setDefaultLookAndFeel (&mResources->getLookAndFeel (false));
         }
     }
     else
     {
-        LookAndFeel::setDefaultLookAndFeel (&mLookAndFeelDark);
+        LookAndFeel::setDefaultLookAndFeel (&mResources->getLookAndFeel (true));
     }
 
     isMultiEffect = isPluginMultiEffect;
@@ -127,6 +127,20 @@ AudealizeUI::AudealizeUI (AudealizeAudioProcessor& p, ScopedPointer<TraditionalU
         mEspanolButton->setVisible (false);
     }
 
+    // audition descriptors by hovering over the map
+    mPreviewEngine = new PreviewEngine (p);
+
+    addAndMakeVisible (mPreviewButton = new ToggleButton ("Preview on hover"));
+    mPreviewButton->setTooltip ("Hear descriptors by hovering over the map, without applying them");
+    mPreviewButton->addListener (this);
+    mPreviewButton->setToggleState ((bool) Properties::getProperty (Properties::propertyIds::previewOnHover),
+                                    dontSendNotification);
+
+    if (mPreviewButton->getToggleState ())
+    {
+        mWordMap->setPreviewEngine (mPreviewEngine);
+    }
+
     // if this AudealizeUI is a child component of an AudealizeMultiUI, we wont show the Audealize title text here.
     if (!isMultiEffect)
     {
@@ -138,8 +152,7 @@ AudealizeUI::AudealizeUI (AudealizeAudioProcessor& p, ScopedPointer<TraditionalU
         mAudealizeLabel->setEditable (false, false, false);
 
         // dark mode button
-        mDarkModeGraphic = Drawable::createFromImageData (AudealizeImages::darkModeButton_svg,
-                                                          AudealizeImages::darkModeButton_svgSize);
+        mDarkModeGraphic = mResources->createGraphic (UIResources::kDarkModeButton);
 
         addAndMakeVisible (mDarkModeButton =
                                new DrawableButton ("Dark", DrawableButton::ButtonStyle::ImageOnButtonBackground));
@@ -202,20 +215,35 @@ AudealizeUI::AudealizeUI (AudealizeAudioProcessor& p, ScopedPointer<TraditionalU
     mTradUIButton->addListener (this);
     mTradUIButton->setButtonText (TRANS ("+ Show " + String (mTradUI->getName ())));
 
+    // descriptor suggestions, for effects that analyse their input
+    addChildComponent (mSuggestButton = new TextButton ("Suggest"));
+    mSuggestButton->setTooltip ("Suggest descriptors for the incoming audio, or to match a reference file");
+    mSuggestButton->addListener (this);
+    mSuggestButton->setVisible (processor.getInputAnalyser () != nullptr);
+    mSuggester.setDescriptors (mWordMap->getWords (), mWordMap->getWordSettings (), mWordMap->getBasis ());
+
     // set initial size of plugin window
     var windowHeight = Properties::getProperty (Properties::propertyIds::windowHeight);
     var windowWidth = Properties::getProperty (Properties::propertyIds::windowWidth);
     setSize (windowWidth, windowHeight);
+
+    processor.setEditorMemoryReporter (this);
 }
 
 AudealizeUI::~AudealizeUI ()
 {
+    processor.setEditorMemoryReporter (nullptr);
+
     if (!isMultiEffect)
     {
         Properties::setProperty (Properties::propertyIds::windowHeight, std::min (getHeight (), MIN_HEIGHT));
         Properties::setProperty (Properties::propertyIds::windowWidth, std::min (getWidth (), MIN_WIDTH));
     }
 
+    mWordMap->setPreviewEngine (nullptr);
+    mPreviewEngine = nullptr;
+    mPreviewButton = nullptr;
+
     mAlertBox = nullptr;
     mAmountSliderAttachment = nullptr;
     mResizer = nullptr;
@@ -230,6 +258,7 @@ AudealizeUI::~AudealizeUI ()
     mEspanolButton = nullptr;
     mAudealizeLabel = nullptr;
     mTradUIButton = nullptr;
+    mSuggestButton = nullptr;
     mSearchBar = nullptr;
     mAboutComponent = nullptr;
     mInfoButton = nullptr;
@@ -315,6 +344,8 @@ void AudealizeUI::resized ()
         mLabelMore->setBounds (getWidth () - 72, getHeight () - 45, 56, 24);
     }
 
+    mSuggestButton->setBounds (mTradUIButton->getRight () + 10, mTradUIButton->getY (), 90, 24);
+
     // search bar
     mSearchBar->setBounds (32, 60 + titleTextOffset, 240, 32);
 
@@ -322,6 +353,10 @@ void AudealizeUI::resized ()
     mEnglishButton->setBounds (mSearchBar->getX () + mSearchBar->getWidth () + 10, 65 + titleTextOffset, 72, 24);
     mEspanolButton->setBounds (mSearchBar->getX () + mSearchBar->getWidth () + 78, 65 + titleTextOffset, 80, 24);
 
+    // preview button goes after the language buttons, or in their place if they're hidden
+    int previewButtonX = mEspanolButton->isVisible () ? mEspanolButton->getRight () + 8 : mEnglishButton->getX ();
+    mPreviewButton->setBounds (previewButtonX, 65 + titleTextOffset, 140, 24);
+
     // traditional UI
     mTradUI->setBounds (38, getHeight () - 140, getWidth () - 63, 120);
 
@@ -351,6 +386,20 @@ void AudealizeUI::buttonClicked (Button* buttonThatWasClicked)
         mWordMap->toggleLanguage ("Español", mEspanolButton->getToggleState ());
     }
 
+    // suggestions button
+    else if (buttonThatWasClicked == mSuggestButton)
+    {
+        showSuggestions ();
+    }
+
+    // preview on hover button
+    else if (buttonThatWasClicked == mPreviewButton)
+    {
+        bool enabled = mPreviewButton->getToggleState ();
+        mWordMap->setPreviewEngine (enabled ? mPreviewEngine.get () : nullptr);
+        Properties::setProperty (Properties::propertyIds::previewOnHover, enabled);
+    }
+
     // traditional UI button
     else if (buttonThatWasClicked == mTradUIButton)
     {
@@ -410,6 +459,7 @@ void AudealizeUI::buttonClicked (Button* buttonThatWasClicked)
     // infobutton
     else if (buttonThatWasClicked == mInfoButton)
     {
+        mAboutComponent->setMemoryUsage (processor.getMemoryUsage ());
         mAboutComponent->setVisible (true);
     }
 
@@ -420,7 +470,7 @@ void AudealizeUI::buttonClicked (Button* buttonThatWasClicked)
 
         if (isDark)
         {
-            setLookAndFeel (&mLookAndFeel);
+            setLookAndFeel (&mResources->getLookAndFeel (false));
 
             mDarkModeGraphic->replaceColour (Colour (0xffbbbbbb), Colour (0xff606060));
             mDarkModeButton->setImages (mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic,
@@ -428,7 +478,7 @@ void AudealizeUI::buttonClicked (Button* buttonThatWasClicked)
         }
         else
         {
-            setLookAndFeel (&mLookAndFeelDark);
+            setLookAndFeel (&mResources->getLookAndFeel (true));
 
             mDarkModeGraphic->replaceColour (Colour (0xff606060), Colour (0xffbbbbbb));
             mDarkModeButton->setImages (mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic, mDarkModeGraphic,
@@ -480,6 +530,7 @@ void AudealizeUI::actionListenerCallback (const String& message)
     {
         mSearchBar->setOptions (mWordMap->getWords ());  // update the set of words that will be searched by the search
                                                          // bar to include only the selected languages
+        mSuggester.setDescriptors (mWordMap->getWords (), mWordMap->getWordSettings (), mWordMap->getBasis ());
     }
     else  // a word on the map was selected
     {
@@ -497,6 +548,86 @@ void AudealizeUI::actionListenerCallback (const String& message)
 }
 }
 
+void AudealizeUI::addMemoryUsage (MemoryUsage& usage)
+{
+    usage.editorCaches +=
+        mWordMap->getSizeInBytes () + mSuggester.getSizeInBytes () + mPreviewEngine->getCacheSizeInBytes ();
+}
+
+void AudealizeUI::showSuggestions ()
+{
+    InputAnalyser* analyser = processor.getInputAnalyser ();
+    if (analyser == nullptr)
+    {
+        return;
+    }
+
+    PopupMenu menu;
+    vector<float> input, target;
+    mSuggestions.clear ();
+
+    if (analyser->getInputSpectrum (input))
+    {
+        // aim for the reference file if there is one, otherwise for a neutral balance
+        bool hasReference = analyser->getReferenceSpectrum (target);
+        if (!hasReference)
+        {
+            target = DescriptorSuggester::getDefaultTarget (analyser->getBandFreqs ());
+        }
+
+        mSuggestions = mSuggester.suggest (input, target, 5);
+
+        menu.addSectionHeader (hasReference ? "To match the reference" : "Suggested for this input");
+        for (int i = 0; i < mSuggestions.size (); i++)
+        {
+            menu.addItem (i + 1, mSuggestions[i]);
+        }
+
+        if (mSuggestions.size () == 0)
+        {
+            menu.addItem (-1, "Nothing to suggest", false);
+        }
+    }
+    else
+    {
+        menu.addItem (-1, "Play audio through the effect to get suggestions", false);
+    }
+
+    menu.addSeparator ();
+    menu.addItem (kMenuLoadReference, "Match a reference file...");
+    menu.addItem (kMenuClearReference, "Clear reference", analyser->hasReference ());
+
+    menu.showMenuAsync (PopupMenu::Options ().withTargetComponent (mSuggestButton),
+                        ModalCallbackFunction::forComponent (suggestionMenuFinished, this));
+}
+
+void AudealizeUI::suggestionMenuFinished (int result, AudealizeUI* ui)
+{
+    if (ui == nullptr || result == 0)
+    {
+        return;
+    }
+
+    InputAnalyser* analyser = ui->processor.getInputAnalyser ();
+
+    if (result > 0 && result <= ui->mSuggestions.size ())
+    {
+        ui->mWordMap->searchMapAndSelect (ui->mSuggestions[result - 1]);
+    }
+    else if (result == kMenuLoadReference)
+    {
+        FileChooser chooser ("Choose a reference file", File::nonexistent, "*.wav;*.aif;*.aiff;*.flac;*.ogg");
+        if (chooser.browseForFileToOpen ())
+        {
+            analyser->loadReference (chooser.getResult ());
+        }
+    }
+    else if (result == kMenuClearReference)
+    {
+        analyser->clearReference ();
+    }
+}
+
 void AudealizeUI::mouseDown (const MouseEvent& event)
 {
     if (!isMultiEffect && mAboutComponent->isVisible () &&
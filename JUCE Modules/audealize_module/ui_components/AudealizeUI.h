@@ -43,7 +43,8 @@ class AudealizeUI : public AudioProcessorEditor,
                     public TextEditorListener,
                     public ActionListener,
                     public ActionBroadcaster,
-                    public ButtonListener
+                    public ButtonListener,
+                    public MemoryUsage::Reporter
 {
 public:
     enum ColourIds
@@ -91,6 +92,11 @@ public:
      */
     void buttonClicked (Button* buttonThatWasClicked) override;
 
+    /**
+     *  Adds the descriptor dataset, map layout and preview renders held by this editor to a MemoryUsage
+     */
+    void addMemoryUsage (MemoryUsage& usage) override;
+
     /**
      *  Set the bypass state of the audio effect. (true = on)
      *
@@ -185,9 +191,17 @@ public:
 
     void mouseDown (const MouseEvent& event) override;
 
+    /**
+     *  Shows a menu of the descriptors suggested for the processor's input, and of the reference file options
+     */
+    void showSuggestions ();
+
 private:
     AudealizeAudioProcessor& processor;
 
+    // look and feels and graphics shared by every editor. Declared first so they outlive the child components
+    SharedResourcePointer<UIResources> mResources;
+
     var properties;
 
     String mPathToPoints;  // path to .json file containing descriptor data
@@ -212,24 +226,37 @@ private:
     String mEffectType;
 
     ScopedPointer<Audealize::WordMap> mWordMap;
+    ScopedPointer<PreviewEngine> mPreviewEngine;  // renders descriptor previews for the WordMap
     ScopedPointer<Slider> mAmountSlider;  // controls the intensity of the effect
     ScopedPointer<Label> mLabelLess;      // label for amount slider
     ScopedPointer<Label> mLabelMore;      // label for amount slider
     ScopedPointer<ToggleButton> mEnglishButton;
     ScopedPointer<ToggleButton> mEspanolButton;
+    ScopedPointer<ToggleButton> mPreviewButton;  // enables auditioning descriptors on hover
     ScopedPointer<Label> mAudealizeLabel;     // "Audealize" text in top left
     ScopedPointer<TextButton> mTradUIButton;  // button to hide/show traditional ui
+    ScopedPointer<TextButton> mSuggestButton;  // shows descriptors suggested for the input (EQ only)
+    DescriptorSuggester mSuggester;
+    StringArray mSuggestions;  // the descriptors in the last suggestions menu
     ScopedPointer<TypeaheadEditor> mSearchBar;
     ScopedPointer<Button> mInfoButton;
     ScopedPointer<AboutComponent> mAboutComponent;
     DropShadower mShadow;
 
-    AudealizeLookAndFeel mLookAndFeel;
-    AudealizeLookAndFeelDark mLookAndFeelDark;
-
     ScopedPointer<Drawable> mDarkModeGraphic;
     ScopedPointer<DrawableButton> mDarkModeButton;
 
+    enum SuggestionMenuItems
+    {
+        kMenuLoadReference = 1000,  // item ids below this are suggested descriptors
+        kMenuClearReference
+    };
+
+    /**
+     *  Called when an item in the suggestions menu is chosen
+     */
+    static void suggestionMenuFinished (int result, AudealizeUI* ui);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudealizeUI)
 };
 }
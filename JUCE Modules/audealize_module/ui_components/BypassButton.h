@@ -38,15 +38,7 @@ public:
 
     BypassButton () : DrawableButton ("", ButtonStyle::ImageOnButtonBackground)
     {
-        mOffGraphic =
-            Drawable::createFromImageData (AudealizeImages::powerButton_svg, AudealizeImages::powerButton_svgSize);
-        mOffGraphic->replaceColour (Colour (0xff000000), findColour (offColourId));
-
-        mOnGraphic =
-            Drawable::createFromImageData (AudealizeImages::powerButton_svg, AudealizeImages::powerButton_svgSize);
-        mOnGraphic->replaceColour (Colour (0xff000000), findColour (onColourId));
-
-        setImages (mOffGraphic, nullptr, nullptr, nullptr, mOnGraphic, nullptr, nullptr, nullptr);
+        updateGraphics ();
 
         setEdgeIndent (10);
 
@@ -63,15 +55,7 @@ public:
 
     void lookAndFeelChanged () override
     {
-        mOffGraphic =
-            Drawable::createFromImageData (AudealizeImages::powerButton_svg, AudealizeImages::powerButton_svgSize);
-        mOffGraphic->replaceColour (Colour (0xff000000), findColour (offColourId));
-
-        mOnGraphic =
-            Drawable::createFromImageData (AudealizeImages::powerButton_svg, AudealizeImages::powerButton_svgSize);
-        mOnGraphic->replaceColour (Colour (0xff000000), findColour (onColourId));
-
-        setImages (mOffGraphic, nullptr, nullptr, nullptr, mOnGraphic, nullptr, nullptr, nullptr);
+        updateGraphics ();
     }
 
     void paintButton (Graphics& g, const bool isMouseOverButton, const bool isButtonDown) override
@@ -81,7 +65,23 @@ public:
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BypassButton);
 
+    SharedResourcePointer<UIResources> mResources;
+
     ScopedPointer<Drawable> mOffGraphic, mOnGraphic;
+
+    /**
+     *  Recolours copies of the shared power button graphic for the current look and feel
+     */
+    void updateGraphics ()
+    {
+        mOffGraphic = mResources->createGraphic (UIResources::kPowerButton);
+        mOffGraphic->replaceColour (Colour (0xff000000), findColour (offColourId));
+
+        mOnGraphic = mResources->createGraphic (UIResources::kPowerButton);
+        mOnGraphic->replaceColour (Colour (0xff000000), findColour (onColourId));
+
+        setImages (mOffGraphic, nullptr, nullptr, nullptr, mOnGraphic, nullptr, nullptr, nullptr);
+    }
 };
 }
 
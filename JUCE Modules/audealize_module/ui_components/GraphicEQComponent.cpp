@@ -24,79 +24,307 @@
 #include "GraphicEQComponent.h"
 
 using std::vector;
-using std::to_string;
 
 namespace Audealize
 {
 GraphicEQComponent::GraphicEQComponent (AudealizeAudioProcessor& p, int numBands, NormalisableRange<float> gainRange)
-    : TraditionalUI (p), mGainSliders (numBands), mGainSliderAttachment (numBands)
+    : TraditionalUI (p),
+      mNumBands (numBands),
+      mGainRange (gainRange),
+      mGains (numBands, 0.0f),
+      mPendingGains (numBands),
+      mHoverBand (-1),
+      mDragBand (-1),
+      mKeyBand (0)
 {
-    mNumBands = numBands;
-
     name = "graphic EQ";
 
+    AudioProcessorValueTreeState& state = p.getValueTreeState ();
     for (int i = 0; i < mNumBands; i++)
     {
-        String paramID = "paramGain" + to_string (i);
-
-        mGainSliders[i] = new Slider (Slider::LinearVertical, Slider::NoTextBox);
-        mGainSliders[i]->addListener (this);
-        mGainSliders[i]->setRange (gainRange.getRange ().getStart (), gainRange.getRange ().getEnd ());
-        String tooltip = freqToText (mFreqs[i]);
-        mGainSliders[i]->setTooltip (tooltip);
-        addAndMakeVisible (mGainSliders[i]);
+        String paramID = p.getParamID (i);
 
-        mGainSliderAttachment[i] =
-            new AudioProcessorValueTreeState::SliderAttachment (p.getValueTreeState (), paramID, *mGainSliders[i]);
+        if (AudioProcessorParameter* param = state.getParameter (paramID))
+        {
+            mGains[i] = mGainRange.convertFrom0to1 (param->getValue ());
+        }
+        mPendingGains[i] = mGains[i];
+        state.addParameterListener (paramID, this);
     }
 
+    setRepaintsOnMouseActivity (false);
+    setWantsKeyboardFocus (true);
     setSize (400, 200);
 }
 
 GraphicEQComponent::~GraphicEQComponent ()
 {
+    cancelPendingUpdate ();
+
     for (int i = 0; i < mNumBands; i++)
     {
-        mGainSliders[i] = nullptr;
-        mGainSliderAttachment[i] = nullptr;
-        // mGainListener[i] = nullptr;
+        processor.getValueTreeState ().removeParameterListener (processor.getParamID (i), this);
     }
 }
 
 void GraphicEQComponent::paint (Graphics& g)
 {
-    int midpoint = mGainSliders[0]->getY () + mGainSliders[0]->getHeight () / 2;
+    const float bandWidth = getBandWidth ();
+    const int indent = getThumbIndent ();
+    const float radius = (float) (indent - 2);
+    const float top = (float) indent, bottom = (float) (getHeight () - indent);
+
+    AudealizeLookAndFeel* lf = dynamic_cast<AudealizeLookAndFeel*> (&getLookAndFeel ());
+    const bool drawOutlines = lf != nullptr && lf->willDrawOutlines ();
+
+    const Colour trackColour (findColour (Slider::trackColourId));
+    const Colour thumbColour (findColour (Slider::thumbColourId));
+    const Colour tickColour (findColour (GraphicEQComponent::tickMarkColourId));
+
+    // tick marks at 0 dB between the bands
+    const float midpoint = (float) (getHeight () / 2);
+    g.setColour (tickColour);
+    for (int i = 1; i < mNumBands; i++)
+    {
+        const float x = (float) (int) (i * bandWidth);
+        g.drawLine (x - 1, midpoint, x + 1, midpoint, 2);
+    }
+
+    // tracks
+    Path tracks;
+    for (int i = 0; i < mNumBands; i++)
+    {
+        const float cx = (int) (i * bandWidth) + (int) bandWidth * 0.5f;
+        tracks.addRoundedRectangle (cx - radius * 0.5f, top - radius * 0.5f, radius, bottom - top + radius, 5.0f);
+    }
+
+    g.setColour (trackColour);
+    g.fillPath (tracks);
 
-    for (int i = 0; i < NUMBANDS - 1; i++)
+    if (drawOutlines)
     {
-        int x1 = mGainSliders[i]->getRight ();
-        int x2 = mGainSliders[i + 1]->getX ();
-        g.setColour (findColour (GraphicEQComponent::tickMarkColourId));
-        g.drawLine (x1 - 1, midpoint, x2 + 1, midpoint, 2);
+        g.setColour (trackColour.contrasting (0.5f));
+        g.strokePath (tracks, PathStrokeType (0.5f));
+    }
+
+    // thumbs
+    const int keyBand = hasKeyboardFocus (false) ? mKeyBand : -1;
+    for (int i = 0; i < mNumBands; i++)
+    {
+        const float cx = (int) (i * bandWidth) + (int) bandWidth * 0.5f;
+        const float cy = gainToY (mGains[i]);
+
+        g.setColour (LookAndFeelHelpers::createBaseColour (thumbColour, false,
+                                                           i == mHoverBand || i == mDragBand || i == keyBand,
+                                                           i == mDragBand));
+        g.fillEllipse (cx - radius, cy - radius, radius * 2.0f, radius * 2.0f);
+
+        if (drawOutlines)
+        {
+            g.setColour (tickColour);
+            g.drawEllipse (cx - radius, cy - radius, radius * 2.0f, radius * 2.0f, 0.8f);
+        }
     }
 }
 
 void GraphicEQComponent::resized ()
 {
-    Rectangle<int> box (getLocalBounds ());
-    box.setWidth (box.getWidth () / 40.);
+    repaint ();
+}
 
+void GraphicEQComponent::mouseMove (const MouseEvent& e)
+{
+    const int band = getBandAt (e.x);
+    if (band != mHoverBand)
+    {
+        mHoverBand = band;
+        repaint ();
+    }
+}
+
+void GraphicEQComponent::mouseExit (const MouseEvent& e)
+{
+    if (mHoverBand != -1)
+    {
+        mHoverBand = -1;
+        repaint ();
+    }
+}
+
+void GraphicEQComponent::mouseDown (const MouseEvent& e)
+{
+    mDragBand = getBandAt (e.x);
+    if (mDragBand < 0)
+    {
+        return;
+    }
+
+    mKeyBand = mDragBand;
+    processor.getParameterPtr (mDragBand)->beginChangeGesture ();
+
+    // like a linear Slider, the thumb jumps to the mouse
+    setBandGain (mDragBand, yToGain ((float) e.y));
+    repaint ();
+}
+
+void GraphicEQComponent::mouseDrag (const MouseEvent& e)
+{
+    if (mDragBand >= 0)
+    {
+        setBandGain (mDragBand, yToGain ((float) e.y));
+    }
+}
+
+void GraphicEQComponent::mouseUp (const MouseEvent& e)
+{
+    if (mDragBand >= 0)
+    {
+        processor.getParameterPtr (mDragBand)->endChangeGesture ();
+        mDragBand = -1;
+        mHoverBand = getBandAt (e.x);
+        repaint ();
+    }
+}
+
+void GraphicEQComponent::mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel)
+{
+    const int band = getBandAt (e.x);
+    const float delta = wheel.deltaY != 0.0f ? wheel.deltaY : -wheel.deltaX;
+
+    if (band < 0 || mDragBand >= 0 || delta == 0.0f)
+    {
+        Component::mouseWheelMove (e, wheel);
+        return;
+    }
+
+    // same step as a Slider: 15% of the range per wheel notch
+    stepBandGain (band, (mGainRange.end - mGainRange.start) * 0.15f * (wheel.isReversed ? -delta : delta));
+}
+
+bool GraphicEQComponent::keyPressed (const KeyPress& key)
+{
+    const int code = key.getKeyCode ();
+
+    if (code == KeyPress::leftKey || code == KeyPress::rightKey)
+    {
+        mKeyBand = jlimit (0, mNumBands - 1, mKeyBand + (code == KeyPress::leftKey ? -1 : 1));
+        repaint ();
+        return true;
+    }
+
+    // a fortieth of the range per arrow key, the wheel's 15% per page key
+    float step;
+    if (code == KeyPress::upKey || code == KeyPress::downKey)
+    {
+        step = (mGainRange.end - mGainRange.start) * 0.025f;
+    }
+    else if (code == KeyPress::pageUpKey || code == KeyPress::pageDownKey)
+    {
+        step = (mGainRange.end - mGainRange.start) * 0.15f;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (mDragBand < 0 && mKeyBand < mNumBands)
+    {
+        stepBandGain (mKeyBand, code == KeyPress::downKey || code == KeyPress::pageDownKey ? -step : step);
+    }
+    return true;
+}
+
+void GraphicEQComponent::focusGained (FocusChangeType cause)
+{
+    repaint ();
+}
+
+void GraphicEQComponent::focusLost (FocusChangeType cause)
+{
+    repaint ();
+}
+
+String GraphicEQComponent::getTooltip ()
+{
+    const int band = mDragBand >= 0 ? mDragBand : mHoverBand;
+    if (band < 0 || band >= (int) mFreqs.size ())
+    {
+        return String ();
+    }
+
+    return freqToText (mFreqs[band]) + ": " + String (mGains[band], 2) + " dB";
+}
+
+void GraphicEQComponent::parameterChanged (const String& parameterID, float newValue)
+{
+    const int band = parameterID.substring (9).getIntValue ();
+    if (band >= 0 && band < mNumBands)
+    {
+        mPendingGains[band] = newValue;
+        triggerAsyncUpdate ();
+    }
+}
+
+int GraphicEQComponent::getBandAt (int x) const
+{
+    if (x < 0 || x >= getWidth () || mNumBands == 0)
+    {
+        return -1;
+    }
+
+    return jmin (mNumBands - 1, (int) (x / getBandWidth ()));
+}
+
+void GraphicEQComponent::handleAsyncUpdate ()
+{
     for (int i = 0; i < mNumBands; i++)
     {
-        mGainSliders[i]->setBounds (box);
-        box.setX (box.getRight ());
+        mGains[i] = mPendingGains[i].get ();
     }
+    repaint ();
 }
 
-void GraphicEQComponent::sliderValueChanged (Slider* slider)
+int GraphicEQComponent::getThumbIndent () const
 {
-    for (int i = 0; i < mNumBands; ++i)
+    // @see LookAndFeel_V2::getSliderThumbRadius
+    return jmin (7, getHeight () / 2, (int) getBandWidth () / 2) + 2;
+}
+
+float GraphicEQComponent::gainToY (float gain) const
+{
+    const int indent = getThumbIndent ();
+    const float proportion = mGainRange.convertTo0to1 (jlimit (mGainRange.start, mGainRange.end, gain));
+    return indent + (1.0f - proportion) * (getHeight () - 2 * indent);
+}
+
+float GraphicEQComponent::yToGain (float y) const
+{
+    const int indent = getThumbIndent ();
+    const float height = (float) jmax (1, getHeight () - 2 * indent);
+    return mGainRange.convertFrom0to1 (jlimit (0.0f, 1.0f, 1.0f - (y - indent) / height));
+}
+
+void GraphicEQComponent::setBandGain (int band, float gain)
+{
+    gain = mGainRange.snapToLegalValue (jlimit (mGainRange.start, mGainRange.end, gain));
+
+    if (AudioProcessorParameter* param = processor.getParameterPtr (band))
     {
-        if (mGainSliders[i] == slider)
-        {
-            mGainSliders[i]->setTooltip (freqToText (mFreqs[i]) + ": " + String (slider->getValue (), 2) + " dB");
-            return;
-        }
+        param->setValueNotifyingHost (mGainRange.convertTo0to1 (gain));
     }
 }
-}
\ No newline at end of file
+
+void GraphicEQComponent::stepBandGain (int band, float step)
+{
+    AudioProcessorParameter* param = processor.getParameterPtr (band);
+    if (param == nullptr)
+    {
+        return;
+    }
+
+    // from the parameter rather than mGains, which may not have caught up with the last step yet
+    param->beginChangeGesture ();
+    setBandGain (band, mGainRange.convertFrom0to1 (param->getValue ()) + step);
+    param->endChangeGesture ();
+}
+}
@@ -24,15 +24,24 @@
 #ifndef GraphicEQComponent_h
 #define GraphicEQComponent_h
 
-#include <sstream>
-
 using std::vector;
 using namespace juce;
 
 namespace Audealize
 {
-/// A TraditionalUI with an N slider graphic EQ interface for Audealize-EQ plugin
-class GraphicEQComponent : public TraditionalUI, public SliderListener
+/// A TraditionalUI with an N band graphic EQ interface for Audealize-EQ plugin
+///
+/// All bands are drawn by this one component in a single paint pass and hit-tested arithmetically, instead of being
+/// separate Slider widgets. The component listens to the band gain parameters itself; when many of them change at
+/// once (e.g. while dragging across the WordMap) the changes are coalesced into one repaint. Changes can arrive on any
+/// thread, so they are posted through atomics and only picked up by the message thread.
+///
+/// With keyboard focus, the left and right arrow keys select a band and the up and down arrow keys (or page up and
+/// page down, in bigger steps) change its gain.
+class GraphicEQComponent : public TraditionalUI,
+                           public TooltipClient,
+                           public AudioProcessorValueTreeState::Listener,
+                           private AsyncUpdater
 {
 public:
     enum ColourIds
@@ -46,26 +55,80 @@ public:
     void paint (Graphics& g) override;
     void resized () override;
 
-    void sliderValueChanged (Slider* slider) override;
-    void sliderDragStarted (Slider* slider) override
-    {
-    }
+    void mouseMove (const MouseEvent& e) override;
+    void mouseExit (const MouseEvent& e) override;
+    void mouseDown (const MouseEvent& e) override;
+    void mouseDrag (const MouseEvent& e) override;
+    void mouseUp (const MouseEvent& e) override;
+    void mouseWheelMove (const MouseEvent& e, const MouseWheelDetails& wheel) override;
 
-    void sliderDragEnded (Slider* slider) override
-    {
-    }
+    bool keyPressed (const KeyPress& key) override;
+    void focusGained (FocusChangeType cause) override;
+    void focusLost (FocusChangeType cause) override;
 
-private:
-    vector<ScopedPointer<Slider> > mGainSliders;  // a vector contianing the gain sliders
+    /**
+     *  Returns the frequency and gain of the band under the mouse
+     */
+    String getTooltip () override;
+
+    /**
+     *  Called when one of the band gain parameters changes, possibly from the audio thread
+     */
+    void parameterChanged (const String& parameterID, float newValue) override;
 
-    vector<ScopedPointer<AudioProcessorValueTreeState::SliderAttachment> > mGainSliderAttachment;
+    /**
+     *  Returns the index of the band at an x position, or -1 if there's none
+     */
+    int getBandAt (int x) const;
 
+private:
     int mNumBands;  // number of EQ bands
 
+    NormalisableRange<float> mGainRange;
+
+    vector<float> mGains;                 // band gains in dB, as last picked up from mPendingGains
+    vector<Atomic<float>> mPendingGains;  // band gains in dB, as last reported by the parameters on any thread
+
+    int mHoverBand;  // band under the mouse, or -1
+    int mDragBand;   // band being dragged, or -1
+    int mKeyBand;    // band the arrow keys change, highlighted while the component has keyboard focus
+
     std::vector<int> mFreqs = {20,   50,   83,   120,  161,  208,  259,   318,   383,   455,   537,   628,  729,  843,
                                971,  1114, 1273, 1452, 1652, 1875, 2126,  2406,  2719,  3070,  3462,  3901, 4392, 4941,
                                5556, 6244, 7014, 7875, 8839, 9917, 11124, 12474, 13984, 15675, 17566, 19682};
 
+    void handleAsyncUpdate () override;
+
+    /**
+     *  Returns the distance of the track ends from the top/bottom of the component, as a Slider would leave for its
+     *  thumb
+     */
+    int getThumbIndent () const;
+
+    /**
+     *  Returns the width of each band's column
+     */
+    float getBandWidth () const
+    {
+        return getWidth () / (float) mNumBands;
+    }
+
+    /**
+     *  Converts between a gain in dB and a y position on the tracks
+     */
+    float gainToY (float gain) const;
+    float yToGain (float y) const;
+
+    /**
+     *  Sets a band's gain parameter, notifying the host
+     */
+    void setBandGain (int band, float gain);
+
+    /**
+     *  Changes a band's gain parameter by a number of dB, as a single change gesture
+     */
+    void stepBandGain (int band, float step);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphicEQComponent)
 };
 }
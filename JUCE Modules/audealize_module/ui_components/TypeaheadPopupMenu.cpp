@@ -97,6 +97,7 @@ TypeaheadEditor::TypeaheadEditor ()
 
 TypeaheadEditor::~TypeaheadEditor ()
 {
+    Desktop::getInstance ().removeFocusChangeListener (this);
     Desktop::getInstance ().removeGlobalMouseListener (this);
 }
 
@@ -135,8 +136,7 @@ void TypeaheadEditor::showMenu ()
     menu->addKeyListener (this);
 
     Desktop::getInstance ().addGlobalMouseListener (this);
-
-    startTimer (200);
+    Desktop::getInstance ().addFocusChangeListener (this);
 }
 
 void TypeaheadEditor::textEditorTextChanged (TextEditor&)
@@ -230,23 +230,25 @@ void TypeaheadEditor::textEditorTextChanged (TextEditor&)
 void TypeaheadEditor::dismissMenu ()
 {
     menu = nullptr;
-    stopTimer ();
+    Desktop::getInstance ().removeFocusChangeListener (this);
     Desktop::getInstance ().removeGlobalMouseListener (this);
 }
 
-void TypeaheadEditor::timerCallback ()
+void TypeaheadEditor::globalFocusChanged (Component* focusedComponent)
 {
-    if (!Process::isForegroundProcess ())
-        // dismissMenu();
+    if (menu)
+    {
+        if (!hasKeyboardFocus (true) && !menu->hasKeyboardFocus (true)) dismissMenu ();
+    }
+    else
+    {
+        if (!hasKeyboardFocus (true)) dismissMenu ();
+    }
+}
 
-        if (menu)
-        {
-            if (!hasKeyboardFocus (true) && !menu->hasKeyboardFocus (true)) dismissMenu ();
-        }
-        else
-        {
-            if (!hasKeyboardFocus (true)) dismissMenu ();
-        }
+void TypeaheadEditor::visibilityChanged ()
+{
+    if (!isVisible ()) dismissMenu ();
 }
 
 bool TypeaheadEditor::keyPressed (const KeyPress& key, Component* component)
@@ -123,7 +123,7 @@ private:
 class TypeaheadEditor : public Component,
                         public TextEditor::Listener,
                         public KeyListener,
-                        public Timer,
+                        public FocusChangeListener,
                         public ActionListener
 {
 public:
@@ -158,9 +158,15 @@ public:
     void dismissMenu ();
 
     /**
-     *  Inherited from timer
+     *  Called when keyboard focus moves anywhere in the app while the menu is showing. Dismisses the menu once
+     *  neither the editor nor the menu has focus. Inherited from FocusChangeListener
      */
-    void timerCallback () override;
+    void globalFocusChanged (Component* focusedComponent) override;
+
+    /**
+     *  Dismisses the menu when the editor is hidden
+     */
+    void visibilityChanged () override;
 
     /**
      *  Called when a key is pressed. Inherited from KeyListener
@@ -39,9 +39,19 @@ WordMap::WordMap (AudealizeAudioProcessor& p, json descriptors)
       colors (0),
       font_sizes (0)
 {
+    // compact descriptor sets hold a reduced basis and the descriptors' coefficients in it
+    if (json_dict.is_object () && json_dict.find ("descriptors") != json_dict.end ())
+    {
+        basis.fromJson (json_dict["basis"]);
+        json_dict = descriptors["descriptors"];
+    }
+
     // initialize circle positions
     circle_position = Point<float> (150, 50);
     hover_position = Point<float> (100, 50);
+    mouse_position = hover_position;
+    hover_index = -1;
+    matches_pending = false;
 
     // default size of info text
     infotext_size = 12;
@@ -56,8 +66,16 @@ WordMap::WordMap (AudealizeAudioProcessor& p, json descriptors)
     init_map = true;
     has_been_hovered = false;
     languages = {};
+    preview_engine = nullptr;
+    audition_index = -1;
 
-    startTimerHz (60);  // limit repaint rate to 60hz
+    // follow parameter changes so the descriptors closest to the current settings can be highlighted
+    num_map_params =
+        basis.isEmpty () ? (int) json_dict.begin ().value ()["settings"].size () : basis.getNumDimensions ();
+    for (int i = 0; i < num_map_params; i++)
+    {
+        processor.getValueTreeState ().addParameterListener (processor.getParamID (i), this);
+    }
 
     loadPoints ();
 
@@ -67,6 +85,10 @@ WordMap::WordMap (AudealizeAudioProcessor& p, json descriptors)
 
 WordMap::~WordMap ()
 {
+    for (int i = 0; i < num_map_params; i++)
+    {
+        processor.getValueTreeState ().removeParameterListener (processor.getParamID (i), this);
+    }
 }
 
 void WordMap::loadPoints ()
@@ -112,7 +134,7 @@ void WordMap::loadPoints ()
             words.push_back (word);
             word_dict[word] = word_count;
             points.push_back (point);
-            params.push_back (it.value ()["settings"]);
+            params.push_back (basis.isEmpty () ? it.value ()["settings"] : it.value ()["coeffs"]);
             nums.push_back (num);
 
             // calculate color. random rgb, alpha based on agreement score
@@ -137,22 +159,53 @@ void WordMap::loadPoints ()
         }
     }
     normalizePoints ();
+    updateInterpolator ();
+    updateCollisions ();
+    hover_index = -1;
+
+    // index the settings of the plotted descriptors. Coefficients already represent normalised settings. Descriptors
+    // that can't be normalised (a flat EQ curve) are indexed at a point no query can get close to
+    if (basis.isEmpty ())
+    {
+        vector<vector<float>> normalised (params.size ());
+        for (int i = 0; i < params.size (); i++)
+        {
+            normalised[i] = processor.normaliseMapSettings (params[i]);
+            if (normalised[i].size () != num_map_params)
+            {
+                normalised[i].assign (num_map_params, 1.0e6f);
+            }
+        }
+        settings_index.setSettings (normalised);
+    }
+    else
+    {
+        settings_index.setSettings (params);
+    }
+    matched_indices.clear ();
+    triggerAsyncUpdate ();
+
+    repaint ();
 
     sendActionMessage ("_languagechanged");
 }
 
 void WordMap::paint (Graphics& g)
 {
-    setDirty (false);
+    // the settings changed while the map was hidden
+    if (matches_pending)
+    {
+        updateMatches ();
+    }
 
     g.fillAll (getLookAndFeel ().findColour (WordMap::backgroundColourId));
 
-    vector<Point<float>> plotted (0);
     String word;
-    int font_size, hover_center;
+    int font_size, hover_center = -1;
     Point<float> point;
     Colour color;
-    bool hover_radius, in_radius, collision;
+    bool hover_radius, in_radius, matched;
+    const bool dark_mode = static_cast<AudealizeLookAndFeel&> (getLookAndFeel ()).isDarkModeActive ();
 
     // Draw border
     Path outline;
@@ -167,18 +220,24 @@ void WordMap::paint (Graphics& g)
     // if mouse is over map, find word being hovered over
     if (isMouseOverOrDragging ())
     {
-        hover_center = find_closest_word_in_map (hover_position);
+        hover_center = hover_index;
     }
 
-    // Draw words
+    // Draw words. Only those in the area being repainted need to be laid out
     for (int i = 0; i < words.size (); i++)
     {
+        if (!g.clipRegionIntersects (getWordBounds (i)))
+        {
+            continue;
+        }
+
         in_radius = false;
         hover_radius = false;
+        matched = std::find (matched_indices.begin (), matched_indices.end (), i) != matched_indices.end ();
         word = words[i];
         font_size = font_sizes[i];
 
-        if (static_cast<AudealizeLookAndFeel&> (getLookAndFeel ()).isDarkModeActive ())
+        if (dark_mode)
         {
             color = colors[i].withMultipliedSaturation (.4).withMultipliedBrightness (1.7);
         }
@@ -187,23 +246,20 @@ void WordMap::paint (Graphics& g)
             color = colors[i];
         }
 
-        point.setX ((0.1f + points[i].getX () * 0.8f) * getWidth ());
-        point.setY ((0.05f + points[i].getY () * 0.9f) * getHeight ());
-
-        collision = check_for_collision (point, plotted, font_size + word.length () + pad);
+        point = getWordPosition (i);
 
         if (!init_map)
         {
-            in_radius = inRadius (point, circle_position, 75);
+            in_radius = inRadius (point, circle_position, highlight_radius);
         }
 
         if (isMouseOverOrDragging ())
         {
-            hover_radius = inRadius (point, hover_position, 75);
+            hover_radius = inRadius (point, hover_position, highlight_radius);
         }
 
         // set word alpha
-        if (i == center_index || i == hover_center)
+        if (i == center_index || i == hover_center || matched)
         {
             color = Colour::fromRGBA (color.getRed (), color.getGreen (), color.getBlue (), 255);
         }
@@ -223,12 +279,19 @@ void WordMap::paint (Graphics& g)
 
         // end set alpha
 
-        if (!collision || hover_radius || in_radius)
+        if (!collisions[i] || hover_radius || in_radius || matched)
         {
             plot_word (word, color, font_size, point, g);
         }
 
-        plotted.push_back (point);
+        // underline the descriptors closest to the current settings
+        if (matched)
+        {
+            float width = jmin ((float) word.length () * font_size * 0.5f, 120.0f);
+            g.setColour (findColour (circleColourId).withMultipliedAlpha (.7));
+            g.drawLine (point.getX () - width * 0.5f, point.getY () + font_size * 0.6f, point.getX () + width * 0.5f,
+                        point.getY () + font_size * 0.6f, 1.5f);
+        }
     }  // end word loop
 
     // selection circle
@@ -237,14 +300,16 @@ void WordMap::paint (Graphics& g)
         g.setColour (findColour (circleColourId).withMultipliedAlpha (.7));
         // g.drawImage(ImageCache::getFromMemory(Resources::circleDark_png, Resources::circleDark_pngSize) ,
         // circle_position.getX()-16, circle_position.getY()-16, 32, 32, 0, 0, 32, 32);
-        g.drawEllipse (circle_position.getX () - 16, circle_position.getY () - 16, 32, 32, 2);
+        g.drawEllipse (circle_position.getX () - circle_radius, circle_position.getY () - circle_radius,
+                       circle_radius * 2, circle_radius * 2, 2);
     }
 
     // mouse circle
     if (has_been_hovered)
     {
         g.setColour (findColour (circleColourId));
-        g.drawEllipse (getMouseXYRelative ().getX () - 16, getMouseXYRelative ().getY () - 16, 32, 32, 2);
+        g.drawEllipse (mouse_position.getX () - circle_radius, mouse_position.getY () - circle_radius,
+                       circle_radius * 2, circle_radius * 2, 2);
     }
 
     // Draw info text
@@ -261,10 +326,30 @@ void WordMap::paint (Graphics& g)
             String ("\"" + words[center_index] + "\" learned from " + String (nums[center_index]) + " contributions.");
         g.drawText (info_text, 6, getHeight () - 22, 250, 18, Justification::bottomLeft);
     }
+
+    if (matched_indices.size () > 0)
+    {
+        StringArray matches;
+        for (int i = 0; i < matched_indices.size (); i++)
+        {
+            matches.add (words[matched_indices[i]]);
+        }
+
+        info_text = String ("Current settings sound like: " + matches.joinIntoString (", "));
+        g.drawText (info_text, 6, getHeight () - 40, 412, 18, Justification::bottomLeft);
+    }
 }
 
 void WordMap::resized ()
 {
+    updateInterpolator ();
+    updateCollisions ();
+
+    if (hover_index >= 0)
+    {
+        hover_index = find_closest_word_in_map (hover_position);
+    }
+
     // update circle position
     if (!init_map)
     {
@@ -278,49 +363,116 @@ void WordMap::resized ()
 
 void WordMap::mouseMove (const MouseEvent& e)
 {
-    hover_position = getMouseXYRelative ().toFloat ();
-    setDirty ();
+    const Point<float> old_hover = hover_position, old_mouse = mouse_position;
+    const int old_index = hover_index;
+
+    hover_position = mouse_position = getMouseXYRelative ().toFloat ();
+    hover_index = find_closest_word_in_map (hover_position);
+    updatePreview ();
+
+    repaintHoverChange (old_hover, old_index, old_mouse, true);
 }
 
 void WordMap::mouseEnter (const MouseEvent& e)
 {
+    const Point<float> old_hover = hover_position, old_mouse = mouse_position;
+    const int old_index = hover_index;
+    const bool had_been_hovered = has_been_hovered;
+
     has_been_hovered = true;
-    hover_position = getMouseXYRelative ().toFloat ();
-    setDirty ();
+    hover_position = mouse_position = getMouseXYRelative ().toFloat ();
+    hover_index = find_closest_word_in_map (hover_position);
+
+    if (preview_engine != nullptr)
+    {
+        preview_engine->captureInput ();
+        updatePreview ();
+    }
+
+    repaintHoverChange (old_hover, old_index, had_been_hovered ? old_mouse : mouse_position, false);
 }
 
 void WordMap::mouseExit (const MouseEvent& e)
 {
-    hover_position = getMouseXYRelative ().toFloat ();
+    const Point<float> old_hover = hover_position, old_mouse = mouse_position;
+    const int old_index = hover_index;
+
+    hover_position = mouse_position = getMouseXYRelative ().toFloat ();
+
+    if (preview_engine != nullptr)
+    {
+        preview_engine->stopAudition ();
+        audition_index = -1;
+    }
+
+    repaintHoverChange (old_hover, old_index, old_mouse, true);
 }
 
 void WordMap::mouseDown (const MouseEvent& e)
 {
+    // clicking applies the descriptor for real, so stop auditioning
+    if (preview_engine != nullptr)
+    {
+        preview_engine->stopAudition ();
+        audition_index = -1;
+    }
+
+    const Point<float> old_circle = circle_position;
+    const int old_index = center_index;
+    const bool was_init = init_map;
+
     init_map = false;
     circle_position = getMouseXYRelative ().toFloat ();
     center_index = find_closest_word_in_map (getMouseXYRelative ().toFloat ());
     wordSelected (words[center_index]);
-    setDirty ();
+
+    repaintSelectionChange (old_circle, old_index, was_init);
 }
 
 void WordMap::mouseDrag (const MouseEvent& e)
 {
-    circle_position = getMouseXYRelative ().toFloat ();
-    center_index = find_closest_word_in_map (getMouseXYRelative ().toFloat ());
-    wordSelected (words[center_index]);
-    setDirty ();
+    // while dragging, the circle follows the mouse and the settings are blended from the descriptors around it
+    const Point<float> old_circle = circle_position, old_mouse = mouse_position;
+    const int old_index = center_index;
+    const bool was_init = init_map;
+
+    circle_position = mouse_position = getMouseXYRelative ().toFloat ();
+    repaint (getCircleBounds (old_mouse));
+    repaint (getCircleBounds (mouse_position));
+
+    int nearest = interpolator.blend (circle_position, params, blended_params);
+    if (nearest < 0)
+    {
+        return;
+    }
+
+    init_map = false;
+
+    if (nearest != center_index)
+    {
+        center_index = nearest;
+        sendActionMessage (words[nearest]);
+    }
+
+    // a crossfade for every mouse event would keep the worker and the audio thread busy with back to back fades
+    processor.settingsFromMap (getFullSettings (blended_params), false);
+    repaintSelectionChange (old_circle, old_index, was_init);
 }
 
 void WordMap::wordSelected (String word)
 {
     sendActionMessage (word);  // broadcast a message containing the descriptor to all ActionListeners
 
+    const bool was_init = init_map;
     init_map = false;  // word has been selected, map is no longer in initial state
 
     int index = word_dict[word.toRawUTF8 ()];  // find the index of the word that was selected
 
     if (index < words.size ())  // make sure it's a valid index
     {
+        const Point<float> old_circle = circle_position;
+        const int old_index = center_index;
+
         center_index = index;
 
         // calculate the position of the word in the map and update the circle position
@@ -329,10 +481,277 @@ void WordMap::wordSelected (String word)
         point.setY ((0.05f + points[index].getY () * 0.9f) * getHeight ());
         circle_position = point;
 
-        processor.settingsFromMap (
-            params[index]);  // tell the AudioProcessor to apply the effect associated witht the descriptor
+        // tell the AudioProcessor to apply the effect associated witht the descriptor
+        processor.settingsFromMap (getFullSettings (params[index]), true);
+
+        repaintSelectionChange (old_circle, old_index, was_init);
+    }
+}
+
+vector<float> WordMap::getFullSettings (const vector<float>& stored) const
+{
+    return basis.isEmpty () ? stored : basis.reconstruct (stored);
+}
+
+void WordMap::parameterChanged (const String& parameterID, float newValue)
+{
+    // may be called from the audio thread
+    triggerAsyncUpdate ();
+}
+
+void WordMap::handleAsyncUpdate ()
+{
+    // nothing to highlight while hidden; paint catches up when the map is shown again
+    if (!isShowing ())
+    {
+        matches_pending = true;
+        return;
+    }
+
+    const vector<int> old_matches = matched_indices;
+
+    if (!updateMatches ())
+    {
+        return;
+    }
+
+    RectangleList<int> dirty (getInfoTextBounds ());
+    for (int i : old_matches)
+    {
+        dirty.add (getWordBounds (i));
+    }
+    for (int i : matched_indices)
+    {
+        dirty.add (getWordBounds (i));
+    }
+    repaintRegions (dirty);
+}
+
+bool WordMap::updateMatches ()
+{
+    matches_pending = false;
+
+    vector<float> current = processor.getCurrentMapSettings ();
+    const vector<int> old_matches = matched_indices;
+    matched_indices.clear ();
+
+    if (!basis.isEmpty () && current.size () == basis.getNumDimensions ())
+    {
+        current = basis.project (current);
+    }
+
+    if (current.size () == settings_index.getNumDimensions () && current.size () > 0)
+    {
+        int indices[8];
+        float distances[8];
+        int found = settings_index.findNearest (current.data (), jmin (num_matches, 8), indices, distances);
+
+        matched_indices.assign (indices, indices + found);
+    }
+
+    return matched_indices != old_matches;
+}
+
+void WordMap::updateCollisions ()
+{
+    vector<Point<float>> plotted;
+    plotted.reserve (words.size ());
+    collisions.assign (words.size (), false);
+    word_widths.resize (words.size ());
+
+    for (int i = 0; i < words.size (); i++)
+    {
+        Point<float> point = getWordPosition (i);
+        collisions[i] = check_for_collision (point, plotted, font_sizes[i] + words[i].length () + pad);
+        plotted.push_back (point);
+
+        word_widths[i] =
+            Font (Font::getDefaultSansSerifFontName (), font_sizes[i], Font::plain).getStringWidthFloat (words[i]);
+    }
+}
+
+Point<float> WordMap::getWordPosition (int index)
+{
+    return Point<float> ((0.1f + points[index].getX () * 0.8f) * getWidth (),
+                         (0.05f + points[index].getY () * 0.9f) * getHeight ());
+}
+
+Rectangle<int> WordMap::getWordBounds (int index)
+{
+    if (index < 0 || index >= words.size ())
+    {
+        return Rectangle<int> ();
+    }
+
+    // the text plot_word centres on the point, with room for descenders and the underline of matched descriptors
+    const Point<float> point = getWordPosition (index);
+    const float font_size = (float) font_sizes[index];
+    const float width = jmax (word_widths[index], jmin ((float) words[index].length () * font_size * 0.5f, 120.0f));
+
+    return Rectangle<float> (point.getX () - width * 0.5f, point.getY () - font_size * 0.75f, width, font_size * 1.5f)
+        .getSmallestIntegerContainer ()
+        .expanded (2);
+}
+
+Rectangle<int> WordMap::getCircleBounds (Point<float> centre)
+{
+    return Rectangle<float> (centre.getX () - circle_radius, centre.getY () - circle_radius, circle_radius * 2,
+                             circle_radius * 2)
+        .getSmallestIntegerContainer ()
+        .expanded (2);
+}
+
+void WordMap::addHighlightChanges (RectangleList<int>& dirty, Point<float> old_centre, bool was_active,
+                                   Point<float> new_centre, bool is_active)
+{
+    for (int i = 0; i < words.size (); i++)
+    {
+        const Point<float> point = getWordPosition (i);
+
+        if ((was_active && inRadius (point, old_centre, highlight_radius)) !=
+            (is_active && inRadius (point, new_centre, highlight_radius)))
+        {
+            dirty.add (getWordBounds (i));
+        }
+    }
+}
+
+void WordMap::repaintRegions (const RectangleList<int>& dirty)
+{
+    for (const Rectangle<int>* r = dirty.begin (); r != dirty.end (); ++r)
+    {
+        repaint (*r);
+    }
+}
+
+Rectangle<int> WordMap::getInfoTextBounds ()
+{
+    return Rectangle<int> (0, getHeight () - 42, getWidth (), 42);
+}
+
+void WordMap::repaintHoverChange (Point<float> old_hover, int old_index, Point<float> old_mouse, bool was_hovering)
+{
+    RectangleList<int> dirty;
+    addHighlightChanges (dirty, old_hover, was_hovering, hover_position, isMouseOverOrDragging ());
+
+    if (old_index != hover_index)
+    {
+        dirty.add (getWordBounds (old_index));
+        dirty.add (getWordBounds (hover_index));
+    }
+
+    if (has_been_hovered)
+    {
+        dirty.add (getCircleBounds (old_mouse));
+        dirty.add (getCircleBounds (mouse_position));
+    }
+
+    repaintRegions (dirty);
+}
+
+void WordMap::repaintSelectionChange (Point<float> old_circle, int old_index, bool was_init)
+{
+    RectangleList<int> dirty;
+    addHighlightChanges (dirty, old_circle, !was_init, circle_position, !init_map);
+
+    if (!was_init)
+    {
+        dirty.add (getCircleBounds (old_circle));
+    }
+
+    if (!init_map)
+    {
+        dirty.add (getCircleBounds (circle_position));
+    }
 
-        setDirty ();  // wordmap needs to be repainted
+    if (old_index != center_index)
+    {
+        dirty.add (getWordBounds (old_index));
+        dirty.add (getWordBounds (center_index));
+        dirty.add (getInfoTextBounds ());
+    }
+
+    repaintRegions (dirty);
+}
+
+void WordMap::updateInterpolator ()
+{
+    vector<Point<float>> positions (points.size ());
+
+    for (int i = 0; i < points.size (); i++)
+    {
+        positions[i].setX ((0.1f + points[i].getX () * 0.8f) * getWidth ());
+        positions[i].setY ((0.05f + points[i].getY () * 0.9f) * getHeight ());
+    }
+
+    interpolator.setPositions (positions);
+}
+
+void WordMap::setPreviewEngine (PreviewEngine* engine)
+{
+    if (preview_engine != nullptr)
+    {
+        preview_engine->stopAudition ();
+    }
+
+    preview_engine = engine;
+    audition_index = -1;
+}
+
+size_t WordMap::getSizeInBytes () const
+{
+    size_t size = MemoryUsage::sizeOf (json_dict) + MemoryUsage::sizeOf (word_dict) + MemoryUsage::sizeOf (languages);
+
+    size += MemoryUsage::sizeOf (words) + MemoryUsage::sizeOf (params);
+    for (int i = 0; i < words.size (); i++)
+    {
+        size += MemoryUsage::sizeOf (words[i]);
+    }
+    for (int i = 0; i < params.size (); i++)
+    {
+        size += MemoryUsage::sizeOf (params[i]);
+    }
+
+    size += MemoryUsage::sizeOf (points) + MemoryUsage::sizeOf (excluded_points) + MemoryUsage::sizeOf (font_sizes) +
+            MemoryUsage::sizeOf (nums) + MemoryUsage::sizeOf (colors) + MemoryUsage::sizeOf (blended_params) +
+            MemoryUsage::sizeOf (matched_indices) + MemoryUsage::sizeOf (collisions) +
+            MemoryUsage::sizeOf (word_widths);
+
+    return size + basis.getSizeInBytes () + interpolator.getSizeInBytes () + settings_index.getSizeInBytes ();
+}
+
+void WordMap::updatePreview ()
+{
+    if (preview_engine == nullptr || words.size () == 0)
+    {
+        return;
+    }
+
+    int closest = find_closest_word_in_map (hover_position);
+
+    // render the descriptors inside the hover circle ahead of time, closest first
+    vector<String> nearby_words (1, words[closest]);
+    vector<vector<float>> nearby_params (1, getFullSettings (params[closest]));
+    Point<float> point;
+
+    for (int i = 0; i < words.size (); i++)
+    {
+        point.setX ((0.1f + points[i].getX () * 0.8f) * getWidth ());
+        point.setY ((0.05f + points[i].getY () * 0.9f) * getHeight ());
+
+        if (i != closest && inRadius (point, hover_position, highlight_radius))
+        {
+            nearby_words.push_back (words[i]);
+            nearby_params.push_back (getFullSettings (params[i]));
+        }
+    }
+
+    preview_engine->prefetch (nearby_words, nearby_params);
+
+    if (closest != audition_index)
+    {
+        audition_index = closest;
+        preview_engine->audition (words[closest], nearby_params[0]);
     }
 }
 
@@ -381,6 +800,11 @@ int WordMap::find_closest_word_in_map (Point<float> point)
     float dist;
     Point<float> pt;
 
+    if (interpolator.findNearest (point, 1, &bestword, &mindist) == 1)
+    {
+        return bestword;
+    }
+
     for (int i = 0; i < points.size (); i++)
     {
         // calculate the position of the points in pixels
@@ -449,8 +873,8 @@ void WordMap::normalizePoints ()
 void WordMap::toggleLanguage (string language, bool enabled)
 {
     languages[language] = enabled;
+    audition_index = -1;
     loadPoints ();
-    setDirty ();
 }
 
 bool WordMap::searchMapAndSelect (juce::String text)
@@ -466,14 +890,6 @@ bool WordMap::searchMapAndSelect (juce::String text)
     return false;
 }
 
-void WordMap::timerCallback ()
-{
-    if (isdirty)
-    {
-        repaint ();
-    }
-}
-
 void WordMap::setMinFontSize (int fontSize)
 {
     vector<Colour> temp = colors;
@@ -482,9 +898,4 @@ void WordMap::setMinFontSize (int fontSize)
     colors = temp;
 }
 
-void WordMap::setDirty (bool dirty)
-{
-    isdirty = dirty;
-}
-
 }  // namespace Audealize
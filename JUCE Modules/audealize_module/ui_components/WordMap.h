@@ -36,8 +36,17 @@ using std::string;
 
 namespace Audealize
 {
+class PreviewEngine;
+
 /// A juce::Component containing a map of descriptors for Audealize plugins.
-class WordMap : public Component, public Timer, public ActionBroadcaster
+///
+/// The map has no repaint timer. Each change of state (hover, selection, closest matches) invalidates just the region
+/// it affects: the circles, the descriptors whose highlighting changed and the info text. JUCE merges these regions and
+/// paints them together on the next frame, so an idle map costs nothing.
+class WordMap : public Component,
+                public ActionBroadcaster,
+                public AudioProcessorValueTreeState::Listener,
+                public AsyncUpdater
 {
 public:
     enum ColourIds
@@ -84,11 +93,6 @@ public:
      */
     bool searchMapAndSelect (String text);
 
-    /**
-     *  Inherited from JUCE::Timer
-     */
-    void timerCallback () override;
-
     /**
      *  Set the minimum font size for the map
      */
@@ -110,6 +114,23 @@ public:
         return words;
     }
 
+    /**
+     *  @return the settings of each word in the map, in the same order as getWords (). These are coefficients in
+     *          getBasis () if the descriptor set has a basis
+     */
+    const vector<vector<float>>& getWordSettings () const
+    {
+        return params;
+    }
+
+    /**
+     *  @return the reduced basis the descriptor settings are stored in. Empty if they're stored in full
+     */
+    const DescriptorBasis& getBasis () const
+    {
+        return basis;
+    }
+
     /**
      *  Return an nlohmann::json dictionary of the languages present in the descriptor set
      *
@@ -125,6 +146,35 @@ public:
         return center_index >= 0 ? words[center_index] : "";
     }
 
+    /**
+     *  Called when one of the processor's parameters changes, e.g. from the traditional UI or host automation.
+     *  Schedules a search for the descriptors closest to the new settings
+     */
+    void parameterChanged (const String& parameterID, float newValue) override;
+
+    /**
+     *  Finds the descriptors closest to the current settings and highlights them
+     */
+    void handleAsyncUpdate () override;
+
+    /**
+     *  Returns the indices of the descriptors closest to the current settings, closest first
+     */
+    const vector<int>& getMatchedWords () const
+    {
+        return matched_indices;
+    }
+
+    /**
+     *  Sets the PreviewEngine used to audition the descriptors under the mouse. Pass nullptr to disable auditioning
+     */
+    void setPreviewEngine (PreviewEngine* engine);
+
+    /**
+     *  Returns the memory allocated for the descriptor dataset and the map's layout and indices, in bytes
+     */
+    size_t getSizeInBytes () const;
+
 private:
     AudealizeAudioProcessor& processor;  // the main plugin audio processor
 
@@ -138,13 +188,20 @@ private:
 
     Point<float> hover_position, circle_position;  // positions of the hover and selection circles
 
+    Point<float> mouse_position;  // position of the mouse circle
+
+    int hover_index;  // index of the descriptor closest to hover_position
+
     vector<String> words;  // the descriptors to be plotted on the map
 
     vector<Point<float>> points;  // the points at which the descriptors will be plotted
 
     vector<Point<float>> excluded_points;  // the points corresponding to descriptors in the that will not be plotted
 
-    vector<vector<float>> params;  // the settings associated with the descriptors being plotted
+    vector<vector<float>> params;  // the settings associated with the descriptors being plotted (coefficients in
+                                   // basis, if the descriptor set has one)
+
+    DescriptorBasis basis;  // reduced basis of the descriptor settings, if the descriptor set has one
 
     vector<int> font_sizes;  // the font sizes of the descriptors being plotted
 
@@ -166,10 +223,28 @@ private:
 
     bool has_been_hovered;  // true if the map has been moused over
 
-    bool isdirty;  // true if component needs to be redrawn
-
     bool has_searchbar;  // true if a searchbar has been attached
 
+    PreviewEngine* preview_engine;  // auditions descriptors on hover, if set
+
+    int audition_index;  // index of the descriptor currently being auditioned, or -1
+
+    DescriptorInterpolator interpolator;  // spatial index of the plotted descriptors, in pixels
+
+    vector<float> blended_params;  // settings blended from the descriptors around the mouse while dragging
+
+    SettingsIndex settings_index;  // the plotted descriptors' settings, normalised like the processor's parameters
+
+    vector<int> matched_indices;  // indices of the descriptors closest to the current settings, closest first
+
+    bool matches_pending;  // true if the settings changed while the map wasn't showing
+
+    vector<bool> collisions;  // true for the descriptors that overlap one plotted before them
+
+    vector<float> word_widths;  // widths of the descriptors' text in pixels
+
+    int num_map_params;  // number of parameters settingsFromMap sets
+
     NormalisableRange<int> alpha_range;  // for converting between alpha values in range [0,1] (float) and [0,255] (int)
 
     //=====================================================================
@@ -178,6 +253,9 @@ private:
     const int pad = 2;                                 // amount of padding between mapped descriptors
     const int unhighlighted_alpha_value = 0.8f * 255;  // alpha value of unhighlighted descriptors
     const int hover_alpha_value = 0.15f * 255;  // alpha value of descriptors within hover radius but not selected
+    const int num_matches = 3;                  // number of descriptors highlighted as closest to the current settings
+    const float highlight_radius = 75;  // descriptors this close to the hover/selection circles are highlighted
+    const float circle_radius = 16;     // radius of the hover/selection circles
 
     //=====================================================================
 
@@ -254,11 +332,91 @@ private:
     void wordSelected (String word);
 
     /**
-     *  Set the component dirty if it needs to be redrawn
+     *  Returns the full settings of a descriptor, as passed to settingsFromMap, reconstructing them from the basis if
+     *  necessary
+     *
+     *  @param stored an element of params, or a blend of them
+     */
+    vector<float> getFullSettings (const vector<float>& stored) const;
+
+    /**
+     *  Rebuilds the interpolator's spatial index from the pixel positions of the plotted descriptors
+     */
+    void updateInterpolator ();
+
+    /**
+     *  Auditions the descriptor closest to the mouse, and queues preview renders for the descriptors around it
+     */
+    void updatePreview ();
+
+    /**
+     *  Finds which descriptors overlap one plotted before them (these are only drawn when highlighted), and measures
+     *  the descriptors' text
+     */
+    void updateCollisions ();
+
+    /**
+     *  Finds the descriptors closest to the current settings
+     *
+     *  @return true if they differ from the previous matches
+     */
+    bool updateMatches ();
+
+    /**
+     *  Returns the position of a descriptor in pixels
+     */
+    Point<float> getWordPosition (int index);
+
+    /**
+     *  Returns the area a descriptor (and its underline) may be drawn in
+     */
+    Rectangle<int> getWordBounds (int index);
+
+    /**
+     *  Returns the area the hover/selection circle covers when centred at a point
+     */
+    Rectangle<int> getCircleBounds (Point<float> centre);
+
+    /**
+     *  Adds the area of every descriptor whose highlighting changes when a highlight circle moves to a list
+     *
+     *  @param dirty      the list to add to
+     *  @param old_centre previous centre of the circle
+     *  @param was_active true if the circle was highlighting descriptors before
+     *  @param new_centre new centre of the circle
+     *  @param is_active  true if the circle is highlighting descriptors now
+     */
+    void addHighlightChanges (RectangleList<int>& dirty, Point<float> old_centre, bool was_active,
+                              Point<float> new_centre, bool is_active);
+
+    /**
+     *  Repaints each rectangle of a list. The component's peer merges them into a single paint
+     */
+    void repaintRegions (const RectangleList<int>& dirty);
+
+    /**
+     *  Returns the area the info text at the bottom of the map is drawn in
+     */
+    Rectangle<int> getInfoTextBounds ();
+
+    /**
+     *  Repaints what changed after the mouse moved
+     *
+     *  @param old_hover    previous hover_position
+     *  @param old_index    previous hover_index
+     *  @param old_mouse    previous mouse_position
+     *  @param was_hovering true if the mouse was over the map before
+     */
+    void repaintHoverChange (Point<float> old_hover, int old_index, Point<float> old_mouse, bool was_hovering);
+
+    /**
+     *  Repaints what changed after the selection moved
      *
-     *  @param dirty
+     *  @param old_circle previous circle_position
+     *  @param old_index  previous center_index
+     *  @param was_init   previous init_map
      */
-    void setDirty (bool dirty = true);
+    void repaintSelectionChange (Point<float> old_circle, int old_index, bool was_init);
 
     /**
      *  Comparison functions used when normalizing a vector<Point<float>>
@@ -0,0 +1,166 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef AuditionPlayer_h
+#define AuditionPlayer_h
+
+namespace Audealize
+{
+/// A mono render of a descriptor preview
+class AuditionBuffer : public ReferenceCountedObject
+{
+public:
+    typedef ReferenceCountedObjectPtr<AuditionBuffer> Ptr;
+
+    AuditionBuffer (int numSamples) : samples (1, numSamples)
+    {
+    }
+
+    /**
+     *  Returns the memory used by the audio data
+     */
+    size_t getSizeInBytes () const
+    {
+        return (size_t) samples.getNumSamples () * sizeof (float);
+    }
+
+    AudioSampleBuffer samples;
+};
+
+/// Loops an AuditionBuffer in place of an AudioProcessor's output. The buffer can be swapped from any thread but the
+/// audio thread. The audio thread only reads atomic pointers, so it never waits for a swap or misses a block; the
+/// swapping threads hold a reference to every buffer until the audio thread has moved on from it, so the audio thread
+/// never releases one either.
+class AuditionPlayer
+{
+public:
+    AuditionPlayer () : mRequested (nullptr), mPlaying (nullptr), mPosition (0)
+    {
+    }
+
+    /**
+     *  Starts looping a buffer, replacing whatever was playing. Playback continues from the same position in the loop
+     *  so neighbouring previews can be compared directly. Don't call from the audio thread
+     *
+     *  @param buffer The buffer to play, or nullptr to stop
+     */
+    void play (AuditionBuffer::Ptr buffer)
+    {
+        const ScopedLock sl (mLock);
+
+        if (buffer != nullptr)
+        {
+            mBuffers.addIfNotAlreadyThere (buffer);
+        }
+        mRequested = buffer.get ();
+
+        // keep the buffer the audio thread may still be reading. process () publishes it in mPlaying before checking
+        // it is still the one requested, so any other buffer is no longer in use
+        AuditionBuffer* const playing = mPlaying.get ();
+        for (int i = mBuffers.size (); --i >= 0;)
+        {
+            AuditionBuffer* const b = mBuffers.getObjectPointerUnchecked (i);
+            if (b != buffer.get () && b != playing)
+            {
+                mBuffers.remove (i);
+            }
+        }
+    }
+
+    /**
+     *  Stops playback so the processor's own output is heard again
+     */
+    void stop ()
+    {
+        play (nullptr);
+    }
+
+    /**
+     *  Returns true if a buffer is being played
+     */
+    bool isPlaying () const
+    {
+        return mRequested.get () != nullptr;
+    }
+
+    /**
+     *  Overwrites a block of output with the next part of the loop. Called from the audio thread
+     *
+     *  @param buffer      The output block
+     *  @param numChannels Number of output channels
+     *
+     *  @return true if the block was overwritten, false if nothing is playing
+     */
+    bool process (AudioSampleBuffer& buffer, int numChannels)
+    {
+        AuditionBuffer* current = mRequested.get ();
+        for (;;)
+        {
+            mPlaying = current;
+
+            AuditionBuffer* const requested = mRequested.get ();
+            if (requested == current)
+            {
+                break;
+            }
+            current = requested;
+        }
+
+        const bool playing = current != nullptr && current->samples.getNumSamples () > 0;
+        if (playing)
+        {
+            const AudioSampleBuffer& source = current->samples;
+            const int length = source.getNumSamples ();
+            const int numSamples = buffer.getNumSamples ();
+
+            int done = 0;
+            while (done < numSamples)
+            {
+                mPosition %= length;
+                const int numToCopy = jmin (numSamples - done, length - mPosition);
+
+                for (int channel = 0; channel < numChannels; channel++)
+                {
+                    buffer.copyFrom (channel, done, source, 0, mPosition, numToCopy);
+                }
+
+                done += numToCopy;
+                mPosition += numToCopy;
+            }
+        }
+
+        return playing;
+    }
+
+private:
+    Atomic<AuditionBuffer*> mRequested;  // the buffer to play, or nullptr
+    Atomic<AuditionBuffer*> mPlaying;    // the buffer process () is reading, or last read
+    ReferenceCountedArray<AuditionBuffer> mBuffers;  // keeps mRequested and mPlaying alive
+    CriticalSection mLock;                           // serialises play (). never taken by the audio thread
+    int mPosition;  // read position in the loop. only touched by the audio thread
+
+    JUCE_DECLARE_NON_COPYABLE (AuditionPlayer)
+};
+}
+
+#endif /* AuditionPlayer_h */
@@ -44,6 +44,13 @@ public:
     void setBiquad (int type, double Fc, double Q, double peakGain);
     float process (float in);
 
+    // coefficient and state access, used by the offline renderers to run the
+    // filter outside of process ()
+    void getCoefficients (double* coeffs) const;
+    void getState (double* state) const;
+    void setState (const double* state);
+    void reset ();
+
 protected:
     void calcBiquad (void);
 
@@ -61,4 +68,30 @@ inline float Biquad::process (float in)
     return out;
 }
 
+inline void Biquad::getCoefficients (double* coeffs) const
+{
+    coeffs[0] = a0;
+    coeffs[1] = a1;
+    coeffs[2] = a2;
+    coeffs[3] = b1;
+    coeffs[4] = b2;
+}
+
+inline void Biquad::getState (double* state) const
+{
+    state[0] = z1;
+    state[1] = z2;
+}
+
+inline void Biquad::setState (const double* state)
+{
+    z1 = state[0];
+    z2 = state[1];
+}
+
+inline void Biquad::reset ()
+{
+    z1 = z2 = 0.0;
+}
+
 #endif  // Biquad_h
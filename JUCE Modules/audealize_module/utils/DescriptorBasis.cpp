@@ -0,0 +1,315 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "DescriptorBasis.h"
+
+namespace Audealize
+{
+void DescriptorBasis::normalize (vector<float>& settings)
+{
+    if (settings.size () == 0)
+    {
+        return;
+    }
+
+    float max = *std::max_element (settings.begin (), settings.end ());
+    float min = *std::min_element (settings.begin (), settings.end ());
+    for (int i = 0; i < settings.size (); i++)
+    {
+        settings[i] = max > min ? (settings[i] - min) / (max - min) : 0.0f;
+    }
+}
+
+void DescriptorBasis::compute (const vector<vector<float>>& settings, int numComponents)
+{
+    const int n = (int) settings.size ();
+    mNumDims = n > 0 ? (int) settings[0].size () : 0;
+    mNumComponents = jlimit (0, mNumDims, numComponents);
+
+    if (n == 0 || mNumComponents == 0)
+    {
+        mNumComponents = 0;
+        return;
+    }
+
+    const int d = mNumDims;
+
+    // normalized settings and their mean
+    vector<vector<float>> curves (settings);
+    vector<double> mean (d, 0.0);
+    for (int i = 0; i < n; i++)
+    {
+        normalize (curves[i]);
+        for (int j = 0; j < d; j++)
+        {
+            mean[j] += curves[i][j] / n;
+        }
+    }
+
+    // covariance matrix
+    vector<double> cov (d * d, 0.0);
+    for (int i = 0; i < n; i++)
+    {
+        for (int r = 0; r < d; r++)
+        {
+            const double dr = curves[i][r] - mean[r];
+            for (int c = r; c < d; c++)
+            {
+                cov[r * d + c] += dr * (curves[i][c] - mean[c]);
+            }
+        }
+    }
+    for (int r = 0; r < d; r++)
+    {
+        for (int c = r; c < d; c++)
+        {
+            cov[r * d + c] /= n;
+            cov[c * d + r] = cov[r * d + c];
+        }
+    }
+
+    // eigendecomposition by cyclic Jacobi rotations. The matrix is small, so this converges in a few sweeps
+    vector<double> vectors (d * d, 0.0);
+    for (int i = 0; i < d; i++)
+    {
+        vectors[i * d + i] = 1.0;
+    }
+
+    for (int sweep = 0; sweep < 100; sweep++)
+    {
+        double offDiagonal = 0.0;
+        for (int p = 0; p < d; p++)
+        {
+            for (int q = p + 1; q < d; q++)
+            {
+                offDiagonal += cov[p * d + q] * cov[p * d + q];
+            }
+        }
+        if (offDiagonal < 1.0e-22)
+        {
+            break;
+        }
+
+        for (int p = 0; p < d; p++)
+        {
+            for (int q = p + 1; q < d; q++)
+            {
+                const double apq = cov[p * d + q];
+                if (std::abs (apq) < 1.0e-30)
+                    continue;
+
+                const double theta = (cov[q * d + q] - cov[p * d + p]) / (2.0 * apq);
+                const double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs (theta) + std::sqrt (theta * theta + 1.0));
+                const double c = 1.0 / std::sqrt (t * t + 1.0);
+                const double s = t * c;
+
+                for (int k = 0; k < d; k++)
+                {
+                    const double akp = cov[k * d + p], akq = cov[k * d + q];
+                    cov[k * d + p] = c * akp - s * akq;
+                    cov[k * d + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < d; k++)
+                {
+                    const double apk = cov[p * d + k], aqk = cov[q * d + k];
+                    cov[p * d + k] = c * apk - s * aqk;
+                    cov[q * d + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < d; k++)
+                {
+                    const double vkp = vectors[k * d + p], vkq = vectors[k * d + q];
+                    vectors[k * d + p] = c * vkp - s * vkq;
+                    vectors[k * d + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    // keep the eigenvectors with the largest eigenvalues
+    vector<int> order (d);
+    for (int i = 0; i < d; i++)
+    {
+        order[i] = i;
+    }
+    std::sort (order.begin (), order.end (), [&](int a, int b) { return cov[a * d + a] > cov[b * d + b]; });
+
+    mMean.assign (mean.begin (), mean.end ());
+    mComponents.resize (mNumComponents * d);
+    for (int k = 0; k < mNumComponents; k++)
+    {
+        for (int j = 0; j < d; j++)
+        {
+            mComponents[k * d + j] = (float) vectors[j * d + order[k]];
+        }
+    }
+
+    // reconstruction error over the set
+    double sumSquares = 0.0;
+    mMaxError = 0.0f;
+    vector<float> coeffs (mNumComponents), rebuilt (d);
+    for (int i = 0; i < n; i++)
+    {
+        project (curves[i].data (), coeffs.data ());
+        reconstruct (coeffs.data (), rebuilt.data ());
+
+        for (int j = 0; j < d; j++)
+        {
+            const float err = std::abs (rebuilt[j] - curves[i][j]);
+            sumSquares += err * err;
+            mMaxError = jmax (mMaxError, err);
+        }
+    }
+    mRMSError = (float) std::sqrt (sumSquares / (n * d));
+}
+
+void DescriptorBasis::project (const float* settings, float* coeffs) const
+{
+    vector<float> curve (settings, settings + mNumDims);
+    normalize (curve);
+
+    for (int k = 0; k < mNumComponents; k++)
+    {
+        const float* component = &mComponents[k * mNumDims];
+        float sum = 0.0f;
+        for (int j = 0; j < mNumDims; j++)
+        {
+            sum += component[j] * (curve[j] - mMean[j]);
+        }
+        coeffs[k] = sum;
+    }
+}
+
+void DescriptorBasis::projectDirection (const float* v, float* coeffs) const
+{
+    for (int k = 0; k < mNumComponents; k++)
+    {
+        const float* component = &mComponents[k * mNumDims];
+        float sum = 0.0f;
+        for (int j = 0; j < mNumDims; j++)
+        {
+            sum += component[j] * v[j];
+        }
+        coeffs[k] = sum;
+    }
+}
+
+void DescriptorBasis::reconstruct (const float* coeffs, float* settings) const
+{
+    std::copy (mMean.begin (), mMean.end (), settings);
+
+    for (int k = 0; k < mNumComponents; k++)
+    {
+        const float* component = &mComponents[k * mNumDims];
+        for (int j = 0; j < mNumDims; j++)
+        {
+            settings[j] += coeffs[k] * component[j];
+        }
+    }
+}
+
+json DescriptorBasis::toJson () const
+{
+    json j;
+    j["mean"] = mMean;
+    j["rmsError"] = mRMSError;
+    j["maxError"] = mMaxError;
+
+    json components = json::array ();
+    for (int k = 0; k < mNumComponents; k++)
+    {
+        components.push_back (vector<float> (mComponents.begin () + k * mNumDims,
+                                             mComponents.begin () + (k + 1) * mNumDims));
+    }
+    j["components"] = components;
+
+    return j;
+}
+
+bool DescriptorBasis::fromJson (const json& j)
+{
+    mNumDims = mNumComponents = 0;
+
+    if (!j.is_object () || j.find ("mean") == j.end () || j.find ("components") == j.end ())
+    {
+        return false;
+    }
+
+    vector<float> mean = j["mean"];
+    vector<float> components;
+    for (json::const_iterator it = j["components"].begin (); it != j["components"].end (); ++it)
+    {
+        vector<float> component = *it;
+        if (component.size () != mean.size ())
+        {
+            return false;
+        }
+        components.insert (components.end (), component.begin (), component.end ());
+    }
+
+    mMean = mean;
+    mComponents = components;
+    mNumDims = (int) mean.size ();
+    mNumComponents = mNumDims > 0 ? (int) (components.size () / mNumDims) : 0;
+    mRMSError = j.value ("rmsError", 0.0f);
+    mMaxError = j.value ("maxError", 0.0f);
+
+    return true;
+}
+
+json DescriptorBasis::compactDataset (const json& descriptors, int numComponents)
+{
+    vector<vector<float>> settings;
+    for (json::const_iterator it = descriptors.begin (); it != descriptors.end (); ++it)
+    {
+        settings.push_back ((*it)["settings"]);
+    }
+
+    DescriptorBasis basis;
+    basis.compute (settings, numComponents);
+
+    // coefficients are stored to 4 decimal places, well below the reconstruction error
+    json compact = json::array ();
+    int i = 0;
+    for (json::const_iterator it = descriptors.begin (); it != descriptors.end (); ++it, ++i)
+    {
+        json descriptor = *it;
+        descriptor.erase ("settings");
+
+        vector<float> coeffs = basis.project (settings[i]);
+        vector<double> rounded (coeffs.size ());
+        for (int k = 0; k < coeffs.size (); k++)
+        {
+            rounded[k] = std::round (coeffs[k] * 1.0e4) / 1.0e4;
+        }
+        descriptor["coeffs"] = rounded;
+
+        compact.push_back (descriptor);
+    }
+
+    json result;
+    result["basis"] = basis.toJson ();
+    result["descriptors"] = compact;
+    return result;
+}
+
+}  // namespace Audealize
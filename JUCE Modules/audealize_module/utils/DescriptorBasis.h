@@ -0,0 +1,185 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef DescriptorBasis_h
+#define DescriptorBasis_h
+
+using std::vector;
+using json = nlohmann::json;
+
+namespace Audealize
+{
+/// A reduced basis for descriptor settings, computed offline by principal component analysis over a descriptor set
+/// and stored with it.
+///
+/// Descriptors are stored as a handful of coefficients instead of one value per parameter. Similarity queries, blends
+/// and nearest neighbour searches run on the coefficients; the full settings are only reconstructed when a descriptor
+/// is applied. The basis is computed over curves normalized the way settingsFromMap normalizes them, since that's all
+/// the processor ever uses.
+class DescriptorBasis
+{
+public:
+    DescriptorBasis () : mNumDims (0), mNumComponents (0), mRMSError (0.0f), mMaxError (0.0f)
+    {
+    }
+
+    /**
+     *  Returns true if no basis has been computed or loaded, in which case settings are used as they are
+     */
+    bool isEmpty () const
+    {
+        return mNumComponents == 0;
+    }
+
+    /**
+     *  Returns the length of the full settings vectors
+     */
+    int getNumDimensions () const
+    {
+        return mNumDims;
+    }
+
+    /**
+     *  Returns the number of coefficients per descriptor
+     */
+    int getNumComponents () const
+    {
+        return mNumComponents;
+    }
+
+    /**
+     *  Returns the RMS error of the reconstructed (normalized) settings over the descriptor set the basis was
+     *  computed from
+     */
+    float getRMSError () const
+    {
+        return mRMSError;
+    }
+
+    /**
+     *  Returns the largest error of any reconstructed (normalized) setting over the descriptor set the basis was
+     *  computed from
+     */
+    float getMaxError () const
+    {
+        return mMaxError;
+    }
+
+    /**
+     *  Computes the basis from a set of settings vectors
+     *
+     *  @param settings      The settings of each descriptor, as passed to settingsFromMap
+     *  @param numComponents Number of principal components to keep
+     */
+    void compute (const vector<vector<float>>& settings, int numComponents);
+
+    /**
+     *  Computes the coefficients of a settings vector. The vector is normalized first
+     *
+     *  @param settings getNumDimensions () values
+     *  @param coeffs   Receives getNumComponents () coefficients
+     */
+    void project (const float* settings, float* coeffs) const;
+
+    /**
+     *  Computes the normalized settings represented by a set of coefficients
+     *
+     *  @param coeffs   getNumComponents () coefficients
+     *  @param settings Receives getNumDimensions () values
+     */
+    void reconstruct (const float* coeffs, float* settings) const;
+
+    /**
+     *  Projects a vector onto the basis directions, without normalizing it or removing the mean
+     *
+     *  @param v      getNumDimensions () values
+     *  @param coeffs Receives getNumComponents () values
+     */
+    void projectDirection (const float* v, float* coeffs) const;
+
+    /**
+     *  Returns the mean of the normalized settings the basis was computed from
+     */
+    const vector<float>& getMean () const
+    {
+        return mMean;
+    }
+
+    vector<float> project (const vector<float>& settings) const
+    {
+        vector<float> coeffs (mNumComponents);
+        project (settings.data (), coeffs.data ());
+        return coeffs;
+    }
+
+    vector<float> reconstruct (const vector<float>& coeffs) const
+    {
+        vector<float> settings (mNumDims);
+        reconstruct (coeffs.data (), settings.data ());
+        return settings;
+    }
+
+    /**
+     *  Normalizes a settings vector to [0, 1], as AudealizeAudioProcessor::normalize does, leaving flat vectors at 0
+     */
+    static void normalize (vector<float>& settings);
+
+    /**
+     *  Writes the basis to an nlohmann::json object
+     */
+    json toJson () const;
+
+    /**
+     *  Reads a basis written by toJson
+     *
+     *  @return false if the json doesn't hold a valid basis
+     */
+    bool fromJson (const json& j);
+
+    /**
+     *  Converts a descriptor set (an array of descriptors with "settings") into the compact form: an object holding
+     *  the "basis" and the "descriptors", which have "coeffs" in place of "settings"
+     *
+     *  @param descriptors   The descriptor set
+     *  @param numComponents Number of coefficients per descriptor
+     */
+    static json compactDataset (const json& descriptors, int numComponents);
+
+    /**
+     *  Returns the memory allocated for the mean and the components, in bytes
+     */
+    size_t getSizeInBytes () const
+    {
+        return MemoryUsage::sizeOf (mMean) + MemoryUsage::sizeOf (mComponents);
+    }
+
+private:
+    int mNumDims, mNumComponents;
+    vector<float> mMean;        // mean normalized settings
+    vector<float> mComponents;  // [component][dimension], orthonormal rows
+    float mRMSError, mMaxError;
+};
+
+}  // namespace Audealize
+
+#endif /* DescriptorBasis_h */
@@ -0,0 +1,399 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef DescriptorInterpolator_h
+#define DescriptorInterpolator_h
+
+using std::vector;
+
+namespace Audealize
+{
+/**
+ *  Inserts a candidate into a list of the k nearest found so far, sorted closest first, if it's closer than the
+ *  furthest of them
+ *
+ *  @param idx       index of the candidate
+ *  @param dist      distance of the candidate
+ *  @param k         maximum length of the list
+ *  @param indices   indices in the list
+ *  @param distances distances in the list
+ *  @param found     current length of the list. Updated on return
+ */
+static inline void insertNearest (int idx, float dist, int k, int* indices, float* distances, int& found)
+{
+    if (found == k && dist >= distances[k - 1])
+    {
+        return;
+    }
+
+    int i = found < k ? found++ : k - 1;
+    while (i > 0 && distances[i - 1] > dist)
+    {
+        indices[i] = indices[i - 1];
+        distances[i] = distances[i - 1];
+        i--;
+    }
+    indices[i] = idx;
+    distances[i] = dist;
+}
+
+/// Finds the descriptors nearest to a point on the map and blends their settings, so that dragging across the map
+/// moves smoothly between settings instead of jumping from one descriptor to the next.
+///
+/// The descriptor positions are bucketed into a uniform grid, so a query only looks at the cells around the point.
+/// Settings are blended with modified Shepard weights: the (k+1)th nearest descriptor sets the radius at which
+/// weights fall to zero, so a descriptor fades out smoothly as it leaves the set of k nearest.
+class DescriptorInterpolator
+{
+public:
+    static const int maxNeighbours = 16;
+
+    DescriptorInterpolator () : mNumNeighbours (4), mNumCols (0), mNumRows (0)
+    {
+    }
+
+    /**
+     *  Sets the number of descriptors blended by a query
+     *
+     *  @param k Number of neighbours, between 1 and maxNeighbours
+     */
+    void setNumNeighbours (int k)
+    {
+        mNumNeighbours = jlimit (1, maxNeighbours, k);
+    }
+
+    /**
+     *  Rebuilds the spatial index. Must be called whenever the descriptors or their positions change
+     *
+     *  @param positions Position of each descriptor, in the same units queries will use
+     */
+    void setPositions (const vector<Point<float>>& positions)
+    {
+        mPositions = positions;
+        mCellStart.clear ();
+        mCellItems.clear ();
+        mNumCols = mNumRows = 0;
+
+        const int n = (int) mPositions.size ();
+        if (n == 0)
+        {
+            return;
+        }
+
+        mBounds = Rectangle<float>::findAreaContainingPoints (mPositions.data (), n);
+
+        // about two descriptors per cell
+        const int numCells = jmax (1, n / 2);
+        const float aspect = jmax (1.0f, mBounds.getWidth ()) / jmax (1.0f, mBounds.getHeight ());
+        mNumCols = jmax (1, roundToInt (std::sqrt (numCells * aspect)));
+        mNumRows = jmax (1, numCells / mNumCols);
+        mCellWidth = jmax (1.0e-6f, mBounds.getWidth () / mNumCols);
+        mCellHeight = jmax (1.0e-6f, mBounds.getHeight () / mNumRows);
+
+        // counting sort of the descriptors into cells
+        vector<int> cells (n);
+        mCellStart.assign (mNumCols * mNumRows + 1, 0);
+        for (int i = 0; i < n; i++)
+        {
+            cells[i] = getCellIndex (getColumn (mPositions[i].getX ()), getRow (mPositions[i].getY ()));
+            mCellStart[cells[i] + 1]++;
+        }
+        for (int c = 0; c < mNumCols * mNumRows; c++)
+        {
+            mCellStart[c + 1] += mCellStart[c];
+        }
+
+        vector<int> fill (mCellStart.begin (), mCellStart.end () - 1);
+        mCellItems.resize (n);
+        for (int i = 0; i < n; i++)
+        {
+            mCellItems[fill[cells[i]]++] = i;
+        }
+    }
+
+    /**
+     *  Finds the k descriptors closest to a point
+     *
+     *  @param point     The point to search around
+     *  @param k         Number of descriptors to find, at most maxNeighbours + 1
+     *  @param indices   Receives the indices of the descriptors found, closest first
+     *  @param distances Receives their distances from point
+     *
+     *  @return the number of descriptors found (less than k if there aren't k descriptors)
+     */
+    int findNearest (Point<float> point, int k, int* indices, float* distances) const
+    {
+        jassert (k <= maxNeighbours + 1);
+
+        if (mNumCols == 0)
+        {
+            return 0;
+        }
+
+        const int col = getColumn (point.getX ());
+        const int row = getRow (point.getY ());
+        const float cellSize = jmin (mCellWidth, mCellHeight);
+        const int maxRing = jmax (mNumCols, mNumRows);
+        int found = 0;
+
+        for (int ring = 0; ring <= maxRing; ring++)
+        {
+            for (int r = row - ring; r <= row + ring; r++)
+            {
+                if (r < 0 || r >= mNumRows)
+                    continue;
+
+                // only the border of the ring, the inside has already been searched
+                const int step = (r == row - ring || r == row + ring) ? 1 : jmax (1, 2 * ring);
+                for (int c = col - ring; c <= col + ring; c += step)
+                {
+                    if (c < 0 || c >= mNumCols)
+                        continue;
+
+                    const int cell = getCellIndex (c, r);
+                    for (int j = mCellStart[cell]; j < mCellStart[cell + 1]; j++)
+                    {
+                        const int idx = mCellItems[j];
+                        insertNearest (idx, point.getDistanceFrom (mPositions[idx]), k, indices, distances, found);
+                    }
+                }
+            }
+
+            // nothing in the next ring can be closer than ring * cellSize
+            if (found == k && distances[k - 1] <= ring * cellSize)
+            {
+                break;
+            }
+        }
+
+        return found;
+    }
+
+    /**
+     *  Blends the settings of the descriptors nearest to a point
+     *
+     *  @param point    The point to blend around
+     *  @param settings Settings of each descriptor, in the same order as the positions
+     *  @param result   Receives the blended settings
+     *
+     *  @return the index of the nearest descriptor, or -1 if there are none
+     */
+    int blend (Point<float> point, const vector<vector<float>>& settings, vector<float>& result) const
+    {
+        jassert (settings.size () == mPositions.size ());
+
+        int indices[maxNeighbours + 1];
+        float distances[maxNeighbours + 1];
+        const int found = findNearest (point, mNumNeighbours + 1, indices, distances);
+
+        if (found == 0)
+        {
+            return -1;
+        }
+
+        result = settings[indices[0]];
+
+        // on top of a descriptor, or nothing to blend with
+        if (found == 1 || distances[0] < 1.0e-3f)
+        {
+            return indices[0];
+        }
+
+        // the furthest neighbour found only marks where the weights reach zero
+        const int numBlended = found - 1;
+        const float cutoff = distances[numBlended];
+
+        float weights[maxNeighbours];
+        float total = 0.0f;
+        for (int i = 0; i < numBlended; i++)
+        {
+            const float w = (cutoff - distances[i]) / (cutoff * distances[i]);
+            weights[i] = w * w;
+            total += weights[i];
+        }
+
+        // all neighbours equally far away
+        if (total <= 0.0f)
+        {
+            for (int i = 0; i < numBlended; i++)
+            {
+                weights[i] = 1.0f;
+            }
+            total = (float) numBlended;
+        }
+
+        std::fill (result.begin (), result.end (), 0.0f);
+        for (int i = 0; i < numBlended; i++)
+        {
+            const vector<float>& s = settings[indices[i]];
+            const float w = weights[i] / total;
+            for (int j = 0; j < (int) result.size () && j < (int) s.size (); j++)
+            {
+                result[j] += w * s[j];
+            }
+        }
+
+        return indices[0];
+    }
+
+    /**
+     *  Returns the memory allocated for the positions and the grid, in bytes
+     */
+    size_t getSizeInBytes () const
+    {
+        return MemoryUsage::sizeOf (mPositions) + MemoryUsage::sizeOf (mCellStart) + MemoryUsage::sizeOf (mCellItems);
+    }
+
+private:
+    int mNumNeighbours;
+
+    vector<Point<float>> mPositions;
+    Rectangle<float> mBounds;
+
+    int mNumCols, mNumRows;
+    float mCellWidth, mCellHeight;
+    vector<int> mCellStart;  // index into mCellItems of the first descriptor in each cell, plus an end marker
+    vector<int> mCellItems;  // descriptor indices, grouped by cell
+
+    int getColumn (float x) const
+    {
+        return jlimit (0, mNumCols - 1, (int) ((x - mBounds.getX ()) / mCellWidth));
+    }
+
+    int getRow (float y) const
+    {
+        return jlimit (0, mNumRows - 1, (int) ((y - mBounds.getY ()) / mCellHeight));
+    }
+
+    int getCellIndex (int col, int row) const
+    {
+        return row * mNumCols + col;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (DescriptorInterpolator)
+};
+
+/// Finds the descriptors whose settings are closest to a given settings vector, e.g. to tell which words describe
+/// the current state of the traditional UI.
+///
+/// There are only a few thousand descriptors with up to 40 settings each, so the search is a brute force scan over a
+/// flat array. Each row is padded to a multiple of 8 floats so the distance loop vectorises cleanly.
+class SettingsIndex
+{
+public:
+    SettingsIndex () : mNumItems (0), mNumDims (0), mStride (0)
+    {
+    }
+
+    /**
+     *  Rebuilds the index
+     *
+     *  @param settings One settings vector per descriptor, all the same length
+     */
+    void setSettings (const vector<vector<float>>& settings)
+    {
+        mNumItems = (int) settings.size ();
+        mNumDims = mNumItems > 0 ? (int) settings[0].size () : 0;
+        mStride = (mNumDims + 7) & ~7;
+
+        mData.assign (mNumItems * mStride, 0.0f);
+        for (int i = 0; i < mNumItems; i++)
+        {
+            jassert (settings[i].size () == mNumDims);
+            std::copy (settings[i].begin (), settings[i].end (), mData.begin () + i * mStride);
+        }
+    }
+
+    /**
+     *  Returns the length of the settings vectors in the index
+     */
+    int getNumDimensions () const
+    {
+        return mNumDims;
+    }
+
+    /**
+     *  Finds the k descriptors with the settings closest (in Euclidean distance) to a query
+     *
+     *  @param query     Settings vector of getNumDimensions () floats
+     *  @param k         Number of descriptors to find
+     *  @param indices   Receives the indices of the descriptors found, closest first
+     *  @param distances Receives their distances from the query
+     *
+     *  @return the number of descriptors found
+     */
+    int findNearest (const float* query, int k, int* indices, float* distances) const
+    {
+        float padded[64];
+        jassert (mStride <= 64);
+
+        std::fill (padded, padded + mStride, 0.0f);
+        std::copy (query, query + mNumDims, padded);
+
+        int found = 0;
+        const float* row = mData.data ();
+
+        for (int i = 0; i < mNumItems; i++, row += mStride)
+        {
+            // eight partial sums, one per vector lane
+            float acc[8] = {0.0f};
+            for (int j = 0; j < mStride; j += 8)
+            {
+                for (int l = 0; l < 8; l++)
+                {
+                    const float d = row[j + l] - padded[j + l];
+                    acc[l] += d * d;
+                }
+            }
+            const float sum = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+
+            // distances are only compared, the square root is taken for the results
+            insertNearest (i, sum, k, indices, distances, found);
+        }
+
+        for (int i = 0; i < found; i++)
+        {
+            distances[i] = std::sqrt (distances[i]);
+        }
+
+        return found;
+    }
+
+    /**
+     *  Returns the memory allocated for the settings, in bytes
+     */
+    size_t getSizeInBytes () const
+    {
+        return MemoryUsage::sizeOf (mData);
+    }
+
+private:
+    int mNumItems, mNumDims, mStride;
+    vector<float> mData;  // [item][dimension], rows padded to mStride
+
+    JUCE_DECLARE_NON_COPYABLE (SettingsIndex)
+};
+
+}  // namespace Audealize
+
+#endif /* DescriptorInterpolator_h */
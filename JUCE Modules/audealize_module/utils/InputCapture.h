@@ -0,0 +1,153 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef InputCapture_h
+#define InputCapture_h
+
+namespace Audealize
+{
+/// Keeps the last few seconds of an AudioProcessor's input (mixed to mono) in a ring buffer so it can be copied by
+/// a background thread. Written from the audio thread without locking.
+class InputCapture
+{
+public:
+    InputCapture () : mSize (0), mSampleRate (44100.0)
+    {
+    }
+
+    /**
+     *  Allocates the ring buffer. Call from AudioProcessor::prepareToPlay, while the audio thread isn't running
+     *
+     *  @param sampleRate Sample rate
+     *  @param seconds    Length of audio to keep
+     */
+    void prepare (double sampleRate, double seconds)
+    {
+        const ScopedLock sl (mLock);
+
+        mSampleRate = sampleRate;
+        mSize = jmax (1, (int) (sampleRate * seconds));
+        mBuffer.calloc ((size_t) mSize);
+        mWritePos = 0;
+        mNumWritten = 0;
+    }
+
+    /**
+     *  Appends a block of input to the ring buffer. Called from the audio thread
+     *
+     *  @param buffer      Block of input
+     *  @param numChannels Number of input channels in the buffer
+     */
+    void push (const AudioSampleBuffer& buffer, int numChannels)
+    {
+        if (mSize == 0 || numChannels <= 0)
+        {
+            return;
+        }
+
+        const int numSamples = buffer.getNumSamples ();
+        const float scale = 1.0f / numChannels;
+        int pos = mWritePos.get ();
+
+        for (int i = 0; i < numSamples; i++)
+        {
+            float sample = 0.0f;
+            for (int channel = 0; channel < numChannels; channel++)
+            {
+                sample += buffer.getSample (channel, i);
+            }
+
+            mBuffer[pos] = sample * scale;
+            if (++pos == mSize)
+            {
+                pos = 0;
+            }
+        }
+
+        mWritePos = pos;
+        mNumWritten = jmin (mSize, mNumWritten.get () + numSamples);
+    }
+
+    /**
+     *  Copies the most recently captured input
+     *
+     *  @param dest       Receives the audio in its first channel. Resized to the number of samples copied
+     *  @param numSamples Number of samples wanted
+     *
+     *  @return the number of samples copied, which is less than numSamples if not enough input has been captured
+     */
+    int getRecent (AudioSampleBuffer& dest, int numSamples)
+    {
+        const ScopedLock sl (mLock);
+
+        numSamples = jmin (numSamples, mNumWritten.get ());
+        dest.setSize (1, numSamples);
+
+        int pos = mWritePos.get () - numSamples;
+        if (pos < 0)
+        {
+            pos += mSize;
+        }
+
+        float* out = dest.getWritePointer (0);
+        for (int i = 0; i < numSamples; i++)
+        {
+            out[i] = mBuffer[pos];
+            if (++pos == mSize)
+            {
+                pos = 0;
+            }
+        }
+
+        return numSamples;
+    }
+
+    /**
+     *  Returns the sample rate the capture was prepared with
+     */
+    double getSampleRate ()
+    {
+        return mSampleRate;
+    }
+
+    /**
+     *  Returns the memory allocated for the ring buffer, in bytes
+     */
+    size_t getSizeInBytes () const
+    {
+        return (size_t) mSize * sizeof (float);
+    }
+
+private:
+    HeapBlock<float> mBuffer;
+    int mSize;
+    double mSampleRate;
+    Atomic<int> mWritePos, mNumWritten;
+
+    CriticalSection mLock;  // guards against prepare () while a copy is being taken. never taken by the audio thread
+
+    JUCE_DECLARE_NON_COPYABLE (InputCapture)
+};
+}
+
+#endif /* InputCapture_h */
@@ -0,0 +1,122 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "MemoryUsage.h"
+
+namespace Audealize
+{
+static const size_t heapBlockOverhead = 2 * sizeof (void*);  // typical allocator header of one heap block
+static const size_t mapNodeOverhead = 4 * sizeof (void*);    // links and colour of a std::map node
+
+String MemoryUsage::toString () const
+{
+    return "DSP state " + File::descriptionOfSizeInBytes ((int64) dspState) + ", delay memory " +
+           File::descriptionOfSizeInBytes ((int64) delayMemory) + ", parameter/undo state " +
+           File::descriptionOfSizeInBytes ((int64) parameterState) + ", editor/dataset caches " +
+           File::descriptionOfSizeInBytes ((int64) editorCaches) + ", total " +
+           File::descriptionOfSizeInBytes ((int64) getTotal ());
+}
+
+size_t MemoryUsage::sizeOf (const String& s)
+{
+    // empty strings share a static instance. others are a reference count and allocated size followed by the text
+    return s.isEmpty () ? 0 : heapBlockOverhead + 2 * sizeof (size_t) + s.getNumBytesAsUTF8 () + 1;
+}
+
+#if JUCE_MODULE_AVAILABLE_juce_data_structures
+size_t MemoryUsage::sizeOf (const ValueTree& tree)
+{
+    if (!tree.isValid ())
+    {
+        return 0;
+    }
+
+    // the shared object: type, properties, children, parent and listener lists
+    size_t size = heapBlockOverhead + 8 * sizeof (void*);
+
+    for (int i = 0; i < tree.getNumProperties (); i++)
+    {
+        const var& value = tree.getProperty (tree.getPropertyName (i));
+        size += sizeof (Identifier) + sizeof (var);
+
+        if (value.isString ())
+        {
+            size += sizeOf (value.toString ());
+        }
+        else if (const MemoryBlock* block = value.getBinaryData ())
+        {
+            size += heapBlockOverhead + block->getSize ();
+        }
+    }
+
+    for (int i = 0; i < tree.getNumChildren (); i++)
+    {
+        size += sizeof (void*) + sizeOf (tree.getChild (i));
+    }
+
+    return size;
+}
+#endif
+
+size_t MemoryUsage::sizeOf (const nlohmann::json& j)
+{
+    typedef nlohmann::json::string_t string_t;
+
+    // values are stored inline in their parent; strings, arrays and objects own a heap block
+    size_t size = 0;
+
+    if (j.is_string ())
+    {
+        const string_t& str = *j.get_ptr<const string_t*> ();
+        size += heapBlockOverhead + sizeof (string_t);
+        if (str.capacity () >= sizeof (string_t))
+        {
+            size += heapBlockOverhead + str.capacity () + 1;
+        }
+    }
+    else if (j.is_array ())
+    {
+        size += heapBlockOverhead + sizeof (nlohmann::json::array_t) + j.size () * sizeof (nlohmann::json);
+        for (auto it = j.begin (); it != j.end (); ++it)
+        {
+            size += sizeOf (*it);
+        }
+    }
+    else if (j.is_object ())
+    {
+        size += heapBlockOverhead + sizeof (nlohmann::json::object_t);
+        for (auto it = j.begin (); it != j.end (); ++it)
+        {
+            const std::string& key = it.key ();
+            size += heapBlockOverhead + mapNodeOverhead + sizeof (string_t) + sizeof (nlohmann::json);
+            if (key.capacity () >= sizeof (string_t))
+            {
+                size += heapBlockOverhead + key.capacity () + 1;
+            }
+            size += sizeOf (it.value ());
+        }
+    }
+
+    return size;
+}
+}
@@ -0,0 +1,112 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef MemoryUsage_h
+#define MemoryUsage_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// An estimate of the memory used by an Audealize processor (and its editor), split into categories, in bytes.
+///
+/// The estimates count the heap blocks owned by each object, which is where nearly all of the memory is, plus
+/// allocator bookkeeping where it is large compared to the data (e.g. the nodes of the descriptor dictionaries). They
+/// don't count the size of the processor and editor objects themselves, or memory owned by JUCE or the host.
+struct MemoryUsage
+{
+    /// Something that adds to the memory usage of a processor without being part of it, e.g. an open editor
+    class Reporter
+    {
+    public:
+        virtual ~Reporter ()
+        {
+        }
+
+        /**
+         *  Adds the memory owned by this object to a MemoryUsage
+         */
+        virtual void addMemoryUsage (MemoryUsage& usage) = 0;
+    };
+
+    size_t dspState = 0;        // filter coefficients and state, smoothing and analysis buffers
+    size_t delayMemory = 0;     // delay lines and audio history buffers
+    size_t parameterState = 0;  // the parameter ValueTree and the undo history
+    size_t editorCaches = 0;    // descriptor datasets, map layout and preview renders held by an open editor
+
+    /**
+     *  Returns the sum of all categories
+     */
+    size_t getTotal () const
+    {
+        return dspState + delayMemory + parameterState + editorCaches;
+    }
+
+    MemoryUsage& operator+= (const MemoryUsage& other)
+    {
+        dspState += other.dspState;
+        delayMemory += other.delayMemory;
+        parameterState += other.parameterState;
+        editorCaches += other.editorCaches;
+        return *this;
+    }
+
+    /**
+     *  Returns a one line, human readable description of each category and the total
+     */
+    String toString () const;
+
+    /**
+     *  Returns the memory allocated by a vector. Doesn't include anything owned by its elements
+     */
+    template <typename T>
+    static size_t sizeOf (const vector<T>& v)
+    {
+        return v.capacity () * sizeof (T);
+    }
+
+    static size_t sizeOf (const vector<bool>& v)
+    {
+        return (v.capacity () + 7) / 8;
+    }
+
+    /**
+     *  Returns the memory allocated by a String
+     */
+    static size_t sizeOf (const String& s);
+
+#if JUCE_MODULE_AVAILABLE_juce_data_structures
+    /**
+     *  Returns the memory allocated by a ValueTree, its properties and all of its children
+     */
+    static size_t sizeOf (const ValueTree& tree);
+#endif
+
+    /**
+     *  Returns the memory allocated by a json value and everything it contains
+     */
+    static size_t sizeOf (const nlohmann::json& j);
+};
+}
+
+#endif /* MemoryUsage_h */
@@ -0,0 +1,166 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "QualityGovernor.h"
+
+namespace Audealize
+{
+static const float overloadThreshold = 0.5f;  // fraction of the deadline above which the tier is lowered
+static const float recoveryThreshold = 0.2f;  // and below which it is raised again
+
+QualityGovernor::Client::Client () : mStartTicks (0), mBusySeconds (0.0), mAudioSeconds (0.0)
+{
+    mGovernor->addClient (this);
+    mTier = mGovernor->getQualityTier ();
+}
+
+QualityGovernor::Client::~Client ()
+{
+    mGovernor->removeClient (this);
+}
+
+void QualityGovernor::Client::endBlock (int numSamples, double sampleRate)
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+    {
+        return;
+    }
+
+    mBusySeconds += Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks () - mStartTicks);
+    mAudioSeconds += numSamples / sampleRate;
+
+    // average over a window about as long as the governor's poll interval, so a single block that was preempted
+    // only counts for its share of the window rather than holding the tier down
+    if (mAudioSeconds * 1000.0 >= loadWindowMs)
+    {
+        mLoad = (float) (mBusySeconds / mAudioSeconds);
+        mBusySeconds = mAudioSeconds = 0.0;
+    }
+
+    mThreadId = Thread::getCurrentThreadId ();
+    mLastBlockTime = Time::getMillisecondCounter ();
+}
+
+QualityGovernor::QualityGovernor ()
+    : mTier (kTierFull),
+      mThreadLoad (0.0f),
+      mPollsOverloaded (0),
+      mPollsRecovered (0),
+      mRaiseBackoff (1),
+      mPollsSinceRaised (0)
+{
+    startTimer (pollIntervalMs);
+}
+
+QualityGovernor::~QualityGovernor ()
+{
+    stopTimer ();
+}
+
+void QualityGovernor::addClient (Client* client)
+{
+    const ScopedLock sl (mLock);
+    mClients.addIfNotAlreadyThere (client);
+}
+
+void QualityGovernor::removeClient (Client* client)
+{
+    const ScopedLock sl (mLock);
+    mClients.removeFirstMatchingValue (client);
+}
+
+void QualityGovernor::timerCallback ()
+{
+    const ScopedLock sl (mLock);
+
+    // instances on the same callback thread share its deadline, so their loads add up. Threads running in
+    // parallel each have their own deadline, so only the busiest one counts
+    const uint32 now = Time::getMillisecondCounter ();
+    std::map<Thread::ThreadID, float> threadLoads;
+    for (int i = 0; i < mClients.size (); i++)
+    {
+        if (now - mClients[i]->mLastBlockTime.get () < (uint32) staleClientMs)
+        {
+            threadLoads[mClients[i]->mThreadId.get ()] += mClients[i]->getLoad ();
+        }
+    }
+
+    float total = 0.0f;
+    for (std::map<Thread::ThreadID, float>::iterator it = threadLoads.begin (); it != threadLoads.end (); ++it)
+    {
+        total = jmax (total, it->second);
+    }
+    mThreadLoad = total;
+
+    mPollsSinceRaised++;
+
+    if (total > overloadThreshold)
+    {
+        mPollsRecovered = 0;
+
+        if (++mPollsOverloaded >= pollsBeforeLowering && mTier < kNumTiers - 1)
+        {
+            // the tier we raised to recently couldn't be sustained: wait longer before trying it again
+            if (mPollsSinceRaised < pollsBeforeRaising * mRaiseBackoff)
+            {
+                mRaiseBackoff = jmin (mRaiseBackoff * 2, maxRaiseBackoff);
+            }
+
+            setTier (mTier + 1);
+        }
+    }
+    else if (total < recoveryThreshold)
+    {
+        mPollsOverloaded = 0;
+
+        if (++mPollsRecovered >= pollsBeforeRaising * mRaiseBackoff && mTier > kTierFull)
+        {
+            setTier (mTier - 1);
+            mPollsSinceRaised = 0;
+        }
+    }
+    else
+    {
+        mPollsOverloaded = 0;
+        mPollsRecovered = 0;
+    }
+
+    // a raised tier that has held up for a while earns back the short wait
+    if (mPollsSinceRaised > pollsBeforeRaising * maxRaiseBackoff)
+    {
+        mRaiseBackoff = 1;
+    }
+}
+
+void QualityGovernor::setTier (int tier)
+{
+    mTier = tier;
+    mPollsOverloaded = 0;
+    mPollsRecovered = 0;
+
+    for (int i = 0; i < mClients.size (); i++)
+    {
+        mClients[i]->mTier = tier;
+    }
+}
+}
@@ -0,0 +1,156 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef QualityGovernor_h
+#define QualityGovernor_h
+
+namespace Audealize
+{
+/// Watches how much of the audio callback deadline every Audealize processor in the process is using, and lowers
+/// their quality tier when a callback thread gets close to it, so a session that is running out of headroom loses a
+/// little precision instead of dropping out. Tiers are raised again once the load has stayed low for a while.
+///
+/// Hosts run tracks on several threads in parallel, and only the instances processed on the same thread share its
+/// deadline. Clients are grouped by the thread that calls them, and the busiest thread decides the tier.
+///
+/// There is one governor per process, shared by all of its clients through a SharedResourcePointer. It polls the
+/// clients from a message thread timer, so it does nothing in hosts/tools without a message loop: every client
+/// then stays at kTierFull.
+class QualityGovernor : private Timer
+{
+public:
+    enum Tier
+    {
+        kTierFull = 0,  // no shortcuts
+        kTierReduced,   // inaudible or nearly inaudible shortcuts
+        kTierMinimal,   // cheapest processing that still sounds like the effect
+        kNumTiers
+    };
+
+    /// A processor whose load the governor measures and whose quality tier it sets. Lives as long as the processor;
+    /// beginBlock ()/endBlock () are called around each processBlock on the audio thread.
+    class Client
+    {
+    public:
+        Client ();
+        ~Client ();
+
+        /**
+         *  Marks the start of a processBlock. Called from the audio thread
+         */
+        void beginBlock ()
+        {
+            mStartTicks = Time::getHighResolutionTicks ();
+        }
+
+        /**
+         *  Marks the end of a processBlock and updates the measured load. Called from the audio thread
+         *
+         *  @param numSamples Number of samples in the block
+         *  @param sampleRate Sample rate
+         */
+        void endBlock (int numSamples, double sampleRate);
+
+        /**
+         *  Returns the tier the client's processing should currently run at. @see QualityGovernor::Tier
+         */
+        int getQualityTier () const
+        {
+            return mTier.get ();
+        }
+
+        /**
+         *  Returns the fraction of the callback deadline this client used over its last measurement window
+         */
+        float getLoad () const
+        {
+            return mLoad.get ();
+        }
+
+    private:
+        friend class QualityGovernor;
+
+        int64 mStartTicks;
+        double mBusySeconds, mAudioSeconds;  // processing time and audio time of the current window. audio thread only
+        Atomic<float> mLoad;
+        Atomic<uint32> mLastBlockTime;  // Time::getMillisecondCounter () at the end of the last block
+        Atomic<Thread::ThreadID> mThreadId;  // thread that processed the last block
+        Atomic<int> mTier;
+
+        SharedResourcePointer<QualityGovernor> mGovernor;
+
+        JUCE_DECLARE_NON_COPYABLE (Client)
+    };
+
+    QualityGovernor ();
+    ~QualityGovernor ();
+
+    /**
+     *  Returns the tier every client is currently running at
+     */
+    int getQualityTier () const
+    {
+        return mTier;
+    }
+
+    /**
+     *  Returns the combined load of the clients on the busiest callback thread at the last poll, as a fraction of the
+     *  callback deadline
+     */
+    float getThreadLoad () const
+    {
+        return mThreadLoad;
+    }
+
+private:
+    static const int pollIntervalMs = 100;
+    static const int pollsBeforeLowering = 2;     // load must stay high for this long before the tier is lowered
+    static const int pollsBeforeRaising = 30;     // and low for this long before it is raised again
+    static const int maxRaiseBackoff = 8;         // longest wait before raising, as a multiple of pollsBeforeRaising
+    static const int staleClientMs = 1000;        // clients that haven't processed a block for this long don't count
+    static const int loadWindowMs = 100;          // audio time each client's load is averaged over
+
+    Array<Client*> mClients;
+    CriticalSection mLock;  // guards mClients. never taken by the audio thread
+
+    int mTier;
+    float mThreadLoad;
+    int mPollsOverloaded, mPollsRecovered;
+    int mRaiseBackoff;      // doubled each time a raised tier overloads again soon after
+    int mPollsSinceRaised;
+
+    void addClient (Client* client);
+    void removeClient (Client* client);
+
+    void timerCallback () override;
+
+    /**
+     *  Moves every client to a new tier
+     */
+    void setTier (int tier);
+
+    JUCE_DECLARE_NON_COPYABLE (QualityGovernor)
+};
+}
+
+#endif /* QualityGovernor_h */
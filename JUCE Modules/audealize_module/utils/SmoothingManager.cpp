@@ -0,0 +1,142 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "SmoothingManager.h"
+
+namespace Audealize
+{
+SmoothingManager::SmoothingManager (int numParams, float initialValue)
+    : mParams (numParams),
+      mNumSteps (0),
+      mTargets (numParams),
+      mTargetChanged (numParams),
+      mSampleRate (0.0),
+      mWindowUpdates (0),
+      mWindowSamples (0)
+{
+    for (int i = 0; i < numParams; i++)
+    {
+        Param& p = mParams[i];
+        p.current = p.target = initialValue;
+        p.step = 0.0f;
+        p.stepsRemaining = 0;
+        p.active = false;
+
+        mTargets[i] = initialValue;
+    }
+
+    mActive.reserve (numParams);
+}
+
+void SmoothingManager::reset (double sampleRate, double rampSeconds)
+{
+    mSampleRate = sampleRate;
+    mNumSteps = (int) std::floor (rampSeconds * sampleRate);
+}
+
+void SmoothingManager::setTargetValue (int index, float target)
+{
+    if (mTargets[index].get () == target)
+    {
+        return;
+    }
+
+    // the flags are set after the target, so process () never picks up a flag without its target
+    mTargets[index] = target;
+    mTargetChanged[index] = 1;
+    mTargetsChanged = 1;
+}
+
+void SmoothingManager::setCurrentValue (int index, float current)
+{
+    Param& p = mParams[index];
+    p.current = current;
+
+    if (p.active)
+    {
+        // restarts from the new value
+        startRamp (index, p.target);
+    }
+    else if (current != mTargets[index].get ())
+    {
+        startRamp (index, mTargets[index].get ());
+    }
+}
+
+void SmoothingManager::collectTargets ()
+{
+    for (int i = 0; i < mParams.size (); i++)
+    {
+        if (mTargetChanged[i].compareAndSetBool (0, 1))
+        {
+            const float target = mTargets[i].get ();
+            const Param& p = mParams[i];
+
+            if (p.active ? target != p.target : target != p.current)
+            {
+                startRamp (i, target);
+            }
+        }
+    }
+}
+
+void SmoothingManager::startRamp (int index, float target)
+{
+    Param& p = mParams[index];
+    p.target = target;
+
+    // process () takes the first step, so a ramp of 0 or 1 steps lands on the target in the next block
+    p.stepsRemaining = jmax (1, mNumSteps);
+    p.step = (target - p.current) / p.stepsRemaining;
+
+    if (!p.active)
+    {
+        p.active = true;
+        mActive.push_back (index);
+    }
+}
+
+void SmoothingManager::countUpdates (int numApplied, int numSamples)
+{
+    if (numApplied > 0)
+    {
+        mNumUpdates += numApplied;
+    }
+
+    if (mSampleRate <= 0.0)
+    {
+        return;
+    }
+
+    mWindowUpdates += numApplied;
+    mWindowSamples += numSamples;
+
+    if (mWindowSamples >= mSampleRate)
+    {
+        mUpdatesPerSecond = (float) (mWindowUpdates * mSampleRate / mWindowSamples);
+        mWindowUpdates = 0;
+        mWindowSamples = 0;
+    }
+}
+
+}  // namespace Audealize
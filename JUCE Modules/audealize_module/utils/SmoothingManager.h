@@ -0,0 +1,231 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SmoothingManager_h
+#define SmoothingManager_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// Ramps a fixed set of effect parameters towards their targets, and keeps track of which of them are still moving,
+/// so that processBlock only updates (and redesigns the filters for) the parameters that have changed. A ramp is
+/// retired on the step that lands exactly on its target, so a processor whose parameters are idle does no
+/// coefficient work at all.
+///
+/// Ramps advance one step per block, as the LinearSmoothedValues this replaced did. A block that is processed in
+/// sub-blocks only advances them on its first, so splitting it doesn't make the ramps finish sooner.
+///
+/// Targets can be set from any thread. Everything else is for the audio thread, or for before processing starts.
+class SmoothingManager
+{
+public:
+    /**
+     *  @param numParams    Number of parameters
+     *  @param initialValue Value every parameter starts at, which the effect is assumed to be running at already
+     */
+    SmoothingManager (int numParams, float initialValue = 0.0f);
+
+    /**
+     *  Sets the ramp length. Ramps in progress finish at their old length
+     *
+     *  @param sampleRate  Sample rate
+     *  @param rampSeconds Ramp length. The ramp takes rampSeconds * sampleRate steps (blocks)
+     */
+    void reset (double sampleRate, double rampSeconds);
+
+    /**
+     *  Sets the value a parameter is ramped to. A ramp already in progress restarts from where it is. Can be called
+     *  from any thread
+     *
+     *  @param index  Parameter index
+     *  @param target The new target
+     */
+    void setTargetValue (int index, float target);
+
+    /**
+     *  Returns a parameter's target
+     */
+    float getTargetValue (int index) const
+    {
+        return mTargets[index].get ();
+    }
+
+    /**
+     *  Tells the manager which value the effect is running a parameter at, after it was changed from outside, e.g.
+     *  by an EngineSwitcher. If it differs from the target, a ramp to the target is started from it
+     *
+     *  @param index   Parameter index
+     *  @param current The value the effect is running at
+     */
+    void setCurrentValue (int index, float current);
+
+    /**
+     *  Has the next process () call apply every parameter again, including settled ones. For changes that affect
+     *  how all parameters are applied, like the EQ amount. Can be called from any thread
+     */
+    void reapplyAll ()
+    {
+        mReapply = 1;
+    }
+
+    /**
+     *  Returns true if no parameter is ramping and no change is waiting for process ()
+     */
+    bool isSettled () const
+    {
+        return mActive.empty () && mTargetsChanged.get () == 0 && mReapply.get () == 0;
+    }
+
+    /**
+     *  Advances every ramping parameter by one step and calls apply for each parameter whose value changed, or for
+     *  every parameter after reapplyAll (). Does nothing else when all parameters are settled
+     *
+     *  @param numSamples Number of samples in the block, for getUpdatesPerSecond ()
+     *  @param apply      Callable as apply (int index, float value), that sets a parameter of the effect
+     *  @param advance    False for the later sub-blocks of a block that is processed in parts, which only count
+     *                    their samples
+     *
+     *  @return the number of parameters that were applied
+     */
+    template <typename ApplyFunction>
+    int process (int numSamples, ApplyFunction apply, bool advance = true)
+    {
+        if (!advance)
+        {
+            countUpdates (0, numSamples);
+            return 0;
+        }
+
+        if (mTargetsChanged.compareAndSetBool (0, 1))
+        {
+            collectTargets ();
+        }
+
+        const bool reapply = mReapply.compareAndSetBool (0, 1);
+        int numApplied = 0;
+
+        if (reapply)
+        {
+            for (int i = 0; i < mParams.size (); i++)
+            {
+                if (!mParams[i].active)
+                {
+                    apply (i, mParams[i].current);
+                    numApplied++;
+                }
+            }
+        }
+
+        for (int k = 0; k < mActive.size ();)
+        {
+            const int i = mActive[k];
+            Param& p = mParams[i];
+
+            if (--p.stepsRemaining <= 0)
+            {
+                p.current = p.target;
+                p.active = false;
+                mActive[k] = mActive.back ();
+                mActive.pop_back ();
+            }
+            else
+            {
+                p.current += p.step;
+                k++;
+            }
+
+            apply (i, p.current);
+            numApplied++;
+        }
+
+        countUpdates (numApplied, numSamples);
+        return numApplied;
+    }
+
+    /**
+     *  Returns the number of parameter updates per second of audio, measured over about the last second. Each update
+     *  usually means a filter redesign. Can be called from any thread
+     */
+    float getUpdatesPerSecond () const
+    {
+        return mUpdatesPerSecond.get ();
+    }
+
+    /**
+     *  Returns the total number of parameter updates since the manager was created. Can be called from any thread
+     */
+    int64 getNumUpdates () const
+    {
+        return mNumUpdates.get ();
+    }
+
+    size_t getSizeInBytes () const
+    {
+        return MemoryUsage::sizeOf (mParams) + MemoryUsage::sizeOf (mActive) + MemoryUsage::sizeOf (mTargets) +
+               MemoryUsage::sizeOf (mTargetChanged);
+    }
+
+private:
+    /// Ramp state of one parameter. Audio thread only
+    struct Param
+    {
+        float current;
+        float target;  // of the ramp in progress
+        float step;
+        int stepsRemaining;
+        bool active;
+    };
+
+    vector<Param> mParams;
+    vector<int> mActive;  // indices of the parameters that are ramping. never reallocated after construction
+    int mNumSteps;
+
+    vector<Atomic<float>> mTargets;      // latest target of each parameter
+    vector<Atomic<int>> mTargetChanged;  // set when mTargets[i] changes, cleared when process () picks it up
+    Atomic<int> mTargetsChanged;         // set when any mTargetChanged is
+    Atomic<int> mReapply;
+
+    double mSampleRate;
+    int mWindowUpdates, mWindowSamples;  // counted towards the next getUpdatesPerSecond () value
+    Atomic<float> mUpdatesPerSecond;
+    Atomic<int64> mNumUpdates;
+
+    /**
+     *  Starts ramps towards the targets that were changed since the last call
+     */
+    void collectTargets ();
+
+    /**
+     *  Starts a ramp from a parameter's current value to a target
+     */
+    void startRamp (int index, float target);
+
+    void countUpdates (int numApplied, int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE (SmoothingManager)
+};
+
+}  // namespace Audealize
+
+#endif /* SmoothingManager_h */
@@ -0,0 +1,579 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "WorkerPool.h"
+
+namespace Audealize
+{
+//==============================================================================
+WorkerPool::CancellationToken::CancellationToken () : mState (std::make_shared<State> ())
+{
+}
+
+void WorkerPool::CancellationToken::cancel ()
+{
+    mState->cancelled = 1;
+}
+
+bool WorkerPool::CancellationToken::isCancelled () const
+{
+    return mState->cancelled.get () != 0;
+}
+
+int WorkerPool::CancellationToken::getNumPending () const
+{
+    return mState->numPending.get ();
+}
+
+//==============================================================================
+WorkerPool::Policy WorkerPool::Policy::getDefault ()
+{
+    const int numCpus = SystemStats::getNumCpus ();
+
+    Policy policy;
+    policy.numReservedCores = numCpus > 2 ? jmax (1, numCpus / 4) : 0;
+    policy.numThreads = jlimit (1, 8, numCpus - policy.numReservedCores - 1);  // and a core for the message thread
+    policy.pinToUnreservedCores = policy.numReservedCores > 0;
+    policy.threadPriority = 3;  // below normal, background work must never compete with the audio thread
+    policy.maxQueuedJobs = 256;
+    return policy;
+}
+
+//==============================================================================
+class WorkerPool::Worker : public Thread
+{
+public:
+    Worker (WorkerPool& pool, int index)
+        : Thread ("Audealize worker " + String (index + 1)), mPool (pool), mIndex (index)
+    {
+    }
+
+    void run () override
+    {
+        while (!threadShouldExit ())
+        {
+            Job job;
+            if (mPool.takeJob (mIndex, job))
+            {
+                mPool.runJob (job, mIndex);
+                continue;
+            }
+
+            mIsIdle = 1;
+            mWakeEvent.wait (mPool.getIdleTimeoutMs (mIndex));
+            mIsIdle = 0;
+        }
+    }
+
+    void wake ()
+    {
+        mWakeEvent.signal ();
+    }
+
+    bool isIdle () const
+    {
+        return mIsIdle.get () != 0;
+    }
+
+    CriticalSection mLock;                    // guards mQueues
+    std::deque<Job> mQueues[kNumPriorities];  // oldest job at the front
+
+private:
+    WorkerPool& mPool;
+    const int mIndex;
+
+    WaitableEvent mWakeEvent;
+    Atomic<int> mIsIdle;
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
+WorkerPool::WorkerPool () : mPolicy (Policy::getDefault ())
+{
+    start ();
+}
+
+WorkerPool::WorkerPool (const Policy& policy) : mPolicy (policy)
+{
+    start ();
+}
+
+WorkerPool::~WorkerPool ()
+{
+    for (int i = 0; i < mWorkers.size (); i++)
+    {
+        mWorkers[i]->signalThreadShouldExit ();
+        mWorkers[i]->wake ();
+    }
+    for (int i = 0; i < mWorkers.size (); i++)
+    {
+        mWorkers[i]->stopThread (4000);
+    }
+
+    // every owner should have waited for its jobs, but let go of anything left so its pending count is right
+    for (int i = 0; i < mWorkers.size (); i++)
+    {
+        for (int p = 0; p < kNumPriorities; p++)
+        {
+            for (Job& job : mWorkers[i]->mQueues[p])
+            {
+                release (job);
+            }
+        }
+    }
+    for (Job& job : mDelayed)
+    {
+        release (job);
+    }
+}
+
+void WorkerPool::start ()
+{
+    const int numCpus = jmin (SystemStats::getNumCpus (), 32);
+
+    uint32 affinityMask = 0;
+    for (int i = mPolicy.numReservedCores; i < numCpus; i++)
+    {
+        affinityMask |= (uint32) 1 << i;
+    }
+
+    for (int i = 0; i < jmax (1, mPolicy.numThreads); i++)
+    {
+        Worker* worker = mWorkers.add (new Worker (*this, i));
+
+        if (mPolicy.pinToUnreservedCores && affinityMask != 0)
+        {
+            worker->setAffinityMask (affinityMask);
+        }
+        worker->startThread (mPolicy.threadPriority);
+    }
+}
+
+bool WorkerPool::submit (const String& name, int priority, const CancellationToken& token, std::function<void ()> job)
+{
+    jassert (isPositiveAndBelow (priority, (int) kNumPriorities));
+
+    // the bound is checked without a lock, so a burst of concurrent submits can overshoot it slightly
+    if (token.isCancelled () || mNumQueued[priority].get () >= mPolicy.maxQueuedJobs)
+    {
+        recordJob (name, 1, 0, 0, 1);
+        return false;
+    }
+
+    Job j;
+    j.name = name;
+    j.priority = priority;
+    j.group = token.mState;
+    j.run = [job] () {
+        job ();
+        return -1;
+    };
+
+    ++token.mState->numPending;
+    recordJob (name, 1, 0, 0, 0);
+    enqueue (j, (++mNextWorker & 0x7fffffff) % mWorkers.size ());
+    return true;
+}
+
+bool WorkerPool::submitRecurring (const String& name, int priority, const CancellationToken& token,
+                                  std::function<int ()> job)
+{
+    jassert (isPositiveAndBelow (priority, (int) kNumPriorities));
+
+    // recurring jobs are long lived and there is at most a few per instance, so they aren't held to the bound
+    if (token.isCancelled ())
+    {
+        recordJob (name, 1, 0, 0, 1);
+        return false;
+    }
+
+    Job j;
+    j.name = name;
+    j.priority = priority;
+    j.group = token.mState;
+    j.run = job;
+
+    ++token.mState->numPending;
+    recordJob (name, 1, 0, 0, 0);
+    enqueue (j, (++mNextWorker & 0x7fffffff) % mWorkers.size ());
+    return true;
+}
+
+bool WorkerPool::waitFor (const CancellationToken& token, int timeoutMs)
+{
+    if (token.isCancelled ())
+    {
+        // drop the group's queued jobs now rather than waiting for a worker to reach them
+        vector<Job> dropped;
+
+        for (int i = 0; i < mWorkers.size (); i++)
+        {
+            const ScopedLock sl (mWorkers[i]->mLock);
+
+            for (int p = 0; p < kNumPriorities; p++)
+            {
+                std::deque<Job>& queue = mWorkers[i]->mQueues[p];
+                for (std::deque<Job>::iterator it = queue.begin (); it != queue.end ();)
+                {
+                    if (it->group == token.mState)
+                    {
+                        dropped.push_back (std::move (*it));
+                        it = queue.erase (it);
+                        --mNumQueued[p];
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+        }
+
+        {
+            const ScopedLock sl (mDelayedLock);
+            for (size_t i = 0; i < mDelayed.size ();)
+            {
+                if (mDelayed[i].group == token.mState)
+                {
+                    dropped.push_back (std::move (mDelayed[i]));
+                    mDelayed.erase (mDelayed.begin () + i);
+                }
+                else
+                {
+                    i++;
+                }
+            }
+            mNumDelayed = (int) mDelayed.size ();
+        }
+
+        for (Job& job : dropped)
+        {
+            recordJob (job.name, 0, 0, 1, 0);
+            release (job);
+        }
+    }
+
+    const uint32 startTime = Time::getMillisecondCounter ();
+    const int workerIdx = getCurrentWorkerIndex ();
+
+    while (token.getNumPending () > 0)
+    {
+        if (timeoutMs >= 0 && (int) (Time::getMillisecondCounter () - startTime) >= timeoutMs)
+        {
+            return false;
+        }
+
+        // a worker waiting on other jobs would otherwise leave its queue to be stolen from, or deadlock if every
+        // worker is waiting
+        Job job;
+        if (workerIdx >= 0 && takeJob (workerIdx, job))
+        {
+            runJob (job, workerIdx);
+            continue;
+        }
+
+        mJobFinished.wait (10);
+    }
+
+    return true;
+}
+
+vector<WorkerPool::JobMetrics> WorkerPool::getMetrics () const
+{
+    const ScopedLock sl (mMetricsLock);
+
+    vector<JobMetrics> metrics;
+    for (std::map<String, JobMetrics>::const_iterator it = mMetrics.begin (); it != mMetrics.end (); ++it)
+    {
+        metrics.push_back (it->second);
+    }
+    return metrics;
+}
+
+String WorkerPool::getMetricsReport () const
+{
+    String report;
+    report << String ("job").paddedRight (' ', 24) << String ("submitted").paddedLeft (' ', 10)
+           << String ("completed").paddedLeft (' ', 10) << String ("cancelled").paddedLeft (' ', 10)
+           << String ("rejected").paddedLeft (' ', 10) << String ("mean wait").paddedLeft (' ', 11)
+           << String ("max wait").paddedLeft (' ', 10) << String ("mean run").paddedLeft (' ', 10)
+           << String ("max run").paddedLeft (' ', 10) << newLine;
+
+    for (const JobMetrics& m : getMetrics ())
+    {
+        const double meanWait = m.numCompleted > 0 ? m.totalWaitMs / m.numCompleted : 0.0;
+        const double meanRun = m.numCompleted > 0 ? m.totalRunMs / m.numCompleted : 0.0;
+
+        report << m.name.paddedRight (' ', 24) << String (m.numSubmitted).paddedLeft (' ', 10)
+               << String (m.numCompleted).paddedLeft (' ', 10) << String (m.numCancelled).paddedLeft (' ', 10)
+               << String (m.numRejected).paddedLeft (' ', 10) << String (meanWait, 3).paddedLeft (' ', 11)
+               << String (m.maxWaitMs, 3).paddedLeft (' ', 10) << String (meanRun, 3).paddedLeft (' ', 10)
+               << String (m.maxRunMs, 3).paddedLeft (' ', 10) << newLine;
+    }
+
+    return report;
+}
+
+void WorkerPool::resetMetrics ()
+{
+    const ScopedLock sl (mMetricsLock);
+    mMetrics.clear ();
+}
+
+void WorkerPool::enqueue (Job& job, int workerIdx)
+{
+    const int priority = job.priority;
+    Worker* worker = mWorkers[workerIdx];
+
+    job.queuedTicks = Time::getHighResolutionTicks ();
+    {
+        const ScopedLock sl (worker->mLock);
+        worker->mQueues[priority].push_back (std::move (job));
+    }
+    ++mNumQueued[priority];
+
+    worker->wake ();
+
+    // if that worker is busy, hand the job to an idle one to steal
+    if (!worker->isIdle ())
+    {
+        for (int i = 1; i < mWorkers.size (); i++)
+        {
+            Worker* other = mWorkers[(workerIdx + i) % mWorkers.size ()];
+            if (other->isIdle ())
+            {
+                other->wake ();
+                break;
+            }
+        }
+    }
+}
+
+bool WorkerPool::takeJob (int workerIdx, Job& job)
+{
+    promoteDueJobs (workerIdx);
+
+    const int numWorkers = mWorkers.size ();
+
+    for (int p = 0; p < kNumPriorities; p++)
+    {
+        if (mNumQueued[p].get () == 0)
+        {
+            continue;
+        }
+
+        // own queue first, newest job (its data is most likely still in cache), then the oldest job of the others
+        for (int i = 0; i < numWorkers; i++)
+        {
+            Worker* worker = mWorkers[(workerIdx + i) % numWorkers];
+            const ScopedLock sl (worker->mLock);
+
+            std::deque<Job>& queue = worker->mQueues[p];
+            if (queue.empty ())
+            {
+                continue;
+            }
+
+            if (i == 0)
+            {
+                job = std::move (queue.back ());
+                queue.pop_back ();
+            }
+            else
+            {
+                job = std::move (queue.front ());
+                queue.pop_front ();
+            }
+
+            --mNumQueued[p];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkerPool::promoteDueJobs (int workerIdx)
+{
+    if (mNumDelayed.get () == 0)
+    {
+        return;
+    }
+
+    const uint32 now = Time::getMillisecondCounter ();
+    if ((int) (mNextDueTime.get () - now) > 0)
+    {
+        return;
+    }
+
+    vector<Job> due;
+    {
+        // another worker is already promoting them
+        const ScopedTryLock stl (mDelayedLock);
+        if (!stl.isLocked ())
+        {
+            return;
+        }
+
+        uint32 nextDue = now + 1000;
+        for (size_t i = 0; i < mDelayed.size ();)
+        {
+            if ((int) (mDelayed[i].dueTime - now) <= 0)
+            {
+                due.push_back (std::move (mDelayed[i]));
+                if (i + 1 < mDelayed.size ())
+                {
+                    mDelayed[i] = std::move (mDelayed.back ());
+                }
+                mDelayed.pop_back ();
+            }
+            else
+            {
+                if ((int) (mDelayed[i].dueTime - nextDue) < 0)
+                {
+                    nextDue = mDelayed[i].dueTime;
+                }
+                i++;
+            }
+        }
+
+        mNextDueTime = nextDue;
+        mNumDelayed = (int) mDelayed.size ();
+    }
+
+    for (Job& job : due)
+    {
+        enqueue (job, workerIdx);
+    }
+}
+
+int WorkerPool::getIdleTimeoutMs (int workerIdx) const
+{
+    // the first worker keeps time for the delayed jobs, unless it is busy
+    if (mNumDelayed.get () == 0 || (workerIdx > 0 && mWorkers[0]->isIdle ()))
+    {
+        return 1000;
+    }
+
+    return jlimit (1, 1000, (int) (mNextDueTime.get () - Time::getMillisecondCounter ()));
+}
+
+void WorkerPool::runJob (Job& job, int workerIdx)
+{
+    CancellationToken::State& group = *job.group;
+
+    if (group.cancelled.get () != 0)
+    {
+        recordJob (job.name, 0, 0, 1, 0);
+        release (job);
+        return;
+    }
+
+    const int64 startTicks = Time::getHighResolutionTicks ();
+    const int nextRunMs = job.run ();
+    const int64 endTicks = Time::getHighResolutionTicks ();
+
+    recordJob (job.name, 0, 1, 0, 0, Time::highResolutionTicksToSeconds (startTicks - job.queuedTicks) * 1000.0,
+               Time::highResolutionTicksToSeconds (endTicks - startTicks) * 1000.0);
+
+    if (nextRunMs < 0 || group.cancelled.get () != 0)
+    {
+        release (job);
+        return;
+    }
+
+    if (nextRunMs == 0)
+    {
+        enqueue (job, workerIdx);
+        return;
+    }
+
+    job.dueTime = Time::getMillisecondCounter () + (uint32) nextRunMs;
+
+    const ScopedLock sl (mDelayedLock);
+
+    const bool isEarliest = mDelayed.empty () || (int) (job.dueTime - mNextDueTime.get ()) < 0;
+    if (isEarliest)
+    {
+        mNextDueTime = job.dueTime;
+    }
+
+    mDelayed.push_back (std::move (job));
+    mNumDelayed = (int) mDelayed.size ();
+
+    // let the worker keeping time know it has to wake up sooner
+    if (isEarliest)
+    {
+        mWorkers[0]->wake ();
+    }
+}
+
+void WorkerPool::release (Job& job)
+{
+    // destroy whatever the job holds before its owner can see that it has gone
+    job.run = nullptr;
+    --job.group->numPending;
+    job.group = nullptr;
+
+    mJobFinished.signal ();
+}
+
+void WorkerPool::recordJob (const String& name, int numSubmitted, int numCompleted, int numCancelled, int numRejected,
+                            double waitMs, double runMs)
+{
+    const ScopedLock sl (mMetricsLock);
+
+    std::map<String, JobMetrics>::iterator it = mMetrics.find (name);
+    if (it == mMetrics.end ())
+    {
+        JobMetrics m = JobMetrics ();
+        m.name = name;
+        it = mMetrics.insert (std::make_pair (name, m)).first;
+    }
+
+    JobMetrics& m = it->second;
+    m.numSubmitted += numSubmitted;
+    m.numCompleted += numCompleted;
+    m.numCancelled += numCancelled;
+    m.numRejected += numRejected;
+    m.totalWaitMs += waitMs;
+    m.maxWaitMs = jmax (m.maxWaitMs, waitMs);
+    m.totalRunMs += runMs;
+    m.maxRunMs = jmax (m.maxRunMs, runMs);
+}
+
+int WorkerPool::getCurrentWorkerIndex () const
+{
+    Thread* current = Thread::getCurrentThread ();
+
+    for (int i = 0; i < mWorkers.size (); i++)
+    {
+        if (mWorkers[i] == current)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+}
@@ -0,0 +1,263 @@
+/*
+ Audealize
+
+ http://music.cs.northwestern.edu
+ http://github.com/interactiveaudiolab/audealize-plugin
+
+ Licensed under the GNU GPLv2 <https://opensource.org/licenses/GPL-2.0>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef WorkerPool_h
+#define WorkerPool_h
+
+using std::vector;
+
+namespace Audealize
+{
+/// The background threads shared by every Audealize instance in the process. Rendering previews, analysing input and
+/// any other work that mustn't run on the audio or message thread is submitted here rather than to threads owned by
+/// each instance, so a session with a hundred instances still only runs a handful of threads.
+///
+/// Each worker has its own queue per priority. A worker takes the newest job from its own queue and, when that is
+/// empty, steals the oldest job from another worker's, always looking for higher priority work first. Queues are
+/// bounded: submit fails instead of letting a backlog grow without limit.
+///
+/// Jobs are grouped by a CancellationToken. Cancelling it drops the group's queued jobs, and running jobs are expected
+/// to poll it and return early. Owners cancel their token and waitFor it before destroying anything their jobs use.
+///
+/// There is one pool per process, shared through a SharedResourcePointer.
+class WorkerPool
+{
+public:
+    enum Priority
+    {
+        kPriorityInteractive = 0,  // the user is waiting for the result, e.g. an audition
+        kPriorityNormal,           // results are shown in the UI, e.g. input analysis
+        kPriorityBackground,       // speculative work, e.g. prefetching
+        kNumPriorities
+    };
+
+    /// Identifies a group of jobs that can be cancelled together. Copies refer to the same group
+    class CancellationToken
+    {
+    public:
+        CancellationToken ();
+
+        /**
+         *  Cancels every job in the group. Queued jobs are dropped without running, and jobs submitted afterwards are
+         *  rejected. Can't be undone: use a new token for new work
+         */
+        void cancel ();
+
+        /**
+         *  Returns true once cancel () has been called. Running jobs should poll this and return early
+         */
+        bool isCancelled () const;
+
+        /**
+         *  Returns the number of jobs in the group that are queued or running
+         */
+        int getNumPending () const;
+
+        bool operator== (const CancellationToken& other) const
+        {
+            return mState == other.mState;
+        }
+
+    private:
+        friend class WorkerPool;
+
+        struct State
+        {
+            Atomic<int> cancelled;
+            Atomic<int> numPending;
+        };
+
+        std::shared_ptr<State> mState;
+    };
+
+    /// How many threads the pool runs and where
+    struct Policy
+    {
+        int numThreads;
+        int numReservedCores;       // cores left to the host's audio threads. These are the lowest numbered cores,
+                                    // which is where hosts put their realtime threads first
+        bool pinToUnreservedCores;  // restrict the workers to the other cores, where the OS supports it
+        int threadPriority;         // 0 - 10, @see Thread::setPriority
+        int maxQueuedJobs;          // per priority
+
+        /**
+         *  Returns the policy the shared pool is created with, derived from the number of cores
+         */
+        static Policy getDefault ();
+    };
+
+    /// What the pool has measured about all jobs with one name
+    struct JobMetrics
+    {
+        String name;
+        int numSubmitted, numCompleted, numCancelled, numRejected;
+        double totalWaitMs, maxWaitMs;  // time spent queued before starting
+        double totalRunMs, maxRunMs;
+    };
+
+    WorkerPool ();
+    WorkerPool (const Policy& policy);
+    ~WorkerPool ();
+
+    /**
+     *  Queues a job
+     *
+     *  @param name     Name the job's metrics are collected under
+     *  @param priority @see WorkerPool::Priority
+     *  @param token    Token the job can be cancelled with
+     *  @param job      The work. Runs on one of the pool's threads
+     *
+     *  @return false if the job was rejected because its priority's queue is full or the token has been cancelled.
+     *          The job is destroyed without running
+     */
+    bool submit (const String& name, int priority, const CancellationToken& token, std::function<void ()> job);
+
+    /**
+     *  Queues a job that runs repeatedly until it is cancelled or asks to stop
+     *
+     *  @param name     Name the job's metrics are collected under
+     *  @param priority @see WorkerPool::Priority
+     *  @param token    Token the job can be cancelled with
+     *  @param job      The work. Returns the number of milliseconds until it should run again, or -1 to stop
+     *
+     *  @return false if the job was rejected. @see submit
+     */
+    bool submitRecurring (const String& name, int priority, const CancellationToken& token,
+                          std::function<int ()> job);
+
+    /**
+     *  Waits until every job in a group has finished or been dropped. Cancelled jobs that are still queued are dropped
+     *  straight away. When called from one of the pool's threads, runs other jobs while it waits
+     *
+     *  @param token     The group to wait for
+     *  @param timeoutMs Maximum time to wait, or -1 to wait for ever
+     *
+     *  @return true if the group has no pending jobs left
+     */
+    bool waitFor (const CancellationToken& token, int timeoutMs = -1);
+
+    const Policy& getPolicy () const
+    {
+        return mPolicy;
+    }
+
+    int getNumThreads () const
+    {
+        return mWorkers.size ();
+    }
+
+    /**
+     *  Returns the number of jobs of a priority that are queued (not running or waiting for their next run)
+     */
+    int getNumQueuedJobs (int priority) const
+    {
+        return mNumQueued[priority].get ();
+    }
+
+    /**
+     *  Returns the metrics of every job name seen since the pool was created or resetMetrics was called
+     */
+    vector<JobMetrics> getMetrics () const;
+
+    /**
+     *  Returns the metrics as a table, one row per job name
+     */
+    String getMetricsReport () const;
+
+    void resetMetrics ();
+
+private:
+    class Worker;
+
+    struct Job
+    {
+        String name;
+        int priority = kPriorityNormal;
+        std::shared_ptr<CancellationToken::State> group;
+        std::function<int ()> run;
+        int64 queuedTicks = 0;  // when the job was last put in a queue
+        uint32 dueTime = 0;     // Time::getMillisecondCounter () at which a delayed job should run again
+    };
+
+    Policy mPolicy;
+    OwnedArray<Worker> mWorkers;
+    Atomic<int> mNextWorker;  // round-robin target of submitted jobs
+    Atomic<int> mNumQueued[kNumPriorities];
+
+    CriticalSection mDelayedLock;  // guards mDelayed
+    vector<Job> mDelayed;          // recurring jobs waiting for their next run
+    Atomic<uint32> mNextDueTime;   // earliest dueTime in mDelayed
+    Atomic<int> mNumDelayed;
+
+    WaitableEvent mJobFinished;  // signalled whenever a job leaves the pool, for waitFor
+
+    CriticalSection mMetricsLock;  // guards mMetrics
+    std::map<String, JobMetrics> mMetrics;
+
+    void start ();
+
+    /**
+     *  Adds a job to a worker's queue and wakes a worker to run it
+     */
+    void enqueue (Job& job, int workerIdx);
+
+    /**
+     *  Takes the next job for a worker: its own newest job, or the oldest job of another worker, in priority order
+     *
+     *  @return false if every queue is empty
+     */
+    bool takeJob (int workerIdx, Job& job);
+
+    /**
+     *  Moves delayed jobs that are due into a worker's queue
+     */
+    void promoteDueJobs (int workerIdx);
+
+    /**
+     *  Returns how long an idle worker should sleep for before checking for delayed jobs
+     */
+    int getIdleTimeoutMs (int workerIdx) const;
+
+    /**
+     *  Runs a job on the calling worker, then requeues it if it is recurring or lets it go
+     */
+    void runJob (Job& job, int workerIdx);
+
+    /**
+     *  Destroys a job's function and removes it from its group's pending count
+     */
+    void release (Job& job);
+
+    void recordJob (const String& name, int numSubmitted, int numCompleted, int numCancelled, int numRejected,
+                    double waitMs = 0.0, double runMs = 0.0);
+
+    /**
+     *  Returns the index of the worker running the calling thread, or -1
+     */
+    int getCurrentWorkerIndex () const;
+
+    JUCE_DECLARE_NON_COPYABLE (WorkerPool)
+};
+}
+
+#endif /* WorkerPool_h */
@@ -30,6 +30,7 @@ const Identifier Properties::propertyIds::eqDataPath = "eqDataPath";
 const Identifier Properties::propertyIds::reverbDataPath = "reverbDataPath";
 const Identifier Properties::propertyIds::windowHeight = "windowHeight";
 const Identifier Properties::propertyIds::windowWidth = "windowWidth";
+const Identifier Properties::propertyIds::previewOnHover = "previewOnHover";
 
 void Properties::writePropertiesToFile (var properties)
 {
@@ -68,6 +69,7 @@ File Properties::loadPropertiesFile ()
         temp->setProperty (propertyIds::reverbDataPath, DEFAULT_REVERB_DATA_PATH);
         temp->setProperty (propertyIds::windowWidth, DEFAULT_WINDOWWIDTH);
         temp->setProperty (propertyIds::windowHeight, DEFAULT_WINDOWHEIGHT);
+        temp->setProperty (propertyIds::previewOnHover, DEFAULT_PREVIEWONHOVER);
 
         defaultFile.create ();
 
@@ -107,6 +109,7 @@ var Properties::getDefaultForProperty (Identifier propertyId)
     if (propertyId == propertyIds::reverbDataPath) return DEFAULT_REVERB_DATA_PATH;
     if (propertyId == propertyIds::windowWidth) return DEFAULT_WINDOWWIDTH;
     if (propertyId == propertyIds::windowHeight) return DEFAULT_WINDOWHEIGHT;
+    if (propertyId == propertyIds::previewOnHover) return DEFAULT_PREVIEWONHOVER;
     return var ();
 }
 
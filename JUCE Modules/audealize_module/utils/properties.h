@@ -38,9 +38,17 @@
 
 #endif
 
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
 #define DEFAULT_DARKMODE TRUE
 #define DEFAULT_WINDOWWIDTH 840
 #define DEFAULT_WINDOWHEIGHT 560
+#define DEFAULT_PREVIEWONHOVER FALSE
 
 namespace Audealize
 {
@@ -56,6 +64,7 @@ public:
         static const Identifier reverbDataPath;
         static const Identifier windowHeight;
         static const Identifier windowWidth;
+        static const Identifier previewOnHover;
     };
 
     /**